@@ -0,0 +1,501 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "itemcodec.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QtEndian>
+
+#include <limits>
+
+namespace ItemCodec {
+
+static const QString FileIconsFormat = QStringLiteral("x-dfm-copied/file-icons");
+static constexpr qint64 InvalidTime = std::numeric_limits<qint64>::min();
+
+// 字段编号，已经使用的编号不能改变含义
+enum Field : quint16 {
+    FormatsField = 1,
+    TypeField = 2,
+    UrlsField = 3,
+    ImageField = 4,                     // QDataStream(Qt_5_11)序列化的缩略图
+    PixSizeField = 5,
+    EnableField = 6,
+    TextField = 7,                      // UTF-16LE，内容按2字节对齐
+    CreateTimeField = 8,
+    HashField = 9,
+    IdField = 10,
+    BlobFilesField = 11,                // 格式 -> daemon缓存文件
+};
+
+class Writer
+{
+public:
+    explicit Writer(QByteArray &buf) : m_buf(buf) {}
+
+    template<typename T>
+    void put(T value)
+    {
+        const T le = qToLittleEndian(value);
+        m_buf.append(reinterpret_cast<const char *>(&le), sizeof(le));
+    }
+
+    void putBytes(QByteArrayView data)
+    {
+        put<quint32>(quint32(data.size()));
+        m_buf.append(data);
+    }
+
+    void beginField(Field field)
+    {
+        put<quint16>(field);
+        m_lengthPos = m_buf.size();
+        put<quint32>(0);
+    }
+
+    void endField()
+    {
+        qToLittleEndian<quint32>(quint32(m_buf.size() - m_lengthPos - sizeof(quint32)), m_buf.data() + m_lengthPos);
+    }
+
+    template<typename T>
+    void putField(Field field, T value)
+    {
+        beginField(field);
+        put<T>(value);
+        endField();
+    }
+
+    qsizetype size() const { return m_buf.size(); }
+
+private:
+    QByteArray &m_buf;
+    qsizetype m_lengthPos = 0;
+};
+
+// 按范围读取，越界时停止并记录错误
+class Reader
+{
+public:
+    Reader(const char *data, qsizetype size) : m_data(data), m_size(size) {}
+
+    bool atEnd() const { return m_pos >= m_size; }
+    bool ok() const { return m_ok; }
+    qsizetype pos() const { return m_pos; }
+
+    template<typename T>
+    T get()
+    {
+        if (!check(sizeof(T)))
+            return T();
+        const T value = qFromLittleEndian<T>(m_data + m_pos);
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    const char *getRaw(qsizetype size)
+    {
+        if (!check(size))
+            return nullptr;
+        const char *data = m_data + m_pos;
+        m_pos += size;
+        return data;
+    }
+
+    QByteArrayView getBytes()
+    {
+        const quint32 size = get<quint32>();
+        const char *data = getRaw(size);
+        return data ? QByteArrayView(data, size) : QByteArrayView();
+    }
+
+private:
+    bool check(qsizetype size)
+    {
+        if (!m_ok || size < 0 || m_size - m_pos < size) {
+            m_ok = false;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const char *m_data;
+    qsizetype m_size;
+    qsizetype m_pos = 0;
+    bool m_ok = true;
+};
+
+static QList<FileIconData> fileIconDataList(const QByteArray &iconBuf, int count)
+{
+    QList<FileIconData> list;
+    if (iconBuf.isEmpty())
+        return list;
+
+    QDataStream stream(iconBuf);
+    stream.setVersion(QDataStream::Qt_5_11);
+    for (int i = 0 ; i < count; ++i) {
+        FileIconData data;
+        stream >> data.cornerIconList >> data.fileIcon;
+        if (data.fileIcon.isNull())
+            continue;
+        list.push_back(data);
+    }
+    return list;
+}
+
+static QByteArray bytes(QByteArrayView view, DecodeFlags flags)
+{
+    return flags.testFlag(ZeroCopy) ? QByteArray::fromRawData(view.data(), view.size()) : view.toByteArray();
+}
+
+static QString utf16Text(QByteArrayView view, DecodeFlags flags)
+{
+    const qsizetype length = view.size() / qsizetype(sizeof(char16_t));
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // 对齐的数据可以直接引用
+    if (flags.testFlag(ZeroCopy) && quintptr(view.data()) % alignof(char16_t) == 0)
+        return QString::fromRawData(reinterpret_cast<const QChar *>(view.data()), length);
+#else
+    Q_UNUSED(flags)
+#endif
+    QString text(length, Qt::Uninitialized);
+    qFromLittleEndian<quint16>(view.data(), length, text.data());
+    return text;
+}
+
+// 升级前保存的数据
+static ItemInfo decodeLegacy(const QByteArray &buf, DecodeFlags flags, const QStringList &formats, bool *ok)
+{
+    ItemInfo info;
+    QDataStream stream(buf);
+    stream.setVersion(QDataStream::Qt_5_11);
+    int type = Unknown;
+    QByteArray iconBuf;
+    stream >> info.m_formatMap
+           >> type
+           >> info.m_urls
+           >> info.m_hasImage;
+    if (info.m_hasImage) {
+        stream >> info.m_variantImage;
+        stream >> info.m_pixSize;
+    }
+
+    stream >> info.m_enable
+           >> info.m_text
+           >> info.m_createTime
+           >> iconBuf;
+
+    // 旧版本数据没有指纹和id字段
+    if (!stream.atEnd())
+        stream >> info.m_hash;
+    if (!stream.atEnd())
+        stream >> info.m_id;
+
+    if (!formats.isEmpty()) {
+        for (auto it = info.m_formatMap.begin(); it != info.m_formatMap.end();) {
+            if (formats.contains(it.key()))
+                ++it;
+            else
+                it = info.m_formatMap.erase(it);
+        }
+    }
+
+    info.m_type = static_cast<DataType>(type);
+    if (flags.testFlag(FileIcons))
+        info.m_iconDataList = fileIconDataList(iconBuf, info.m_urls.size());
+    if (ok)
+        *ok = stream.status() == QDataStream::Ok;
+    return info;
+}
+
+static void putFormats(Writer &writer, const QMap<QString, QByteArray> &formatMap)
+{
+    writer.beginField(FormatsField);
+    writer.put<quint32>(quint32(formatMap.size()));
+    for (auto it = formatMap.cbegin(); it != formatMap.cend(); ++it) {
+        writer.putBytes(it.key().toUtf8());
+        writer.putBytes(it.value());
+    }
+    writer.endField();
+}
+
+static void putBlobFiles(Writer &writer, const QMap<QString, QString> &blobFiles)
+{
+    if (blobFiles.isEmpty())
+        return;
+
+    writer.beginField(BlobFilesField);
+    writer.put<quint32>(quint32(blobFiles.size()));
+    for (auto it = blobFiles.cbegin(); it != blobFiles.cend(); ++it) {
+        writer.putBytes(it.key().toUtf8());
+        writer.putBytes(it.value().toUtf8());
+    }
+    writer.endField();
+}
+
+QByteArray encode(const ItemInfo &info)
+{
+    qsizetype reserve = 256 + info.m_text.size() * qsizetype(sizeof(char16_t));
+    for (auto it = info.m_formatMap.cbegin(); it != info.m_formatMap.cend(); ++it)
+        reserve += it.key().size() * 3 + it.value().size() + 8;
+
+    QByteArray buf;
+    buf.reserve(reserve);
+    Writer writer(buf);
+    writer.put<quint32>(Magic);
+    writer.put<quint16>(Version);
+
+    putFormats(writer, info.m_formatMap);
+
+    writer.putField<qint32>(TypeField, info.m_type);
+
+    writer.beginField(UrlsField);
+    writer.put<quint32>(quint32(info.m_urls.size()));
+    for (const QUrl &url : info.m_urls)
+        writer.putBytes(url.toEncoded());
+    writer.endField();
+
+    if (info.m_hasImage) {
+        QByteArray image;
+        QDataStream stream(&image, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_11);
+        stream << info.m_variantImage;
+        writer.beginField(ImageField);
+        writer.putBytes(image);
+        writer.endField();
+
+        writer.beginField(PixSizeField);
+        writer.put<qint32>(info.m_pixSize.width());
+        writer.put<qint32>(info.m_pixSize.height());
+        writer.endField();
+    }
+
+    writer.putField<quint8>(EnableField, info.m_enable ? 1 : 0);
+
+    // 第一个字节为填充的长度，使文本按2字节对齐，零拷贝解码时可以直接引用
+    writer.beginField(TextField);
+    const quint8 padding = (writer.size() + 1) % 2;
+    writer.put<quint8>(padding);
+    if (padding)
+        writer.put<quint8>(0);
+    for (const QChar c : info.m_text)
+        writer.put<quint16>(c.unicode());
+    writer.endField();
+
+    writer.putField<qint64>(CreateTimeField, info.m_createTime.isValid() ? info.m_createTime.toMSecsSinceEpoch() : InvalidTime);
+    writer.putField<quint64>(HashField, info.m_hash);
+    writer.putField<quint64>(IdField, info.m_id);
+
+    putBlobFiles(writer, info.m_blobFiles);
+
+    return buf;
+}
+
+QByteArray encodeFormats(const QMap<QString, QByteArray> &formatMap, const QMap<QString, QString> &blobFiles)
+{
+    qsizetype reserve = 64;
+    for (auto it = formatMap.cbegin(); it != formatMap.cend(); ++it)
+        reserve += it.key().size() * 3 + it.value().size() + 8;
+
+    QByteArray buf;
+    buf.reserve(reserve);
+    Writer writer(buf);
+    putFormats(writer, formatMap);
+    putBlobFiles(writer, blobFiles);
+    return buf;
+}
+
+ItemInfo decode(const QByteArray &buf, DecodeFlags flags, const QStringList &formats, bool *ok)
+{
+    Reader reader(buf.constData(), buf.size());
+    if (reader.get<quint32>() != Magic || !reader.ok())
+        return decodeLegacy(buf, flags, formats, ok);
+
+    ItemInfo info;
+    info.m_enable = false;
+    const quint16 version = reader.get<quint16>();
+    if (version > Version)
+        qDebug() << "decoding clipboard item of newer version:" << version;
+
+    bool valid = reader.ok();
+    while (valid && !reader.atEnd()) {
+        const quint16 field = reader.get<quint16>();
+        const QByteArrayView content = reader.getBytes();
+        if (!reader.ok()) {
+            valid = false;
+            break;
+        }
+
+        Reader value(content.data(), content.size());
+        // 定长字段的长度必须一致
+        auto fixed = [&content, &valid](qsizetype size) {
+            valid = valid && content.size() == size;
+            return valid;
+        };
+
+        switch (field) {
+        case FormatsField: {
+            const quint32 count = value.get<quint32>();
+            for (quint32 i = 0; i < count && value.ok(); ++i) {
+                const QString format = QString::fromUtf8(value.getBytes());
+                const QByteArrayView data = value.getBytes();
+                if (value.ok() && (formats.isEmpty() || formats.contains(format)))
+                    info.m_formatMap.insert(format, bytes(data, flags));
+            }
+            valid = value.ok();
+            break;
+        }
+        case TypeField:
+            if (fixed(sizeof(qint32)))
+                info.m_type = static_cast<DataType>(value.get<qint32>());
+            break;
+        case UrlsField: {
+            const quint32 count = value.get<quint32>();
+            for (quint32 i = 0; i < count && value.ok(); ++i) {
+                const QByteArrayView url = value.getBytes();
+                if (value.ok())
+                    info.m_urls.append(QUrl::fromEncoded(url.toByteArray()));
+            }
+            valid = value.ok();
+            break;
+        }
+        case ImageField: {
+            const QByteArray image = value.getBytes().toByteArray();
+            QDataStream stream(image);
+            stream.setVersion(QDataStream::Qt_5_11);
+            stream >> info.m_variantImage;
+            info.m_hasImage = true;
+            valid = value.ok() && stream.status() == QDataStream::Ok;
+            break;
+        }
+        case PixSizeField:
+            if (fixed(2 * sizeof(qint32))) {
+                const int width = value.get<qint32>();
+                info.m_pixSize = QSize(width, value.get<qint32>());
+            }
+            break;
+        case EnableField:
+            if (fixed(sizeof(quint8)))
+                info.m_enable = value.get<quint8>() != 0;
+            break;
+        case TextField: {
+            const quint8 padding = value.get<quint8>();
+            value.getRaw(padding);
+            const qsizetype size = content.size() - value.pos();
+            valid = value.ok() && size % 2 == 0;
+            if (valid)
+                info.m_text = utf16Text(QByteArrayView(value.getRaw(size), size), flags);
+            break;
+        }
+        case CreateTimeField:
+            if (fixed(sizeof(qint64))) {
+                const qint64 msecs = value.get<qint64>();
+                if (msecs != InvalidTime)
+                    info.m_createTime = QDateTime::fromMSecsSinceEpoch(msecs);
+            }
+            break;
+        case HashField:
+            if (fixed(sizeof(quint64)))
+                info.m_hash = value.get<quint64>();
+            break;
+        case IdField:
+            if (fixed(sizeof(quint64)))
+                info.m_id = value.get<quint64>();
+            break;
+        case BlobFilesField: {
+            // 其他进程传入的数据中的文件引用不可信，不解析
+            if (!flags.testFlag(BlobFiles))
+                break;
+            const quint32 count = value.get<quint32>();
+            for (quint32 i = 0; i < count && value.ok(); ++i) {
+                const QString format = QString::fromUtf8(value.getBytes());
+                const QString file = QString::fromUtf8(value.getBytes());
+                if (value.ok() && (formats.isEmpty() || formats.contains(format)))
+                    info.m_blobFiles.insert(format, file);
+            }
+            valid = value.ok();
+            break;
+        }
+        default:
+            // 新版本增加的字段
+            break;
+        }
+    }
+
+    if (!valid)
+        qWarning() << "clipboard item is corrupted, size:" << buf.size();
+    if (flags.testFlag(FileIcons))
+        info.m_iconDataList = fileIconDataList(info.m_formatMap.value(FileIconsFormat), info.m_urls.size());
+    if (ok)
+        *ok = valid;
+    return info;
+}
+
+QByteArray encodePreview(const ItemInfo &info)
+{
+    QByteArray buf;
+
+    QDataStream stream(&buf, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_11);
+    stream << ItemPreviewVersion
+           << info.m_id
+           << info.m_hash
+           << info.m_type
+           << info.m_urls
+           << info.m_hasImage;
+    if (info.m_hasImage) {
+        stream << info.m_variantImage;
+        stream << info.m_pixSize;
+    }
+    stream << info.m_text.left(PreviewTextLength)
+           << qint64(info.m_text.size())
+           << info.m_createTime
+           << info.m_formatMap.value(FileIconsFormat);
+
+    return buf;
+}
+
+bool decodePreview(const QByteArray &buf, ItemInfo &info, qint64 *textLength, DecodeFlags flags)
+{
+    QDataStream stream(buf);
+    stream.setVersion(QDataStream::Qt_5_11);
+    quint8 version = 0;
+    stream >> version;
+    if (version != ItemPreviewVersion) {
+        qWarning() << "unsupported preview version:" << version;
+        return false;
+    }
+
+    int type = Unknown;
+    qint64 length = 0;
+    QByteArray iconBuf;
+    stream >> info.m_id
+           >> info.m_hash
+           >> type
+           >> info.m_urls
+           >> info.m_hasImage;
+    if (info.m_hasImage) {
+        stream >> info.m_variantImage;
+        stream >> info.m_pixSize;
+    }
+    stream >> info.m_text
+           >> length
+           >> info.m_createTime
+           >> iconBuf;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    info.m_type = static_cast<DataType>(type);
+    if (!iconBuf.isEmpty())
+        info.m_formatMap.insert(FileIconsFormat, iconBuf);
+    if (flags.testFlag(FileIcons))
+        info.m_iconDataList = fileIconDataList(iconBuf, info.m_urls.size());
+    if (textLength)
+        *textLength = length;
+    return true;
+}
+
+} // namespace ItemCodec
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ITEMCODEC_H
+#define ITEMCODEC_H
+
+#include "iteminfo.h"
+
+#include <QByteArray>
+#include <QFlags>
+#include <QStringList>
+
+/*!
+ * \~chinese \brief 剪贴板数据的编解码，daemon保存的历史记录以及daemon和界面之间传递的数据都使用这里的格式。
+ * \~chinese 数据以标识和版本号开头，之后是一组(字段编号, 长度, 内容)，所有数值按小端保存。
+ * \~chinese 解码时检查每个字段的长度，跳过不认识的字段，新增的可选字段不影响旧版本读取。
+ * \~chinese 没有标识的数据按照旧的QDataStream格式读取，兼容升级前保存的历史记录。
+ */
+namespace ItemCodec {
+
+const quint32 Magic = 0x31424344;       // 小端保存为"DCB1"
+const quint16 Version = 1;              // 格式版本，只在字段的含义改变时增加
+
+enum DecodeFlag {
+    NoDecodeFlags = 0x0,
+    ZeroCopy = 0x1,                     // 各格式的数据和文本直接引用buf中的内容，结果使用期间buf不能释放
+    FileIcons = 0x2,                    // 解析文件图标到m_iconDataList
+    BlobFiles = 0x4,                    // 解析m_blobFiles，只能用于daemon自己保存的历史记录，不能用于其他进程传入的数据
+};
+Q_DECLARE_FLAGS(DecodeFlags, DecodeFlag)
+
+/*!
+ * \~chinese \brief 编码完整数据
+ */
+QByteArray encode(const ItemInfo &info);
+
+/*!
+ * \~chinese \brief 只编码格式和缓存文件引用字段，不带标识和版本号。
+ * \~chinese 结果直接追加到encode的数据后面，解码时与原有的格式合并，用于给已保存的数据补充格式而不重新编码整条数据
+ */
+QByteArray encodeFormats(const QMap<QString, QByteArray> &formatMap, const QMap<QString, QString> &blobFiles = {});
+
+/*!
+ * \~chinese \brief 解码完整数据，formats不为空时只保留其中的格式，其他格式的数据不会被复制
+ * \~chinese \param ok 数据不完整或字段长度不符合要求时为false，返回已经解出的部分
+ */
+ItemInfo decode(const QByteArray &buf, DecodeFlags flags = NoDecodeFlags, const QStringList &formats = QStringList(), bool *ok = nullptr);
+
+/*!
+ * \~chinese \brief 编码界面显示需要的预览数据：缩略图、文件图标和截断后的文本，不包含各格式的原始数据
+ */
+QByteArray encodePreview(const ItemInfo &info);
+
+/*!
+ * \~chinese \brief 解码预览数据，文件图标的原始数据放在m_formatMap中
+ * \~chinese \param textLength 完整文本的长度
+ * \~chinese \return 版本不支持或数据不完整时返回false
+ */
+bool decodePreview(const QByteArray &buf, ItemInfo &info, qint64 *textLength = nullptr, DecodeFlags flags = NoDecodeFlags);
+
+} // namespace ItemCodec
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ItemCodec::DecodeFlags)
+
+#endif // ITEMCODEC_H
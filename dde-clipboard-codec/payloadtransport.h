@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PAYLOADTRANSPORT_H
+#define PAYLOADTRANSPORT_H
+
+#include <QByteArray>
+#include <QDBusUnixFileDescriptor>
+#include <QDBusVariant>
+#include <QDebug>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*!
+ * \~chinese \brief 剪贴板数据在daemon和界面之间的传递方式。
+ * \~chinese 较小的数据直接放在D-Bus消息中；较大的数据写入密封(sealed)的memfd，消息中只传递文件描述符，
+ * \~chinese 避免dbus-daemon多次拷贝整块数据，总线上的其他监听者也不会收到这些数据。
+ */
+namespace PayloadTransport {
+
+// 小于该大小的数据直接放在D-Bus消息中。数据较小时创建、密封和映射memfd的固定开销大于dbus-daemon多拷贝一次的耗时，
+// 调整时参考bench-clipboard-transport中16KB到256KB的结果
+const qsizetype InlineThreshold = 64 * 1024;
+
+/*!
+ * \~chinese \brief 将数据写入memfd并封住写入和大小修改，失败时返回无效的描述符
+ */
+inline QDBusUnixFileDescriptor toMemfd(const QByteArray &data)
+{
+    const int fd = memfd_create("dde-clipboard-payload", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        qWarning() << "memfd_create failed:" << strerror(errno);
+        return QDBusUnixFileDescriptor();
+    }
+
+    qsizetype written = 0;
+    while (written < data.size()) {
+        const ssize_t ret = ::write(fd, data.constData() + written, static_cast<size_t>(data.size() - written));
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0) {
+            qWarning() << "write memfd failed:" << strerror(errno);
+            ::close(fd);
+            return QDBusUnixFileDescriptor();
+        }
+        written += ret;
+    }
+
+    // 接收方映射后，发送方不能再修改或截断数据
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+        qWarning() << "seal memfd failed:" << strerror(errno);
+        ::close(fd);
+        return QDBusUnixFileDescriptor();
+    }
+
+    QDBusUnixFileDescriptor descriptor;
+    descriptor.giveFileDescriptor(fd);
+    return descriptor;
+}
+
+/*!
+ * \~chinese \brief 按数据大小选择传递方式，较小的数据作为ay直接回复，否则作为memfd的描述符回复。
+ * \~chinese 写入memfd失败时返回无效的QDBusVariant
+ */
+inline QDBusVariant pack(const QByteArray &data)
+{
+    if (data.size() < InlineThreshold)
+        return QDBusVariant(data);
+
+    const QDBusUnixFileDescriptor fd = toMemfd(data);
+    return fd.isValid() ? QDBusVariant(QVariant::fromValue(fd)) : QDBusVariant();
+}
+
+/*!
+ * \~chinese \class MappedPayload
+ * \~chinese \brief 以只读方式映射daemon传来的memfd，data()返回的数据只在本对象存在期间有效。
+ * \~chinese 直接放在消息中的较小数据不需要映射，data()返回消息中的数据
+ */
+class MappedPayload
+{
+public:
+    explicit MappedPayload(const QDBusUnixFileDescriptor &descriptor)
+    {
+        map(descriptor);
+    }
+
+    // 接收pack()的结果
+    explicit MappedPayload(const QDBusVariant &packed)
+    {
+        const QVariant value = packed.variant();
+        if (value.userType() == qMetaTypeId<QDBusUnixFileDescriptor>()) {
+            map(qvariant_cast<QDBusUnixFileDescriptor>(value));
+        } else if (value.userType() == QMetaType::QByteArray) {
+            m_inline = value.toByteArray();
+            m_isInline = true;
+        }
+    }
+
+    ~MappedPayload()
+    {
+        if (m_data)
+            munmap(m_data, static_cast<size_t>(m_size));
+    }
+
+    bool isValid() const { return m_data || m_isInline; }
+    QByteArray data() const
+    {
+        return m_data ? QByteArray::fromRawData(static_cast<const char *>(m_data), m_size) : m_inline;
+    }
+
+private:
+    Q_DISABLE_COPY(MappedPayload)
+
+    void map(const QDBusUnixFileDescriptor &descriptor)
+    {
+        if (!descriptor.isValid())
+            return;
+
+        const int fd = descriptor.fileDescriptor();
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size <= 0)
+            return;
+
+        // 没有密封的数据可能被发送方截断，映射后访问会触发SIGBUS
+        const int seals = fcntl(fd, F_GET_SEALS);
+        if (seals < 0 || !(seals & F_SEAL_SHRINK) || !(seals & F_SEAL_WRITE)) {
+            qWarning() << "payload memfd is not sealed, ignored";
+            return;
+        }
+
+        void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            qWarning() << "mmap payload failed:" << strerror(errno);
+            return;
+        }
+
+        m_data = addr;
+        m_size = st.st_size;
+    }
+
+    void *m_data = nullptr;
+    qsizetype m_size = 0;
+    QByteArray m_inline;
+    bool m_isInline = false;
+};
+
+} // namespace PayloadTransport
+
+#endif // PAYLOADTRANSPORT_H
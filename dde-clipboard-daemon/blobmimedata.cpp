@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "blobmimedata.h"
+#include "blobstore.h"
+
+BlobMimeData::BlobMimeData(BlobStore *store)
+    : m_store(store)
+{
+}
+
+BlobMimeData::~BlobMimeData()
+{
+    if (m_store)
+        m_store->release(m_files.values());
+}
+
+void BlobMimeData::setFile(const QString &mimeType, const QString &file)
+{
+    if (m_store) {
+        m_store->retain({file});
+        m_store->release(m_files.values(mimeType));
+    }
+
+    m_files.insert(mimeType, file);
+    // 只登记格式，数据在使用时再从文件读取
+    if (!QMimeData::formats().contains(mimeType))
+        setData(mimeType, QByteArray());
+}
+
+QVariant BlobMimeData::retrieveData(const QString &mimeType, QMetaType type) const
+{
+    if (m_files.contains(mimeType))
+        return BlobStore::read(m_files.value(mimeType));
+
+    return QMimeData::retrieveData(mimeType, type);
+}
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BLOBMIMEDATA_H
+#define BLOBMIMEDATA_H
+
+#include <QMimeData>
+#include <QMap>
+
+class BlobStore;
+
+/*!
+ * \~chinese \class BlobMimeData
+ * \~chinese \brief 部分格式保存在缓存文件中的剪贴板数据。
+ * \~chinese 缓存文件中的格式只在data()时读取，粘贴时可以直接从文件发送，不需要读入内存。
+ * \~chinese 设置了BlobStore时，数据存在期间持有缓存文件的引用，删除历史记录不会删除正在使用的文件。
+ */
+class BlobMimeData : public QMimeData
+{
+    Q_OBJECT
+public:
+    explicit BlobMimeData(BlobStore *store = nullptr);
+    ~BlobMimeData() override;
+
+    /*!
+     * \~chinese \brief 设置保存在缓存文件中的格式
+     */
+    void setFile(const QString &mimeType, const QString &file);
+    /*!
+     * \~chinese \brief 格式对应的缓存文件，没有时返回空
+     */
+    QString file(const QString &mimeType) const { return m_files.value(mimeType); }
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QMetaType type) const override;
+
+private:
+    BlobStore *m_store;
+    QMap<QString, QString> m_files;
+};
+
+#endif // BLOBMIMEDATA_H
@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "blobstore.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QDebug>
+
+#include <cstring>
+
+// 指纹相同、内容不同的文件最多保存的数量
+const int MaxHashCollisions = 8;
+// 缓存文件是剪贴板的原始内容，只有所有者可以访问
+const QFileDevice::Permissions DirPermissions = QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner;
+const QFileDevice::Permissions FilePermissions = QFileDevice::ReadOwner | QFileDevice::WriteOwner;
+
+static bool makeDir(const QString &dir)
+{
+    if (QFileInfo::exists(dir))
+        return true;
+    if (!QDir().mkpath(dir))
+        return false;
+    QFile::setPermissions(dir, DirPermissions);
+    return true;
+}
+
+BlobStore::BlobStore(const QString &path)
+    : m_path(QDir::cleanPath(path))
+{
+}
+
+QString BlobStore::filePath(quint64 hash, const QString &suffix, int index) const
+{
+    const QString key = QStringLiteral("%1").arg(hash, 16, 16, QLatin1Char('0'));
+    const QString name = index > 0 ? key + QLatin1Char('-') + QString::number(index) : key;
+    return m_path + QLatin1Char('/') + key.left(2) + QLatin1Char('/') + name + suffix;
+}
+
+template<typename Matcher, typename Writer>
+QString BlobStore::store(quint64 hash, const QString &suffix, Matcher matches, Writer writer)
+{
+    for (int index = 0; index < MaxHashCollisions; ++index) {
+        const QString file = filePath(hash, suffix, index);
+        // 指纹相同但内容不同，换下一个文件名
+        if (QFileInfo::exists(file) && !matches(file))
+            continue;
+
+        {
+            QMutexLocker locker(&m_mutex);
+            ++m_refs[file];
+            // 相同的内容已经保存过，不再重复写入
+            if (QFileInfo::exists(file))
+                return file;
+        }
+
+        // QSaveFile先写入同目录下的临时文件，提交时再重命名
+        QSaveFile saveFile(file);
+        if (!makeDir(QFileInfo(file).path()) || !saveFile.open(QIODevice::WriteOnly)
+                || !saveFile.setPermissions(FilePermissions) || !writer(saveFile) || !saveFile.commit()) {
+            qDebug() << "write cache file failed, file name:" << file;
+            QMutexLocker locker(&m_mutex);
+            auto it = m_refs.find(file);
+            if (it != m_refs.end() && --it.value() <= 0)
+                m_refs.erase(it);
+            return QString();
+        }
+
+        return file;
+    }
+
+    qWarning() << "too many cache files with the same hash:" << hash;
+    return QString();
+}
+
+QString BlobStore::put(quint64 hash, const QByteArray &data, const QString &suffix)
+{
+    const auto matches = [&data](const QString &file) {
+        QFile blob(file);
+        if (!blob.open(QIODevice::ReadOnly) || blob.size() != data.size())
+            return false;
+        if (data.isEmpty())
+            return true;
+
+        const uchar *mapped = blob.map(0, data.size());
+        return mapped && memcmp(mapped, data.constData(), size_t(data.size())) == 0;
+    };
+
+    return store(hash, suffix, matches, [&data](QSaveFile &file) {
+        return file.write(data) == data.size();
+    });
+}
+
+QString BlobStore::putImage(quint64 hash, const QImage &image)
+{
+    // 已有的文件只在指纹相同时才解码比较像素
+    const auto matches = [&image](const QString &file) {
+        QImageReader reader(file);
+        if (reader.size() != image.size())
+            return false;
+
+        return reader.read().convertToFormat(QImage::Format_ARGB32) == image.convertToFormat(QImage::Format_ARGB32);
+    };
+
+    // 只有第一次保存时才需要编码
+    return store(hash, QStringLiteral(".png"), matches, [&image](QSaveFile &file) {
+        QImageWriter writer(&file, "png");
+        return writer.write(image);
+    });
+}
+
+QByteArray BlobStore::read(const QString &file)
+{
+    QFile blob(file);
+    if (!blob.open(QIODevice::ReadOnly)) {
+        qDebug() << "open file failed, file name:" << file;
+        return QByteArray();
+    }
+    return blob.readAll();
+}
+
+void BlobStore::retain(const QStringList &files)
+{
+    QMutexLocker locker(&m_mutex);
+    for (const QString &file : files)
+        ++m_refs[file];
+}
+
+void BlobStore::release(const QStringList &files)
+{
+    QMutexLocker locker(&m_mutex);
+    for (const QString &file : files) {
+        auto it = m_refs.find(file);
+        if (it == m_refs.end() || --it.value() > 0)
+            continue;
+
+        m_refs.erase(it);
+        // 只删除缓存目录中的文件
+        if (file.startsWith(m_path + QLatin1Char('/')) && !QFile::remove(file))
+            qDebug() << "remove cache file failed, file name:" << file;
+    }
+}
+
+int BlobStore::refCount(const QString &file) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_refs.value(file);
+}
+
+void BlobStore::sweep(const QStringList &referenced, const QDateTime &before)
+{
+    QMutexLocker locker(&m_mutex);
+    for (const QString &file : referenced)
+        ++m_refs[file];
+
+    int removed = 0;
+    QDirIterator it(m_path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString file = it.next();
+        // 启动之后新写入的文件可能还没有保存到历史记录中
+        if (m_refs.contains(file) || it.fileInfo().lastModified() >= before)
+            continue;
+        if (QFile::remove(file))
+            ++removed;
+    }
+
+    if (removed > 0)
+        qDebug() << "remove unreferenced cache files:" << removed << "path:" << m_path;
+}
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BLOBSTORE_H
+#define BLOBSTORE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+/*!
+ * \~chinese \class BlobStore
+ * \~chinese \brief 按内容寻址的缓存文件存储。
+ * \~chinese 文件以内容指纹命名，按指纹前两位分目录保存，相同的内容只写入一次。
+ * \~chinese 指纹相同的文件在复用前会比较内容，内容不同时使用带序号的文件名，不会把其他数据当作这份数据。
+ * \~chinese 写入时先写临时文件再重命名，文件要么完整要么不存在。
+ * \~chinese 每次put都会增加一次引用，引用计数归零时删除文件，启动时根据历史记录重新建立引用计数。
+ * \~chinese put可以在采集线程中调用，其他接口只在GUI线程中使用。
+ */
+class BlobStore
+{
+public:
+    explicit BlobStore(const QString &path);
+
+    QString path() const { return m_path; }
+    QString filePath(quint64 hash, const QString &suffix, int index = 0) const;
+
+    QString put(quint64 hash, const QByteArray &data, const QString &suffix);
+    QString putImage(quint64 hash, const QImage &image);
+    static QByteArray read(const QString &file);
+
+    void retain(const QStringList &files);
+    void release(const QStringList &files);
+    int refCount(const QString &file) const;
+    void sweep(const QStringList &referenced, const QDateTime &before);
+
+private:
+    template<typename Matcher, typename Writer>
+    QString store(quint64 hash, const QString &suffix, Matcher matches, Writer writer);
+
+private:
+    QString m_path;
+    mutable QMutex m_mutex;
+    QHash<QString, int> m_refs;
+};
+
+#endif // BLOBSTORE_H
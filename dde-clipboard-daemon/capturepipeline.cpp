@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "capturepipeline.h"
+
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QDebug>
+
+// 最多只有一个有效的任务，另一个线程留给已被取消但还未退出的任务
+const int CaptureThreadCount = 2;
+
+CapturePipeline::CapturePipeline(Processor processor, QObject *parent)
+    : QObject(parent)
+    , m_processor(std::move(processor))
+{
+    m_pool.setMaxThreadCount(CaptureThreadCount);
+    m_pool.setObjectName(QStringLiteral("ClipboardCapture"));
+}
+
+CapturePipeline::~CapturePipeline()
+{
+    for (auto &future : m_running)
+        future.cancel();
+    m_pool.waitForDone();
+}
+
+void CapturePipeline::submit(CaptureSnapshot snapshot)
+{
+    // 新的剪贴板内容覆盖了正在处理的数据，取消还未完成的任务
+    for (auto &future : m_running) {
+        if (!future.isFinished()) {
+            qDebug() << "capture superseded by newer clipboard content";
+            future.cancel();
+        }
+    }
+
+    snapshot.sequence = m_nextSequence++;
+    const quint64 sequence = snapshot.sequence;
+
+    QFuture<CaptureResult> future = QtConcurrent::run(&m_pool, [processor = m_processor, snapshot = std::move(snapshot)](QPromise<CaptureResult> &promise) {
+        processor(promise, snapshot);
+    });
+    m_running.insert(sequence, future);
+
+    auto watcher = new QFutureWatcher<CaptureResult>(this);
+    connect(watcher, &QFutureWatcher<CaptureResult>::finished, this, [this, watcher, sequence] {
+        onTaskFinished(sequence, watcher->future());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
+void CapturePipeline::onTaskFinished(quint64 sequence, const QFuture<CaptureResult> &future)
+{
+    m_running.remove(sequence);
+
+    // 被取消的任务也要占位，保证后面的结果能够按顺序发出
+    if (future.isCanceled() || future.resultCount() == 0) {
+        m_finished.insert(sequence, std::nullopt);
+    } else {
+        CaptureResult result = future.result();
+        result.sequence = sequence;
+        m_finished.insert(sequence, result);
+    }
+
+    flush();
+}
+
+void CapturePipeline::flush()
+{
+    while (m_finished.contains(m_nextEmitSequence)) {
+        const std::optional<CaptureResult> result = m_finished.take(m_nextEmitSequence++);
+        if (result)
+            Q_EMIT resultReady(*result);
+    }
+}
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CAPTUREPIPELINE_H
+#define CAPTUREPIPELINE_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QFuture>
+#include <QPromise>
+#include <QMap>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QUrl>
+
+#include <functional>
+#include <memory>
+#include <optional>
+
+#include "payloadtransport.h"
+
+/*!
+ * \~chinese \brief 采集快照，在GUI线程上生成。
+ * \~chinese 只包含从剪贴板读取到的原始数据，以及判断重复数据所需的上次数据状态，不做任何解码、编码工作。
+ */
+struct CaptureSnapshot
+{
+    quint64 sequence = 0;
+    quint64 itemId = 0;                     // 生成的数据在历史记录中的id
+    quint64 serial = 0;                     // 采集时剪贴板变化的序号
+    QElapsedTimer started;                  // 开始采集的时间
+    int protocolType = 0;
+    bool compareWithLast = false;           // 是否需要与上次数据逐格式比对
+    bool checkRepeatImage = false;          // 是否需要过滤与上次相同的图片
+    bool checkRepeatEncodedImage = false;   // 是否需要过滤与上次相同的编码图片(只提供了image/xxx格式)
+
+    QStringList formats;
+    QMap<QString, QByteArray> formatData;   // 各格式的原始数据，不含需要忽略的格式
+    QMap<QString, QByteArray> extraData;    // 需要忽略的格式的数据，只有文件类型会用到
+    // 后端保存在文件中的较大格式只在GUI线程映射，上面的数据直接引用映射的内容，在工作线程中第一次访问时才读取
+    QMap<QString, std::shared_ptr<const PayloadTransport::MappedPayload>> spooledData;
+    QStringList deferredFormats;            // 生成预览和指纹不需要的格式，保存后再在后台读取
+    QString imageFormat;                    // 没有application/x-qt-image时提供的图片格式
+    QByteArray encodedImage;                // 编码后的图片数据，在工作线程中解码
+    QString encodedImageFormat;             // 编码后的图片数据的格式
+    QImage image;                           // 进程内直接提供的图片对象
+    bool hasImage = false;
+    bool hasUrls = false;
+    QList<QUrl> urls;
+    bool hasText = false;
+    QString text;
+    bool hasHtml = false;
+    QString html;
+    QByteArray timeStamp;
+
+    // 生成快照时的上次数据，只用于在工作线程中提前过滤，结果以接收时的上次数据为准
+    QMap<QString, quint64> lastFormatHashes;
+    quint64 lastImageHash = 0;
+};
+
+/*!
+ * \~chinese \brief 采集结果，在工作线程中生成，由GUI线程按顺序处理
+ */
+struct CaptureResult
+{
+    quint64 sequence = 0;
+    quint64 serial = 0;
+    QElapsedTimer started;
+    bool dataChanged = false;               // 与上次数据不同，需要更新上次数据的指纹
+    bool compareWithLast = false;           // 接收结果时是否需要与当时的上次数据逐格式比对
+    bool checkRepeatImage = false;          // 接收结果时是否需要过滤与当时的上次图片相同的图片
+    QMap<QString, quint64> formatHashes;
+    bool imageHashChanged = false;
+    quint64 imageHash = 0;
+    QByteArray timeStamp;
+    quint64 itemId = 0;
+    int itemType = 0;
+    quint64 itemHash = 0;
+    qint64 createTime = 0;
+    QStringList files;                      // 数据引用的缓存文件，每个文件持有一次引用
+    QStringList deferredFormats;            // 保存后需要在后台读取的格式
+    QByteArray preview;                     // 发送给界面的预览数据
+    QByteArray storeBuf;                    // 保存到历史记录中的数据，较大的数据替换为缓存文件的引用，为空表示本次没有产生新的数据
+};
+
+/*!
+ * \~chinese \class CapturePipeline
+ * \~chinese \brief 剪贴板数据采集流水线。
+ * \~chinese GUI线程只负责生成快照，哈希、解码、缩略图、编码和序列化都在独立的线程池中完成，
+ * \~chinese 结果按照快照的顺序发出。新的快照到来时，还在处理中的旧快照会被取消。
+ */
+class CapturePipeline : public QObject
+{
+    Q_OBJECT
+public:
+    using Processor = std::function<void(QPromise<CaptureResult> &promise, const CaptureSnapshot &snapshot)>;
+
+    explicit CapturePipeline(Processor processor, QObject *parent = nullptr);
+    ~CapturePipeline() override;
+
+    void submit(CaptureSnapshot snapshot);
+
+Q_SIGNALS:
+    void resultReady(const CaptureResult &result);
+
+private:
+    void onTaskFinished(quint64 sequence, const QFuture<CaptureResult> &future);
+    void flush();
+
+private:
+    Processor m_processor;
+    QThreadPool m_pool;
+    quint64 m_nextSequence = 1;             // 下一个快照的序号
+    quint64 m_nextEmitSequence = 1;         // 下一个需要处理结果的序号
+    QMap<quint64, QFuture<CaptureResult>> m_running;
+    QMap<quint64, std::optional<CaptureResult>> m_finished;
+};
+
+#endif // CAPTUREPIPELINE_H
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "capturescheduler.h"
+#include "capturestats.h"
+
+#include <QDebug>
+
+const int DefaultDebounce = 50;         // ms
+const int DefaultMaxLatency = 250;      // ms
+
+CaptureScheduler::CaptureScheduler(QObject *parent)
+    : QObject(parent)
+    , m_debounce(DefaultDebounce)
+    , m_maxLatency(DefaultMaxLatency)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &CaptureScheduler::fire);
+}
+
+void CaptureScheduler::setDebounce(int msec)
+{
+    m_debounce = qMax(0, msec);
+}
+
+void CaptureScheduler::setMaxLatency(int msec)
+{
+    m_maxLatency = qMax(0, msec);
+}
+
+void CaptureScheduler::post(int protocolType)
+{
+    ++m_received;
+    ++m_burst;
+    m_protocolType = protocolType;
+
+    if (m_pending) {
+        ++m_suppressed;
+    } else {
+        m_pending = true;
+        m_pendingSince.start();
+    }
+
+    // 每个新事件都推迟采集，但距离第一个未处理的事件不超过maxLatency
+    const qint64 remaining = qMax<qint64>(0, m_maxLatency - m_pendingSince.elapsed());
+    m_timer.start(static_cast<int>(qMin<qint64>(m_debounce, remaining)));
+}
+
+void CaptureScheduler::resetCounters()
+{
+    m_received = 0;
+    m_suppressed = 0;
+    m_triggered = 0;
+}
+
+void CaptureScheduler::fire()
+{
+    if (!m_pending)
+        return;
+
+    if (m_burst > 1)
+        qDebug() << "coalesced clipboard changes:" << m_burst << "waited:" << m_pendingSince.elapsed() << "ms";
+
+    CaptureStats::instance().record(CaptureStats::Coalesce, m_pendingSince.nsecsElapsed());
+    m_pending = false;
+    m_burst = 0;
+    ++m_triggered;
+    Q_EMIT triggered(m_protocolType);
+}
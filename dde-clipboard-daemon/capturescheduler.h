@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CAPTURESCHEDULER_H
+#define CAPTURESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/*!
+ * \~chinese \class CaptureScheduler
+ * \~chinese \brief 合并剪贴板变化事件。
+ * \~chinese 事件到来后等待一段时间(debounce)，期间没有新的事件才开始采集；连续不断的事件最多等待maxLatency就采集一次。
+ * \~chinese 被合并的事件不会读取任何数据，一次连续的变化只采集最后的状态。
+ */
+class CaptureScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CaptureScheduler(QObject *parent = nullptr);
+
+    void setDebounce(int msec);
+    int debounce() const { return m_debounce; }
+    void setMaxLatency(int msec);
+    int maxLatency() const { return m_maxLatency; }
+
+    void post(int protocolType);
+
+    quint64 receivedCount() const { return m_received; }
+    quint64 suppressedCount() const { return m_suppressed; }
+    quint64 triggeredCount() const { return m_triggered; }
+    void resetCounters();
+
+Q_SIGNALS:
+    void triggered(int protocolType);
+
+private:
+    void fire();
+
+private:
+    QTimer m_timer;
+    QElapsedTimer m_pendingSince;           // 第一个还未处理的事件到来的时间
+    int m_debounce;
+    int m_maxLatency;
+    bool m_pending = false;
+    int m_protocolType = 0;
+    int m_burst = 0;                        // 本次合并的事件数
+
+    quint64 m_received = 0;
+    quint64 m_suppressed = 0;               // 被后续事件覆盖、没有采集的事件数
+    quint64 m_triggered = 0;
+};
+
+#endif // CAPTURESCHEDULER_H
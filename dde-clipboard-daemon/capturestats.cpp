@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "capturestats.h"
+
+#include <QHash>
+#include <QtAlgorithms>
+#include <QtMath>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+int LatencyHistogram::bucketIndex(quint64 value)
+{
+    // 较小的值每个值一个桶，其余按最高位所在的区间分桶，每个区间再按接下来的几位细分
+    if (value < SubBucketCount)
+        return static_cast<int>(value);
+
+    const int shift = 63 - qCountLeadingZeroBits(value) - SubBucketBits;
+    const int sub = static_cast<int>((value >> shift) & (SubBucketCount - 1));
+    return (shift + 1) * SubBucketCount + sub;
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBucketCount)
+        return static_cast<quint64>(index);
+
+    const int shift = index / SubBucketCount - 1;
+    const quint64 sub = static_cast<quint64>(index % SubBucketCount);
+    const quint64 lower = (SubBucketCount + sub) << shift;
+    return lower + ((quint64(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(quint64 value)
+{
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    quint64 current = m_max.load(std::memory_order_relaxed);
+    while (value > current && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::percentile(double percent) const
+{
+    // 读取时其他线程可能还在记录，以各个桶的计数为准
+    quint64 total = 0;
+    quint64 counts[BucketCount];
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+        return 0;
+
+    const quint64 target = qMax<quint64>(1, static_cast<quint64>(qCeil(qBound(0.0, percent, 100.0) / 100.0 * total)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= target)
+            return qMin(bucketUpperBound(i), max());
+    }
+    return max();
+}
+
+CaptureStats &CaptureStats::instance()
+{
+    static CaptureStats stats;
+    return stats;
+}
+
+QString CaptureStats::stageName(Stage stage)
+{
+    switch (stage) {
+    case Coalesce:
+        return QStringLiteral("coalesce");
+    case MimeFilter:
+        return QStringLiteral("mimeFilter");
+    case FormatRead:
+        return QStringLiteral("formatRead");
+    case DeferredRead:
+        return QStringLiteral("deferredRead");
+    case Dedup:
+        return QStringLiteral("dedup");
+    case ImageDecode:
+        return QStringLiteral("imageDecode");
+    case CacheWrite:
+        return QStringLiteral("cacheWrite");
+    case ThumbnailScale:
+        return QStringLiteral("thumbnailScale");
+    case Serialize:
+        return QStringLiteral("serialize");
+    case Store:
+        return QStringLiteral("store");
+    case Emit:
+        return QStringLiteral("emit");
+    case Total:
+        return QStringLiteral("total");
+    default:
+        return QString();
+    }
+}
+
+void CaptureStats::record(Stage stage, qint64 nsecs)
+{
+    m_stages[stage].record(static_cast<quint64>(qMax<qint64>(0, nsecs)) / 1000);
+}
+
+CaptureStats::FormatSlot &CaptureStats::formatSlot(const QString &format)
+{
+    quint64 key = qHash(format);
+    if (key == 0)
+        key = 1;
+
+    for (int i = 0; i < FormatSlotCount; ++i) {
+        FormatSlot &slot = m_formats[(key + i) % FormatSlotCount];
+        quint64 current = slot.key.load(std::memory_order_acquire);
+        // 空闲的槽位由第一个抢到的线程写入名称，失败时current为其他线程写入的哈希值
+        if (current == 0 && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+            slot.name = format;
+            slot.ready.store(true, std::memory_order_release);
+            return slot;
+        }
+        if (current == key)
+            return slot;
+    }
+    return m_otherFormats;
+}
+
+void CaptureStats::addFormatBytes(const QString &format, qint64 bytes)
+{
+    formatSlot(format).bytes.fetch_add(static_cast<quint64>(qMax<qint64>(0, bytes)), std::memory_order_relaxed);
+}
+
+void CaptureStats::addFormatTime(const QString &format, qint64 nsecs)
+{
+    formatSlot(format).time.fetch_add(static_cast<quint64>(qMax<qint64>(0, nsecs)) / 1000, std::memory_order_relaxed);
+}
+
+QVariantMap CaptureStats::toVariantMap() const
+{
+    QVariantMap stages;
+    for (int i = 0; i < StageCount; ++i) {
+        const LatencyHistogram &histogram = m_stages[i];
+        if (histogram.count() == 0)
+            continue;
+
+        QVariantMap stage;
+        stage.insert(QStringLiteral("count"), histogram.count());
+        stage.insert(QStringLiteral("mean"), histogram.sum() / histogram.count());
+        stage.insert(QStringLiteral("p50"), histogram.percentile(50));
+        stage.insert(QStringLiteral("p90"), histogram.percentile(90));
+        stage.insert(QStringLiteral("p99"), histogram.percentile(99));
+        stage.insert(QStringLiteral("max"), histogram.max());
+        stages.insert(stageName(static_cast<Stage>(i)), stage);
+    }
+
+    QVariantMap formatBytes;
+    QVariantMap formatTime;
+    auto addFormat = [&formatBytes, &formatTime](const QString &name, const FormatSlot &slot) {
+        const quint64 bytes = slot.bytes.load(std::memory_order_relaxed);
+        const quint64 time = slot.time.load(std::memory_order_relaxed);
+        // 重置后没有再记录的格式不输出
+        if (bytes == 0 && time == 0)
+            return;
+        formatBytes.insert(name, bytes);
+        formatTime.insert(name, time);
+    };
+    for (const FormatSlot &slot : m_formats) {
+        if (slot.ready.load(std::memory_order_acquire))
+            addFormat(slot.name, slot);
+    }
+    addFormat(QStringLiteral("other"), m_otherFormats);
+
+    QVariantMap map;
+    map.insert(QStringLiteral("unit"), QStringLiteral("us"));
+    map.insert(QStringLiteral("stages"), stages);
+    map.insert(QStringLiteral("formatBytes"), formatBytes);
+    map.insert(QStringLiteral("formatTime"), formatTime);
+    return map;
+}
+
+void CaptureStats::reset()
+{
+    for (auto &histogram : m_stages)
+        histogram.reset();
+
+    // 其他线程可能正在使用槽位，只清零计数，保留已经分配的格式
+    for (FormatSlot &slot : m_formats) {
+        slot.bytes.store(0, std::memory_order_relaxed);
+        slot.time.store(0, std::memory_order_relaxed);
+    }
+    m_otherFormats.bytes.store(0, std::memory_order_relaxed);
+    m_otherFormats.time.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CAPTURESTATS_H
+#define CAPTURESTATS_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVariantMap>
+
+#include <atomic>
+
+/*!
+ * \~chinese \class LatencyHistogram
+ * \~chinese \brief 对数分桶的耗时直方图(HDR风格)，记录时只做原子加，可以在多个线程中同时记录。
+ * \~chinese 每个2的幂区间分为8个桶，统计的分位值相对误差不超过12.5%。
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 3;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+    static constexpr int BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+    LatencyHistogram();
+
+    void record(quint64 value);
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    quint64 sum() const { return m_sum.load(std::memory_order_relaxed); }
+    quint64 max() const { return m_max.load(std::memory_order_relaxed); }
+    quint64 percentile(double percent) const;
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    Q_DISABLE_COPY(LatencyHistogram)
+
+    std::atomic<quint64> m_buckets[BucketCount];
+    std::atomic<quint64> m_count;
+    std::atomic<quint64> m_sum;
+    std::atomic<quint64> m_max;
+};
+
+/*!
+ * \~chinese \class CaptureStats
+ * \~chinese \brief 剪贴板采集各阶段的耗时(us)和各格式读取的数据量统计。
+ * \~chinese 各格式的统计放在固定数量的槽位中，按格式名称的哈希值开放寻址，记录时只做原子操作，不加锁；
+ * \~chinese 槽位用完后新的格式计入other。哈希值相同的不同格式会合并统计
+ */
+class CaptureStats
+{
+public:
+    enum Stage {
+        Coalesce,           // 第一个变化事件到开始采集
+        MimeFilter,         // 读取格式列表并过滤
+        FormatRead,         // 读取单个格式的数据
+        DeferredRead,       // 保存后在后台读取单个延后的格式
+        Dedup,              // 计算指纹并与上次数据比对
+        ImageDecode,        // 解码图片
+        CacheWrite,         // 写入图片缓存文件
+        ThumbnailScale,     // 生成缩略图
+        Serialize,          // 序列化数据
+        Store,              // 写入历史记录
+        Emit,               // 发送通知
+        Total,              // 开始采集到发出通知
+        StageCount
+    };
+
+    static CaptureStats &instance();
+    static QString stageName(Stage stage);
+
+    void record(Stage stage, qint64 nsecs);
+    void addFormatBytes(const QString &format, qint64 bytes);
+    void addFormatTime(const QString &format, qint64 nsecs);
+    QVariantMap toVariantMap() const;
+    void reset();
+
+private:
+    struct FormatSlot {
+        std::atomic<quint64> key { 0 };         // 格式名称的哈希值，0表示空闲
+        std::atomic<bool> ready { false };      // 名称写入后才能读取
+        QString name;
+        std::atomic<quint64> bytes { 0 };
+        std::atomic<quint64> time { 0 };        // 读取的累计耗时(us)
+    };
+    static constexpr int FormatSlotCount = 64;
+
+    CaptureStats() = default;
+    Q_DISABLE_COPY(CaptureStats)
+
+    FormatSlot &formatSlot(const QString &format);
+
+    LatencyHistogram m_stages[StageCount];
+    FormatSlot m_formats[FormatSlotCount];
+    FormatSlot m_otherFormats;                  // 槽位用完后的其他格式
+};
+
+/*!
+ * \~chinese \class StageTimer
+ * \~chinese \brief 记录所在作用域的耗时
+ */
+class StageTimer
+{
+public:
+    explicit StageTimer(CaptureStats::Stage stage)
+        : m_stage(stage)
+    {
+        m_timer.start();
+    }
+
+    ~StageTimer()
+    {
+        CaptureStats::instance().record(m_stage, m_timer.nsecsElapsed());
+    }
+
+private:
+    Q_DISABLE_COPY(StageTimer)
+
+    CaptureStats::Stage m_stage;
+    QElapsedTimer m_timer;
+};
+
+#endif // CAPTURESTATS_H
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "clipboardbackend.h"
+#include "wlrintegration/wlrdatacontrolclipboardinterface.h"
+
+#include <QClipboard>
+#include <QGuiApplication>
+
+ClipboardBackend *ClipboardBackend::create(QObject *parent)
+{
+    if (QStringLiteral("wayland") == qGuiApp->platformName())
+        return new WlrDataControlClipboardInterface(parent);
+
+    return new X11ClipboardBackend(parent);
+}
+
+X11ClipboardBackend::X11ClipboardBackend(QObject *parent)
+    : ClipboardBackend(parent)
+    , m_board(qApp->clipboard())
+{
+    connect(m_board, &QClipboard::dataChanged, this, &ClipboardBackend::dataChanged);
+}
+
+const QMimeData *X11ClipboardBackend::mimeData() const
+{
+    return m_board ? m_board->mimeData() : nullptr;
+}
+
+void X11ClipboardBackend::setMimeData(QMimeData *mimeData)
+{
+    if (!m_board) {
+        delete mimeData;
+        return;
+    }
+
+    m_board->setMimeData(mimeData);
+}
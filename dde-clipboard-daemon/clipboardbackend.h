@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CLIPBOARDBACKEND_H
+#define CLIPBOARDBACKEND_H
+
+#include <QObject>
+#include <QMimeData>
+#include <QDBusUnixFileDescriptor>
+#include <QPointer>
+#include <QStringList>
+#include <QVariantMap>
+
+class QClipboard;
+
+const int X11_PROTOCOL = 0;                     // x11协议
+const int WAYLAND_PROTOCOL = 1;                 // wayland协议
+
+/*!
+ * \~chinese \class ClipboardBackend
+ * \~chinese \brief 系统剪贴板的读写接口。
+ * \~chinese 采集逻辑只通过该接口访问剪贴板，不关心底层是X11、wlr-data-control还是测试用的内存实现(tests/dde-clipboard-daemon/memoryclipboardbackend.h)。
+ */
+class ClipboardBackend : public QObject
+{
+    Q_OBJECT
+public:
+    using QObject::QObject;
+
+    /*!
+     * \~chinese \brief 根据当前的平台创建剪贴板后端，wayland下使用wlr-data-control协议，其他平台使用QClipboard
+     */
+    static ClipboardBackend *create(QObject *parent = nullptr);
+
+    /*!
+     * \~chinese \brief 当前剪贴板的数据，剪贴板内容变化后原来的指针可能失效
+     */
+    virtual const QMimeData *mimeData() const = 0;
+
+    /*!
+     * \~chinese \brief 设置剪贴板的数据，接管mimeData的所有权
+     */
+    virtual void setMimeData(QMimeData *mimeData) = 0;
+
+    /*!
+     * \~chinese \brief 数据来源的协议类型，X11_PROTOCOL或WAYLAND_PROTOCOL
+     */
+    virtual int protocolType() const = 0;
+
+    /*!
+     * \~chinese \brief 当前数据中还在后台读取、暂时不能从mimeData()获取的格式，读取结束后发出pendingFormatsFinished
+     */
+    virtual QStringList pendingFormats() const { return QStringList(); }
+
+    /*!
+     * \~chinese \brief 当前数据中保存在文件(密封的memfd)中的较大格式，返回的描述符持有自己的副本，数据替换后仍然有效。
+     * \~chinese 调用方映射后在工作线程中读取，不需要通过mimeData()在GUI线程中读入内存，不是文件时返回无效的描述符
+     */
+    virtual QDBusUnixFileDescriptor spooledFile(const QString &format) const { Q_UNUSED(format) return QDBusUnixFileDescriptor(); }
+
+    /*!
+     * \~chinese \brief 后端自己发送粘贴数据时的统计，由Qt发送数据的后端返回空
+     */
+    virtual QVariantMap pasteStats() const { return QVariantMap(); }
+    virtual void resetPasteStats() {}
+
+Q_SIGNALS:
+    void dataChanged();
+    void pendingFormatsFinished();
+};
+
+/*!
+ * \~chinese \class X11ClipboardBackend
+ * \~chinese \brief 基于QClipboard的剪贴板后端，用于X11以及offscreen等非wayland平台
+ */
+class X11ClipboardBackend : public ClipboardBackend
+{
+    Q_OBJECT
+public:
+    explicit X11ClipboardBackend(QObject *parent = nullptr);
+
+    const QMimeData *mimeData() const override;
+    void setMimeData(QMimeData *mimeData) override;
+    int protocolType() const override { return X11_PROTOCOL; }
+
+private:
+    QPointer<QClipboard> m_board;
+};
+
+#endif // CLIPBOARDBACKEND_H
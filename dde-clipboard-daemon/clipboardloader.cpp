@@ -4,134 +4,463 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "clipboardloader.h"
+#include "contenthash.h"
+#include "blobstore.h"
+#include "payloadtransport.h"
+#include "capturestats.h"
+#include "mimepolicy.h"
+#include "imagemimedata.h"
+#include "blobmimedata.h"
+#include "itemcodec.h"
 
 #include <QGuiApplication>
-#include <QClipboard>
 #include <QMimeData>
 #include <QDir>
+#include <QFileInfo>
 #include <QStandardPaths>
 #include <QImageReader>
 #include <QImageWriter>
-#include <QBuffer>
 #include <QSet>
+#include <QMutex>
+#include <QTimer>
+#include <QDBusMetaType>
+#include <QDBusConnection>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 const QString PixCacheDir = QStringLiteral("/clipboard-pix");  // 图片缓存目录名
+const QString HistoryDir = QStringLiteral("/history");          // 历史记录目录名
+const int MaxHistoryItems = 1000;                               // 历史记录最多保留的数量
+const qint64 MaxHistoryBytes = 512 * 1024 * 1024;               // 历史记录和引用的缓存文件最多占用的空间
+const int InlineBlobSize = 64 * 1024;                           // 超过该大小的数据单独保存，历史记录中只保存引用
 const int MAX_BETYARRAY_SIZE = 10*1024*1024;    // 最大支持的文本大小
-const int X11_PROTOCOL = 0;                     // x11协议
-const int WAYLAND_PROTOCOL = 1;                 // wayland协议
 const QString PngImageLiteral = QStringLiteral("image/png");  // PNG图片格式
 const QByteArray CleanLastData = QByteArrayLiteral("CLEAN_LAST_DATA");  // 清除上次数据的标识
+const int MaxListCount = 100;                   // 一次最多返回的预览数据条数
+const int RepeatImageInterval = 500;            // 两次采集间隔小于该时间(ms)时过滤重复的图片
 
-QByteArray Info2Buf(const ItemInfo &info)
+// 判断是否应该忽略保存的目标格式
+static bool shouldIgnoreSaveTarget(const QString& format)
 {
-    QByteArray buf;
+    // 这些系统格式不需要保存用于比对
+    static QSet<QString> ignoreSaveTargetSet = {
+        "SAVE_TARGETS", "TARGETS", "TIMESTAMP", "MULTIPLE",
+        "DELETE", "INSERT_PROPERTY", "INSERT_SELECTION"
+    };
 
-    QByteArray iconBuf;
-    if (info.m_formatMap.keys().contains("x-dfm-copied/file-icons")) {
-        iconBuf = info.m_formatMap["x-dfm-copied/file-icons"];
+    if (ignoreSaveTargetSet.contains(format))
+        return true;
+
+    // 对于图片格式，只保留特定的几种，其他的忽略
+    if (format.startsWith("image/")) {
+        if (format == "image/jpeg" ||
+                format == "image/png" ||
+                format == "image/bmp")
+            return false;
+        return true;
     }
+    return false;
+}
 
-    QDataStream stream(&buf, QIODevice::WriteOnly);
-    stream.setVersion(QDataStream::Qt_5_11);
-    stream << info.m_formatMap
-           << info.m_type
-           << info.m_urls
-           << info.m_hasImage;
-    if (info.m_hasImage) {
-        stream << info.m_variantImage;
-        stream << info.m_pixSize;
+// 计算整条数据的指纹，作为历史记录去重的依据
+static quint64 itemFingerprint(DataType type, const QMap<QString, quint64> &formatHashes)
+{
+    ContentHasher hasher;
+    hasher.addValue(type);
+    for (auto it = formatHashes.cbegin(); it != formatHashes.cend(); ++it) {
+        if (shouldIgnoreSaveTarget(it.key()))
+            continue;
+        hasher.addString(it.key());
+        hasher.addValue(it.value());
     }
-    stream  << info.m_enable
-            << info.m_text
-            << info.m_createTime
-            << iconBuf;
+    return hasher.result();
+}
 
-    return buf;
+// 图片只以图像内容作为指纹，缓存路径、时间戳等附加格式不参与计算
+static quint64 imageFingerprint(quint64 contentHash)
+{
+    ContentHasher hasher;
+    hasher.addValue(Image);
+    hasher.addValue(contentHash);
+    return hasher.result();
 }
 
-ItemInfo Buf2Info(const QByteArray &buf)
+// 读取单个格式的数据，记录耗时和数据量
+static QByteArray readFormat(const QMimeData *mimeData, const QString &format, const ClipboardBackend *backend, CaptureSnapshot &snapshot)
 {
-    QByteArray tempBuf = buf;
+    QElapsedTimer timer;
+    timer.start();
+
+    // 保存在文件中的格式只映射不读取，快照持有映射，数据在工作线程中计算指纹、保存时才读入
+    const QDBusUnixFileDescriptor file = backend->spooledFile(format);
+    if (file.isValid()) {
+        auto mapped = std::make_shared<const PayloadTransport::MappedPayload>(file);
+        if (mapped->isValid()) {
+            snapshot.spooledData.insert(format, mapped);
+            const qint64 elapsed = timer.nsecsElapsed();
+            CaptureStats::instance().record(CaptureStats::FormatRead, elapsed);
+            CaptureStats::instance().addFormatBytes(format, mapped->data().size());
+            CaptureStats::instance().addFormatTime(format, elapsed);
+            return mapped->data();
+        }
+    }
 
-    ItemInfo info;
+    const QByteArray data = mimeData->data(format);
+    const qint64 elapsed = timer.nsecsElapsed();
+    CaptureStats::instance().record(CaptureStats::FormatRead, elapsed);
+    CaptureStats::instance().addFormatBytes(format, data.size());
+    CaptureStats::instance().addFormatTime(format, elapsed);
+    return data;
+}
 
-    QDataStream stream(&tempBuf, QIODevice::ReadOnly);
-    stream.setVersion(QDataStream::Qt_5_11);
-    int type;
-    QByteArray iconBuf;
-    stream >> info.m_formatMap
-           >> type
-           >> info.m_urls
-           >> info.m_hasImage;
-    if (info.m_hasImage) {
-        stream >> info.m_variantImage;
-        stream >> info.m_pixSize;
+// 取application/x-qt-image对应的编码数据，image/png无损且最常见，优先使用
+static QByteArray encodedImageData(const QMimeData *mimeData, const ClipboardBackend *backend, CaptureSnapshot &snapshot, QString &imageFormat)
+{
+    QStringList candidates;
+    for (const QString &format : snapshot.formats) {
+        if (!format.startsWith("image/"))
+            continue;
+        if (format == PngImageLiteral)
+            candidates.prepend(format);
+        else
+            candidates.append(format);
     }
 
-    stream >> info.m_enable
-           >> info.m_text
-           >> info.m_createTime
-           >> iconBuf;
-
-    QDataStream stream2(&iconBuf, QIODevice::ReadOnly);
-    stream2.setVersion(QDataStream::Qt_5_11);
-    for (int i = 0 ; i < info.m_urls.size(); ++i) {
-        FileIconData data;
-        stream2 >> data.cornerIconList >> data.fileIcon;
-        info.m_iconDataList.push_back(data);
+    for (const QString &format : candidates) {
+        const QByteArray data = snapshot.formatData.contains(format) ? snapshot.formatData.value(format) : readFormat(mimeData, format, backend, snapshot);
+        if (!data.isEmpty()) {
+            imageFormat = format;
+            return data;
+        }
     }
+    return QByteArray();
+}
 
-    info.m_type = static_cast<DataType>(type);
+// 保留来源提供的编码数据，粘贴时直接发送，不再重新编码；png数据已经保存为缓存文件，不重复保存
+static void keepEncodedImage(const CaptureSnapshot &snapshot, ItemInfo &info)
+{
+    if (snapshot.encodedImage.isEmpty() || snapshot.encodedImageFormat.isEmpty())
+        return;
+    if (snapshot.encodedImageFormat == PngImageLiteral && !info.m_urls.isEmpty())
+        return;
 
-    return info;
+    info.m_formatMap.insert(snapshot.encodedImageFormat, snapshot.encodedImage);
 }
 
-// 判断是否应该忽略保存的目标格式
-static bool shouldIgnoreSaveTarget(const QString& format)
+// 来源提供的png数据可以直接作为缓存文件
+static QByteArray encodedPng(const CaptureSnapshot &snapshot)
 {
-    // 这些系统格式不需要保存用于比对
-    static QSet<QString> ignoreSaveTargetSet = {
-        "SAVE_TARGETS", "TARGETS", "TIMESTAMP", "MULTIPLE",
-        "DELETE", "INSERT_PROPERTY", "INSERT_SELECTION"
-    };
+    return snapshot.encodedImageFormat == PngImageLiteral ? snapshot.encodedImage : QByteArray();
+}
 
-    if (ignoreSaveTargetSet.contains(format))
-        return true;
+// 比对两次复制数据的指纹，不再保留上次数据的副本逐字节比较
+static bool formatsChanged(const QMap<QString, quint64> &formatHashes, const QMap<QString, quint64> &lastFormatHashes)
+{
+    for (auto it = formatHashes.cbegin(); it != formatHashes.cend(); ++it) {
+        const QString &f = it.key();
+        // 跳过需要忽略的格式（系统格式和不需要的图片格式）
+        if (shouldIgnoreSaveTarget(f))
+            continue;
 
-    // 对于图片格式，只保留特定的几种，其他的忽略
-    if (format.startsWith("image/")) {
-        if (format == "image/jpeg" ||
-                format == "image/png" ||
-                format == "image/bmp")
-            return false;
-        return true;
+        // 需要先判断历史数据中是否存在此格式
+        if (!lastFormatHashes.contains(f))
+            return true;
+
+        // qt 转换的数据可能没准备好(指纹为0), 防止刷数据。
+        if (f == ApplicationXQtImageLiteral && it.value() == 0)
+            continue;
+
+        if (lastFormatHashes.value(f) != it.value())
+            return true;
     }
     return false;
 }
 
-QString ClipboardLoader::m_pixPath;
+// 图片缓存和较大的数据按内容保存，相同的内容只保存一份
+static BlobStore &blobStore()
+{
+    static BlobStore store(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + PixCacheDir);
+    return store;
+}
 
-ClipboardLoader::ClipboardLoader(QObject *parent)
-    : QObject(parent)
-    , m_board(nullptr)
-    , m_wlrClipboard(nullptr)
+// 历史记录中较大的数据单独保存为缓存文件，记录在m_blobFiles中，多条记录中相同的数据只保存一份
+static void externalizeBlobs(ItemInfo &info, QStringList &files)
 {
-    if (QStringLiteral("wayland") == qGuiApp->platformName()) {
-        m_wlrClipboard = new WlrDataControlClipboardInterface(this);
+    for (auto it = info.m_formatMap.begin(); it != info.m_formatMap.end(); ++it) {
+        if (it.value().size() < InlineBlobSize)
+            continue;
+
+        const QString file = blobStore().put(ContentHasher::hash(it.value()), it.value(), QStringLiteral(".blob"));
+        if (file.isEmpty())
+            continue;
+
+        files.append(file);
+        info.m_blobFiles.insert(it.key(), file);
+        it.value() = QByteArray();
+    }
+}
+
+// 还原历史记录中单独保存的数据，info需要以ItemCodec::BlobFiles解码自历史记录
+static void restoreBlobs(ItemInfo &info)
+{
+    for (auto it = info.m_blobFiles.cbegin(); it != info.m_blobFiles.cend(); ++it)
+        info.m_formatMap.insert(it.key(), BlobStore::read(it.value()));
+    info.m_blobFiles.clear();
+}
+
+// 工作线程中根据快照生成数据，返回false表示本次不产生新数据或任务已被取消
+static bool buildItemInfo(QPromise<CaptureResult> &promise, const CaptureSnapshot &snapshot, CaptureResult &result, ItemInfo &info)
+{
+    QImage srcImage = snapshot.image;
+    if (srcImage.isNull() && !snapshot.encodedImage.isEmpty() && snapshot.formats.contains(ApplicationXQtImageLiteral)) {
+        StageTimer span(CaptureStats::ImageDecode);
+        srcImage = QImage::fromData(snapshot.encodedImage);
+    }
+
+    if (promise.isCanceled())
+        return false;
+
+    {
+        StageTimer span(CaptureStats::Dedup);
+        // 每种格式的数据只计算一次指纹，图片直接对像素数据计算指纹，不再编码成PNG后比对
+        for (const QString &format : snapshot.formats) {
+            if (shouldIgnoreSaveTarget(format)) {
+                result.formatHashes.insert(format, 0);
+            } else if (format == ApplicationXQtImageLiteral) {
+                result.formatHashes.insert(format, ContentHasher::hashImage(srcImage));
+            } else if (!snapshot.formatData.contains(format)) {
+                // 没有立即读取的格式不参与比对和去重
+                result.formatHashes.insert(format, 0);
+            } else {
+                result.formatHashes.insert(format, ContentHasher::hash(snapshot.formatData.value(format)));
+            }
+        }
+
+        // 对比上次粘贴的数据，如果一样就不再粘贴。快照中的上次数据可能已经过时，接收结果时还会再比对一次
+        result.compareWithLast = snapshot.compareWithLast;
+        result.dataChanged = !snapshot.compareWithLast || formatsChanged(result.formatHashes, snapshot.lastFormatHashes);
+    }
+
+    if (!result.dataChanged) {
+        qDebug() << "Data is same, do not paste";
+        return false;
+    }
+
+    if (snapshot.hasImage) {
+        if (srcImage.isNull()) {
+            qDebug() << "mimeData->imageData() QImage is null.";
+            return false;
+        }
+
+        const quint64 imageHash = result.formatHashes.value(ApplicationXQtImageLiteral);
+        result.checkRepeatImage = snapshot.checkRepeatImage;
+        if (snapshot.checkRepeatImage && imageHash == snapshot.lastImageHash) {
+            qDebug() << "system repeat image";
+            return false;
+        }
+
+        info.m_pixSize = srcImage.size();
+        if (promise.isCanceled())
+            return false;
+        if (!ClipboardLoader::cachePixmap(srcImage, info, imageHash, encodedPng(snapshot))) {
+            info.m_variantImage = srcImage;
+        }
+
+        info.m_formatMap.insert(ApplicationXQtImageLiteral, info.m_variantImage.toByteArray());
+        keepEncodedImage(snapshot, info);
+        info.m_formatMap.insert("TIMESTAMP", snapshot.timeStamp);
+        if (info.m_variantImage.isNull())
+            return false;
+
+        result.imageHashChanged = true;
+        result.imageHash = imageHash;
+
+        info.m_hasImage = true;
+        info.m_type = Image;
+        info.m_hash = imageFingerprint(imageHash);
+    } else if (!snapshot.imageFormat.isEmpty()) {
+        {
+            StageTimer span(CaptureStats::ImageDecode);
+            srcImage = QImage::fromData(snapshot.encodedImage);
+        }
+        if (srcImage.isNull())
+            return false;
+
+        const quint64 imageHash = ContentHasher::hashImage(srcImage);
+        result.checkRepeatImage = snapshot.checkRepeatEncodedImage;
+        if (snapshot.checkRepeatEncodedImage && imageHash == snapshot.lastImageHash) {
+            qDebug() << "Current image from data is same as the last image, ignored";
+            return false;
+        }
+
+        info.m_pixSize = srcImage.size();
+        if (promise.isCanceled())
+            return false;
+        if (!ClipboardLoader::cachePixmap(srcImage, info, imageHash, encodedPng(snapshot))) {
+            info.m_variantImage = srcImage;
+        }
+
+        info.m_formatMap.insert(snapshot.imageFormat, info.m_variantImage.toByteArray());
+        keepEncodedImage(snapshot, info);
+        info.m_formatMap.insert("TIMESTAMP", snapshot.timeStamp);
+        if (info.m_variantImage.isNull())
+            return false;
+
+        result.imageHashChanged = true;
+        result.imageHash = imageHash;
+
+        info.m_hasImage = true;
+        info.m_type = Image;
+        info.m_hash = imageFingerprint(imageHash);
+    } else if (snapshot.hasUrls) {
+        info.m_urls = snapshot.urls;
+        if (info.m_urls.isEmpty())
+            return false;
+
+        for (const QString &format : snapshot.formats) {
+            const QByteArray &data = snapshot.formatData.contains(format) ? snapshot.formatData.value(format) : snapshot.extraData.value(format);
+            if (!data.isEmpty())
+                info.m_formatMap.insert(format, data);
+        }
+        if (info.m_formatMap.isEmpty())
+            return false;
 
-        connect(m_wlrClipboard, &WlrDataControlClipboardInterface::dataChanged, this, [this] {
-            this->doWork(WAYLAND_PROTOCOL);
-        });
+        info.m_type = File;
+        info.m_hash = itemFingerprint(File, result.formatHashes);
     } else {
-        m_board = qApp->clipboard();
-        connect(m_board, &QClipboard::dataChanged, this, [this] {
-            this->doWork(X11_PROTOCOL);
-        });
+        // 保存在文件中的文本没有在GUI线程中解码
+        if (snapshot.hasText) {
+            info.m_text = snapshot.spooledData.contains(TextPlainLiteral) ? QString::fromUtf8(snapshot.formatData.value(TextPlainLiteral))
+                                                                          : snapshot.text;
+            // X11下，按住ctrl+c不放会出现hasText但是text/plain格式为空的情况，这里特殊处理一下
+            if (info.m_text.isEmpty() && snapshot.protocolType != WAYLAND_PROTOCOL)
+                info.m_text = snapshot.formatData.value(TextPlainLiteral);
+        } else if (snapshot.hasHtml) {
+            info.m_text = snapshot.spooledData.contains(TextHtmlLiteral) ? QString::fromUtf8(snapshot.formatData.value(TextHtmlLiteral))
+                                                                         : snapshot.html;
+        } else {
+            return false;
+        }
+
+        const QByteArray &textByteArray = info.m_text.toUtf8();
+        if (info.m_text.isEmpty() || textByteArray.size() > MAX_BETYARRAY_SIZE)
+            return false;
+
+        // 保存所有数据，确保正常粘贴,缺少任意一种格式都可能导致粘贴失败
+        for (auto f : snapshot.formats) {
+            // 跳过需要忽略的格式，延后读取的格式在保存后补充
+            if (shouldIgnoreSaveTarget(f) || snapshot.deferredFormats.contains(f))
+                continue;
+
+            info.m_formatMap.insert(f, snapshot.formatData.value(f));
+        }
+
+        info.m_type = Text;
+        info.m_hash = itemFingerprint(Text, result.formatHashes);
     }
-    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + PixCacheDir);
-    if (dir.exists() && dir.removeRecursively()) {
-        qDebug() << "ClipboardLoader startup, remove old cache, path:" << dir.path();
+
+    return !promise.isCanceled();
+}
+
+static void processCapture(QPromise<CaptureResult> &promise, const CaptureSnapshot &snapshot)
+{
+    CaptureResult result;
+    result.serial = snapshot.serial;
+    result.started = snapshot.started;
+    result.timeStamp = snapshot.timeStamp;
+
+    ItemInfo info;
+    info.m_variantImage = 0;
+    info.m_id = snapshot.itemId;
+    const bool built = buildItemInfo(promise, snapshot, result, info);
+
+    // 图片数据的url为缓存文件，由历史记录管理；没有生成数据时也已经写入了缓存文件，需要释放
+    if (snapshot.hasImage || !snapshot.imageFormat.isEmpty()) {
+        for (const QUrl &url : std::as_const(info.m_urls))
+            result.files.append(url.toLocalFile());
     }
+
+    if (!built) {
+        blobStore().release(result.files);
+        result.files.clear();
+    } else {
+        info.m_createTime = QDateTime::currentDateTime();
+        info.m_enable = true;
+
+        result.itemId = info.m_id;
+        result.deferredFormats = snapshot.deferredFormats;
+        result.itemType = info.m_type;
+        result.itemHash = info.m_hash;
+        result.createTime = info.m_createTime.toMSecsSinceEpoch();
+
+        StageTimer span(CaptureStats::Serialize);
+        result.preview = ItemCodec::encodePreview(info);
+
+        ItemInfo storeInfo = info;
+        externalizeBlobs(storeInfo, result.files);
+        result.storeBuf = ItemCodec::encode(storeInfo);
+    }
+
+    // 任务被取消时结果不会被接收，释放本次采集对缓存文件的引用
+    if (!promise.addResult(result))
+        blobStore().release(result.files);
+}
+
+QString ClipboardLoader::m_pixPath;
+
+ClipboardLoader::ClipboardLoader(QObject *parent)
+    : ClipboardLoader(ClipboardBackend::create(), parent)
+{
+}
+
+ClipboardLoader::ClipboardLoader(ClipboardBackend *backend, QObject *parent)
+    : QObject(parent)
+    , m_backend(backend)
+    , m_scheduler(new CaptureScheduler(this))
+    , m_pipeline(new CapturePipeline(processCapture, this))
+    , m_fetcher(new DeferredFormatFetcher(backend, this))
+    , m_store(new HistoryStore(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + HistoryDir, this))
+{
+    qDBusRegisterMetaType<QList<QByteArray>>();
+
+    // 合并的时间窗口可以通过环境变量调整(ms)
+    bool ok = false;
+    const int debounce = qEnvironmentVariableIntValue("DDE_CLIPBOARD_CAPTURE_DEBOUNCE", &ok);
+    if (ok)
+        m_scheduler->setDebounce(debounce);
+    const int maxLatency = qEnvironmentVariableIntValue("DDE_CLIPBOARD_CAPTURE_MAX_LATENCY", &ok);
+    if (ok)
+        m_scheduler->setMaxLatency(maxLatency);
+    connect(m_scheduler, &CaptureScheduler::triggered, this, &ClipboardLoader::doWork);
+
+    connect(m_pipeline, &CapturePipeline::resultReady, this, &ClipboardLoader::onCaptured);
+    connect(m_store, &HistoryStore::filesReleased, this, [](const QStringList &files) {
+        blobStore().release(files);
+    });
+    // 保留的数量和空间(MB)可以通过环境变量调整，0表示不限制
+    int maxItems = qEnvironmentVariableIntValue("DDE_CLIPBOARD_HISTORY_MAX_ITEMS", &ok);
+    if (!ok)
+        maxItems = MaxHistoryItems;
+    const int maxMBytes = qEnvironmentVariableIntValue("DDE_CLIPBOARD_HISTORY_MAX_MB", &ok);
+    m_store->setRetention(maxItems, ok ? qint64(maxMBytes) * 1024 * 1024 : MaxHistoryBytes);
+    m_store->open();
+
+    m_backend->setParent(this);
+    connect(m_backend, &ClipboardBackend::dataChanged, this, [this] {
+        // 剪贴板内容变化后，之前的数据中还没有读取的格式已经无法获取
+        ++m_changeSerial;
+        m_fetcher->cancel();
+        m_scheduler->post(m_backend->protocolType());
+    });
+    connect(m_fetcher, &DeferredFormatFetcher::finished, this, &ClipboardLoader::onDeferredFetched);
+
+    // 历史记录已经持久化，启动时不再清空图片缓存，只清理没有被历史记录引用的文件
+    const QDateTime startTime = QDateTime::currentDateTime();
+    QTimer::singleShot(0, this, [this, startTime] {
+        // 上限可能被调小了
+        trimHistory();
+        sweepPixCache(startTime);
+    });
 }
 
 void ClipboardLoader::dataReborned(const QByteArray &buf)
@@ -139,85 +468,131 @@ void ClipboardLoader::dataReborned(const QByteArray &buf)
     // 当剪切板列表首条数据删除后，系统剪切板需要清除上次保存的格式，避免再次复制被过滤掉
     if (buf == CleanLastData) {
         m_clearLastData = true;
-        m_lastFormatMap.clear();
+        m_lastFormatHashes.clear();
         return;
     }
 
+    // 不解析其中的缓存文件引用，只使用传入的数据
     ItemInfo info;
     info.m_variantImage = 0;
-    info = Buf2Info(buf);
+    info = ItemCodec::decode(buf);
 
-    QMimeData *mimeData = new QMimeData;
-    QMapIterator<QString, QByteArray> it(info.m_formatMap);
-    while (it.hasNext()) {
-        it.next();
-        mimeData->setData(it.key(), it.value());
-    }
+    QMimeData *mimeData = createMimeData(info);
+    ++m_changeSerial;
+    m_fetcher->cancel();
+    m_backend->setMimeData(mimeData);
+}
 
-    switch (info.m_type) {
-    case DataType::Image:
-        setImageData(info, mimeData);
-        break;
-    default:
-        break;
+void ClipboardLoader::RebornItem(qulonglong id)
+{
+    // 直接使用历史记录中的数据，较大的格式保留对缓存文件的引用，粘贴时从文件发送，不需要经过界面读入内存
+    const QByteArray payload = m_store->payload(id);
+    if (payload.isEmpty()) {
+        if (calledFromDBus())
+            sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("item %1 is not available").arg(id));
+        return;
     }
 
-    if (m_board) {
-        m_board->setMimeData(mimeData);
-    } else if (m_wlrClipboard) {
-        m_wlrClipboard->setMimeData(mimeData);
-    } else {
-        Q_UNREACHABLE(); // Suppress memory leak warning
-    }
+    // 在历史记录中置顶，重新采集到的数据按指纹去重到同一条记录
+    m_store->touch(id, QDateTime::currentMSecsSinceEpoch());
+
+    QMimeData *mimeData = createMimeData(ItemCodec::decode(payload, ItemCodec::BlobFiles));
+    ++m_changeSerial;
+    m_fetcher->cancel();
+    m_backend->setMimeData(mimeData);
 }
 
-void ClipboardLoader::extracted(const QMimeData *&mimeData, bool &dataChanged)
+void ClipboardLoader::RemoveItem(qulonglong id)
 {
-    for (auto f : mimeData->formats()) {
-        // 跳过需要忽略的格式（系统格式和不需要的图片格式）
-        if (shouldIgnoreSaveTarget(f))
-            continue;
+    m_store->remove(id);
+}
 
-        // 需要先判断历史数据中是否存在此格式，否则使用m_lastFormatMap[f]时会返回默认空数据
-        if (!m_lastFormatMap.contains(f)) {
-            dataChanged = true;
-            break;
-        }
+void ClipboardLoader::ClearItems()
+{
+    m_store->clear();
+}
 
-        // application/x-qt-image格式数据保存的为QPixmap对象，不能直接转换成QByteArray进行比对
-        QByteArray data;
-        if (f == ApplicationXQtImageLiteral) {
-            const QPixmap &srcPix = qvariant_cast<QPixmap>(mimeData->imageData());
-            if (!srcPix.isNull()) {
-                QBuffer buffer(&data);
-                buffer.open(QIODevice::WriteOnly);
-                srcPix.save(&buffer, "PNG");
-            }
-        } else {
-            data = mimeData->data(f);
-        }
+QDBusVariant ClipboardLoader::FetchItem(qulonglong id, const QStringList &formats)
+{
+    const QByteArray payload = m_store->payload(id);
+    if (payload.isEmpty()) {
+        if (calledFromDBus())
+            sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("item %1 is not available").arg(id));
+        return QDBusVariant();
+    }
 
-        // 先比对两次复制数据的大小后再比对具体内容
-        if (m_lastFormatMap[f].size() != data.size()) {
-            if (f == ApplicationXQtImageLiteral && data.size() == 0) {
-                // qt 转换的数据可能没准备好, 防止刷数据。
-                continue;
-            }
-            dataChanged = true;
-            break;
-        }
+    // 重复复制时只更新了历史记录中的时间
+    const qint64 time = m_store->entry(id).time;
+    if (!calledFromDBus())
+        return PayloadTransport::pack(loadItem(payload, time, formats));
+
+    // 读取缓存文件和写入memfd在线程池中完成，完成后再回复，期间不阻塞剪贴板的采集
+    setDelayedReply(true);
+    const QDBusMessage request = message();
+    QDBusConnection bus = connection();
+    auto watcher = new QFutureWatcher<QDBusVariant>(this);
+    connect(watcher, &QFutureWatcher<QDBusVariant>::finished, this, [watcher, request, bus, id]() mutable {
+        watcher->deleteLater();
+        // 完整数据可能很大，较大的数据通过memfd传递
+        const QDBusVariant packed = watcher->result();
+        bus.send(packed.variant().isValid() ? request.createReply(QVariant::fromValue(packed))
+                                            : request.createErrorReply(QDBusError::Failed, QStringLiteral("item %1 is not available").arg(id)));
+    });
+    watcher->setFuture(QtConcurrent::run([payload, time, formats] {
+        return PayloadTransport::pack(loadItem(payload, time, formats));
+    }));
+    return QDBusVariant();
+}
 
-        if (m_lastFormatMap[f] != data) {
-            dataChanged = true;
-            break;
-        }
-    }
+QList<QByteArray> ClipboardLoader::ListItemsBefore(qlonglong time, qulonglong id, int count,
+                                                   qlonglong &cursorTime, qulonglong &cursorId, bool &hasMore)
+{
+    // 只读取请求的这一页数据，界面启动耗时与历史记录的数量无关。多取一条判断是否还有更早的记录
+    count = qBound(0, count, MaxListCount);
+    QList<quint64> ids = m_store->idsBefore(time, id, count + 1);
+    hasMore = ids.size() > count;
+    ids = ids.mid(0, count);
+
+    // 游标取本页最后一条记录，即使其预览数据读取失败也不会重复获取
+    const HistoryStore::Entry last = ids.isEmpty() ? HistoryStore::Entry() : m_store->entry(ids.last());
+    cursorTime = last.time;
+    cursorId = last.id;
+    return loadPreviews(ids);
+}
+
+QList<QByteArray> ClipboardLoader::ListItemsSince(qulonglong id)
+{
+    return loadPreviews(m_store->idsSince(id).mid(0, MaxListCount));
+}
+
+QVariantMap ClipboardLoader::GetStats()
+{
+    QVariantMap events;
+    events.insert(QStringLiteral("received"), m_scheduler->receivedCount());
+    events.insert(QStringLiteral("suppressed"), m_scheduler->suppressedCount());
+    events.insert(QStringLiteral("triggered"), m_scheduler->triggeredCount());
+
+    QVariantMap stats = CaptureStats::instance().toVariantMap();
+    stats.insert(QStringLiteral("events"), events);
+    // wayland下由daemon发送粘贴数据
+    const QVariantMap paste = m_backend->pasteStats();
+    if (!paste.isEmpty())
+        stats.insert(QStringLiteral("paste"), paste);
+    return stats;
+}
+
+void ClipboardLoader::ResetStats()
+{
+    CaptureStats::instance().reset();
+    m_scheduler->resetCounters();
+    m_backend->resetPasteStats();
 }
 
 void ClipboardLoader::doWork(int protocolType)
 {
-    ItemInfo info;
-    info.m_variantImage = 0;
+    QElapsedTimer captureTimer;
+    captureTimer.start();
+
     const bool clearLastData = m_clearLastData;
     m_clearLastData = false;
 
@@ -225,25 +600,18 @@ void ClipboardLoader::doWork(int protocolType)
     // The pointer returned might become invalidated when the contents
     // of the clipboard changes; either by calling one of the setter functions
     // or externally by the system clipboard changing.
-    const QMimeData *mimeData = protocolType == WAYLAND_PROTOCOL ? m_wlrClipboard->mimeData() : m_board->mimeData();
+    const QMimeData *mimeData = m_backend->mimeData();
     if (!mimeData || mimeData->formats().isEmpty())
         return;
 
-    static qint64 lastOfferTime = 0;
+    // 连续的变化已经由m_scheduler合并，这里不再按时间间隔丢弃数据
     auto curFormats = mimeData->formats();
-    auto lastFormats = m_lastFormatMap.keys();
+    auto lastFormats = m_lastFormatHashes.keys();
     curFormats.sort();
     lastFormats.sort();
     bool listEqual = curFormats == lastFormats;
-    auto offerDuration = QDateTime::currentMSecsSinceEpoch() - lastOfferTime;
-    // 两次offer的时间间隔小于500ms，且list相同，不处理
-    if (offerDuration < 500 &&
-            listEqual &&
-            !mimeData->formats().contains(ApplicationXQtImageLiteral)) {
-        lastOfferTime = QDateTime::currentMSecsSinceEpoch();
-        return;
-    }
-    lastOfferTime = QDateTime::currentMSecsSinceEpoch();
+    const bool recentCapture = m_lastCapture.isValid() && m_lastCapture.elapsed() < RepeatImageInterval;
+    m_lastCapture.start();
 
     // 适配厂商云桌面粘贴问题
     if (mimeData->formats().contains("uos/remote-copy")) {
@@ -251,6 +619,12 @@ void ClipboardLoader::doWork(int protocolType)
         return;
     }
 
+    // 密码管理器复制的密码不显示也不保存
+    if (MimePolicy::isConcealed(mimeData)) {
+        qDebug() << "concealed data from password manager";
+        return;
+    }
+
     // 转移系统剪贴板所有权时造成的两次内容变化不需要显示，以下为与系统约定好的标识
     if (mimeData->data("FROM_DEEPIN_CLIPBOARD_MANAGER") == "1") {
         qDebug() << "FROM_DEEPIN_CLIPBOARD_MANAGER";
@@ -267,207 +641,286 @@ void ClipboardLoader::doWork(int protocolType)
         return;
     }
 
+    CaptureSnapshot snapshot;
+    snapshot.itemId = m_store->allocateId();
+    snapshot.serial = m_changeSerial;
+    snapshot.protocolType = protocolType;
+    snapshot.timeStamp = currTimeStamp;
+    snapshot.lastFormatHashes = m_lastFormatHashes;
+    snapshot.lastImageHash = m_lastImageHash;
+
     // 对比上次粘贴的数据，如果一样就不再粘贴
-    bool dataChanged = false;
     if (listEqual || clearLastData) {
-        extracted(mimeData, dataChanged);
+        snapshot.compareWithLast = true;
     } else {
         // 对应场景，剪贴板双击复制置顶项后，再手动复制一样的内容，也需要判断是否是一样的数据
         // currentIsNormalData对应手动复制的内容，lastIsDoubleClickData对应上一次双击复制后的数据
         // 双击复制后返回的数据没有MULTIPLE和SAVE_TARGETS，以此区分
         bool currentIsNormalData = curFormats.contains("MULTIPLE") && curFormats.contains("SAVE_TARGETS");
         bool lastIsDoubleClickData = !lastFormats.isEmpty() && !lastFormats.contains("MULTIPLE") && !lastFormats.contains("SAVE_TARGETS");
-        if (currentIsNormalData && lastIsDoubleClickData) {
-            extracted(mimeData, dataChanged);
-        } else {
-            dataChanged = true;
-        }
-    }
-    if (!dataChanged) {
-        qDebug() << "Data is same, do not paste";
-        return;
+        snapshot.compareWithLast = currentIsNormalData && lastIsDoubleClickData;
     }
 
-    m_lastFormatMap.clear();
-    for (const auto &format : mimeData->formats()) {
-        // 对于需要忽略的格式，只记录格式名，不保存实际数据
-        if (shouldIgnoreSaveTarget(format)) {
-            m_lastFormatMap.insert(format, QByteArray());
-            continue;
-        }
+    // 正常数据时间戳不为空，这里增加判断限制 时间戳为空+图片内容不变 重复数据不展示
+    // wayland下时间戳可能为空
+    // 消除两次间隔小于500ms的重复图片数据
+    const bool isWayland = protocolType == WAYLAND_PROTOCOL;
+    snapshot.checkRepeatImage = (currTimeStamp.isEmpty() || recentCapture) && !isWayland;
+    snapshot.checkRepeatEncodedImage = currTimeStamp.isEmpty() && !isWayland;
+
+    CaptureStats::instance().record(CaptureStats::MimeFilter, captureTimer.nsecsElapsed());
+    snapshot.started = captureTimer;
+    takeSnapshot(mimeData, snapshot);
+    m_pipeline->submit(std::move(snapshot));
+}
 
-        QByteArray data;
-        // application/x-qt-image格式需要特殊处理：从QPixmap转换为PNG格式的QByteArray
-        if (format == ApplicationXQtImageLiteral) {
-            const QPixmap &srcPix = qvariant_cast<QPixmap>(mimeData->imageData());
-            if (!srcPix.isNull()) {
-                QBuffer buffer(&data);
-                buffer.open(QIODevice::WriteOnly);
-                srcPix.save(&buffer, "PNG");
-            }
-        } else {
-            data = mimeData->data(format);
-        }
+void ClipboardLoader::takeSnapshot(const QMimeData *mimeData, CaptureSnapshot &snapshot)
+{
+    // GUI线程上只读取原始数据，解码、计算指纹、缩放和序列化都放到工作线程中
+    // 只立即读取生成预览和指纹需要的格式，其他格式在保存后再在后台读取
+    snapshot.formats = mimeData->formats();
+    const QStringList eagerFormats = MimePolicy::eagerFormats(snapshot.formats);
+    for (const auto &format : eagerFormats) {
+        // 对于需要忽略的格式，只记录格式名，不读取实际数据
+        // application/x-qt-image格式保存的为图片对象，在下面单独处理
+        if (shouldIgnoreSaveTarget(format) || format == ApplicationXQtImageLiteral)
+            continue;
 
-        m_lastFormatMap.insert(format, data);
+        snapshot.formatData.insert(format, readFormat(mimeData, format, m_backend, snapshot));
     }
 
-    bool hasImage = false;
-    QString imageFormat;
-    auto supportedFormats = QImageWriter::supportedImageFormats();
-    foreach (auto supportedFormat, supportedFormats) {
-        imageFormat = "image/" + supportedFormat;
-        if (mimeData->formats().contains(imageFormat)) {
-            hasImage = true;
-            break;
+    snapshot.imageFormat = MimePolicy::imageFormat(snapshot.formats);
+
+    //图片类型的数据直接吧数据拿出来，不去调用mimeData->data()方法，会导致很卡
+    // 图片类型只保存图片，不需要读取其他格式
+    snapshot.hasImage = mimeData->hasImage();
+    if (snapshot.hasImage) {
+        // 优先拿编码后的图片数据，避免在GUI线程中解码，进程内设置的图片没有编码数据，直接取图片对象
+        snapshot.encodedImage = encodedImageData(mimeData, m_backend, snapshot, snapshot.encodedImageFormat);
+        if (snapshot.encodedImage.isEmpty()) {
+            StageTimer span(CaptureStats::FormatRead);
+            snapshot.image = qvariant_cast<QImage>(mimeData->imageData());
+            CaptureStats::instance().addFormatBytes(ApplicationXQtImageLiteral, snapshot.image.sizeInBytes());
         }
+        return;
     }
 
-    if (mimeData->formats().contains(PngImageLiteral)) {
-        hasImage = true;
-        imageFormat = PngImageLiteral;
+    // 部分情况下，应用(目前有截图录屏)发送的图片只有一种格式，例如image/png
+    if (!snapshot.imageFormat.isEmpty()) {
+        snapshot.encodedImage = snapshot.formatData.contains(snapshot.imageFormat) ? snapshot.formatData.value(snapshot.imageFormat)
+                                                                                   : readFormat(mimeData, snapshot.imageFormat, m_backend, snapshot);
+        snapshot.encodedImageFormat = snapshot.imageFormat;
+        return;
     }
 
-    //图片类型的数据直接吧数据拿出来，不去调用mimeData->data()方法，会导致很卡
-    if (mimeData->hasImage()) {
-        const auto &srcImage = qvariant_cast<QImage>(mimeData->imageData()) ;
-        if (srcImage.isNull()) {
-            qDebug() << "mimeData->imageData()" << mimeData->imageData() << "QImage is null.";
-            return;
-        }
+    // 后端还在后台读取的格式也需要延后获取
+    const QStringList pendingFormats = m_backend->pendingFormats();
+    snapshot.hasUrls = mimeData->hasUrls();
+    if (snapshot.hasUrls) {
+        snapshot.urls = mimeData->urls();
+        //文件类型吧整个formats信息都拿出来，里面包含了文件的图标，以及文件的url数据等。
+        for (const QString &format : snapshot.formats) {
+            if (snapshot.formatData.contains(format) || format == ApplicationXQtImageLiteral)
+                continue;
 
-        info.m_pixSize = srcImage.size();
-        if (!cachePixmap(srcImage, info)) {
-            info.m_variantImage = srcImage;
+            if (eagerFormats.contains(format))
+                snapshot.extraData.insert(format, readFormat(mimeData, format, m_backend, snapshot));
+            else
+                snapshot.deferredFormats.append(format);
+        }
+        for (const QString &format : pendingFormats) {
+            if (!snapshot.formats.contains(format))
+                snapshot.deferredFormats.append(format);
         }
+        return;
+    }
 
-        info.m_formatMap.insert(ApplicationXQtImageLiteral, info.m_variantImage.toByteArray());
-        info.m_formatMap.insert("TIMESTAMP", currTimeStamp);
-        if (info.m_variantImage.isNull())
-            return;
+    for (const QString &format : snapshot.formats + pendingFormats) {
+        if (!shouldIgnoreSaveTarget(format) && format != ApplicationXQtImageLiteral
+                && !snapshot.formatData.contains(format) && !snapshot.deferredFormats.contains(format))
+            snapshot.deferredFormats.append(format);
+    }
 
-        // 正常数据时间戳不为空，这里增加判断限制 时间戳为空+图片内容不变 重复数据不展示
-        // wayland下时间戳可能为空
-        // 消除两次间隔小于500ms的重复图片数据
-        if((currTimeStamp.isEmpty() || offerDuration < 500) && srcImage == m_lastImage && (QStringLiteral("wayland") != qGuiApp->platformName())) {
-            qDebug() << "system repeat image";
-            return;
-        }
-        m_lastImage = srcImage;
+    // 保存在文件中的文本在工作线程中解码，mimeData->text()会在GUI线程中重新读取整个文件
+    snapshot.hasText = mimeData->hasText();
+    if (snapshot.hasText) {
+        if (!snapshot.spooledData.contains(TextPlainLiteral))
+            snapshot.text = mimeData->text();
+    } else {
+        snapshot.hasHtml = mimeData->hasHtml();
+        if (snapshot.hasHtml && !snapshot.spooledData.contains(TextHtmlLiteral))
+            snapshot.html = mimeData->html();
+    }
+}
 
-        info.m_hasImage = true;
-        info.m_type = Image;
-    } else if (hasImage) {
-        // 部分情况下，应用(目前有截图录屏)发送的图片只有一种格式，例如image/png
-        QPixmap srcPix;
-        srcPix.loadFromData(mimeData->data(imageFormat));
-        if (srcPix.isNull())
-            return;
+void ClipboardLoader::onCaptured(const CaptureResult &result)
+{
+    // 生成快照之后，之前的采集结果可能才被接收，上次数据以接收结果时为准重新比对
+    const bool sameData = result.dataChanged && result.compareWithLast && !formatsChanged(result.formatHashes, m_lastFormatHashes);
+    const bool repeatImage = result.imageHashChanged && result.checkRepeatImage && result.imageHash == m_lastImageHash;
+    if (sameData || repeatImage) {
+        qDebug() << "Data is same as the last accepted data, ignored";
+        blobStore().release(result.files);
+        return;
+    }
 
-        info.m_pixSize = srcPix.size();
-        if (!cachePixmap(srcPix.toImage(), info)) {
-            info.m_variantImage = srcPix.toImage();
-        }
+    if (result.dataChanged)
+        m_lastFormatHashes = result.formatHashes;
 
-        info.m_formatMap.insert(imageFormat, info.m_variantImage.toByteArray());
-        info.m_formatMap.insert("TIMESTAMP", currTimeStamp);
-        if (info.m_variantImage.isNull())
-            return;
+    if (result.imageHashChanged)
+        m_lastImageHash = result.imageHash;
 
-        // 正常数据时间戳不为空，这里增加判断限制 时间戳为空+图片内容不变 重复数据不展示
-        // wayland下时间戳可能为空
-        if(currTimeStamp.isEmpty() && srcPix.toImage() == m_lastImage && (QStringLiteral("wayland") != qGuiApp->platformName())) {
-            qDebug() << "Current image from data is same as the last image, ignored";
-            return;
-        }
-        m_lastImage = srcPix.toImage();
+    if (result.storeBuf.isEmpty())
+        return;
 
-        info.m_hasImage = true;
-        info.m_type = Image;
-        info.m_createTime = QDateTime::currentDateTime();
-        info.m_enable = true;
+    m_lastTimeStamp = result.timeStamp;
+
+    QElapsedTimer storeTimer;
+    storeTimer.start();
+
+    // 已经保存过相同的内容时只更新复制时间，释放本次采集对缓存文件的引用
+    QByteArray preview = result.preview;
+    const quint64 existsId = m_store->findByHash(result.itemHash);
+    if (existsId != 0) {
+        m_store->touch(existsId, result.createTime);
+        blobStore().release(result.files);
+        preview = loadPreview(existsId);
+    } else if (!m_store->append(result.itemId, result.itemHash, result.itemType, result.createTime, result.storeBuf, result.files)) {
+        // 界面需要时通过FetchItem获取完整数据，没有保存成功的数据不再通知界面
+        qWarning() << "save clipboard item failed, id:" << result.itemId;
+        blobStore().release(result.files);
+        return;
+    }
+    CaptureStats::instance().record(CaptureStats::Store, storeTimer.nsecsElapsed());
+    trimHistory();
 
-        m_lastTimeStamp = currTimeStamp;
-    } else if (mimeData->hasUrls()) {
-        info.m_urls = mimeData->urls();
-        if (info.m_urls.isEmpty())
-            return;
+    {
+        StageTimer span(CaptureStats::Emit);
+        Q_EMIT itemAdded(preview);
+    }
+    CaptureStats::instance().record(CaptureStats::Total, result.started.nsecsElapsed());
+
+    // 新保存的数据在后台补充其他格式，剪贴板已经变化时无法再获取
+    if (existsId == 0 && !result.deferredFormats.isEmpty()) {
+        if (result.serial == m_changeSerial)
+            m_fetcher->start(result.itemId, result.deferredFormats);
+        else
+            qDebug() << "clipboard changed, deferred formats are not read, id:" << result.itemId;
+    }
+}
 
-        //文件类型吧整个formats信息都拿出来，里面包含了文件的图标，以及文件的url数据等。
-        for (const QString &format : mimeData->formats()) {
-            const QByteArray &data = mimeData->data(format);
-            if (!data.isEmpty())
-                info.m_formatMap.insert(format, data);
-        }
-        if (info.m_formatMap.isEmpty())
-            return;
+void ClipboardLoader::onDeferredFetched(quint64 id, const QMap<QString, QByteArray> &formatData,
+                                        const QMap<QString, QDBusUnixFileDescriptor> &spooledFiles)
+{
+    if (!m_store->contains(id) || (formatData.isEmpty() && spooledFiles.isEmpty()))
+        return;
 
-        info.m_type = File;
-    } else {
-        if (mimeData->hasText()) {
-            info.m_text = mimeData->text();
-            // X11下，按住ctrl+c不放会出现hasText但是text/plain格式为空的情况，这里特殊处理一下
-            if (info.m_text.isEmpty() && protocolType != WAYLAND_PROTOCOL)
-                info.m_text = m_lastFormatMap.value("text/plain");
-        } else if (mimeData->hasHtml()) {
-            info.m_text = mimeData->html();
-        } else {
+    // 延后的格式不在已保存的数据中，只编码新增的格式追加到记录后面，原有的数据不重新解码和写入。
+    // 写入缓存文件在线程池中完成
+    using Fragment = QPair<QByteArray, QStringList>;
+    auto watcher = new QFutureWatcher<Fragment>(this);
+    connect(watcher, &QFutureWatcher<Fragment>::finished, this, [this, watcher, id] {
+        watcher->deleteLater();
+        const Fragment fragment = watcher->result();
+        if (!m_store->extend(id, fragment.first, fragment.second)) {
+            qWarning() << "save deferred formats failed, id:" << id;
+            blobStore().release(fragment.second);
             return;
         }
+        trimHistory();
+    });
+    watcher->setFuture(QtConcurrent::run([formatData, spooledFiles] {
+        ItemInfo info;
+        info.m_formatMap = formatData;
+
+        // 保存在文件中的格式直接从映射写入缓存文件，不复制到内存中，映射在编码完成后解除
+        std::vector<std::unique_ptr<PayloadTransport::MappedPayload>> mappings;
+        for (auto it = spooledFiles.cbegin(); it != spooledFiles.cend(); ++it) {
+            mappings.push_back(std::make_unique<PayloadTransport::MappedPayload>(it.value()));
+            if (mappings.back()->isValid())
+                info.m_formatMap.insert(it.key(), mappings.back()->data());
+        }
 
-        const QByteArray &textByteArray = info.m_text.toUtf8();
-        if (info.m_text.isEmpty() || textByteArray.size() > MAX_BETYARRAY_SIZE)
-            return;
+        QStringList files;
+        externalizeBlobs(info, files);
+        return Fragment(ItemCodec::encodeFormats(info.m_formatMap, info.m_blobFiles), files);
+    }));
+}
 
-        // 保存所有数据，确保正常粘贴,缺少任意一种格式都可能导致粘贴失败
-        for (auto f : mimeData->formats()) {
-            if ("text/plain" == f && protocolType != WAYLAND_PROTOCOL) {
-                info.m_formatMap.insert(f,  m_lastFormatMap.value("text/plain"));
-                continue;
-            }
-            // 跳过需要忽略的格式
-            if (shouldIgnoreSaveTarget(f))
-                continue;
+QByteArray ClipboardLoader::loadItem(const QByteArray &payload, qint64 time, const QStringList &formats)
+{
+    // 只读取需要的格式引用的缓存文件
+    ItemInfo info = ItemCodec::decode(payload, ItemCodec::BlobFiles, formats);
+    restoreBlobs(info);
+    info.m_createTime = QDateTime::fromMSecsSinceEpoch(time);
+    return ItemCodec::encode(info);
+}
 
-            info.m_formatMap.insert(f, mimeData->data(f));
-        }
+QByteArray ClipboardLoader::loadPreview(quint64 id)
+{
+    // 编码预览数据时会复制需要的内容，解码期间不读写历史记录，可以直接引用映射的数据
+    const QByteArray payload = m_store->payloadView(id);
+    if (payload.isEmpty())
+        return payload;
+
+    // 预览只需要文件图标，其他格式的数据不复制
+    ItemInfo info = ItemCodec::decode(payload, ItemCodec::ZeroCopy | ItemCodec::BlobFiles, {QStringLiteral("x-dfm-copied/file-icons")});
+    restoreBlobs(info);
+    info.m_id = id;
+    info.m_createTime = QDateTime::fromMSecsSinceEpoch(m_store->entry(id).time);
+    return ItemCodec::encodePreview(info);
+}
 
-        info.m_type = Text;
+QList<QByteArray> ClipboardLoader::loadPreviews(const QList<quint64> &ids)
+{
+    QList<QByteArray> list;
+    list.reserve(ids.size());
+    for (quint64 id : ids) {
+        const QByteArray preview = loadPreview(id);
+        if (preview.isEmpty()) {
+            qWarning() << "load clipboard item preview failed, skipped, id:" << id;
+            continue;
+        }
+        list.append(preview);
     }
+    return list;
+}
 
-    info.m_createTime = QDateTime::currentDateTime();
-    info.m_enable = true;
-
-    m_lastTimeStamp = currTimeStamp;
-
-    QByteArray buf;
-    buf = Info2Buf(info);
+void ClipboardLoader::trimHistory()
+{
+    const QList<quint64> removed = m_store->trim();
+    if (!removed.isEmpty())
+        qInfo() << "history exceeds the limit, removed oldest items:" << removed.size();
+}
 
-    Q_EMIT dataComing(buf);
+void ClipboardLoader::sweepPixCache(const QDateTime &before)
+{
+    // 根据历史记录建立缓存文件的引用计数，没有被引用的文件直接删除
+    if (initPixPath())
+        blobStore().sweep(m_store->referencedFiles(), before);
 }
 
-bool ClipboardLoader::cachePixmap(const QImage &srcPix, ItemInfo &info)
+bool ClipboardLoader::cachePixmap(const QImage &srcPix, ItemInfo &info, quint64 imageHash, const QByteArray &png)
 {
     if (initPixPath()) {
-        QString pixFileName = m_pixPath + QString("/%1.png").arg(QDateTime::currentMSecsSinceEpoch());
-        QImageWriter writer(pixFileName);
-        if (!writer.canWrite() || !writer.write(srcPix)) {
-            QFile cacheFile(pixFileName);
-            if (!cacheFile.open(QIODevice::WriteOnly)) {
-                qDebug() << "open file failed, file name:" << pixFileName;
-                return false;
-            }
-            QDataStream stream(&cacheFile);
-            stream.setVersion(QDataStream::Qt_5_11);
-            stream << srcPix;
-            cacheFile.close();
+        // 缓存文件以图片内容命名，相同的图片只编码、写入一次；来源提供了png数据时直接写入，不再编码
+        QString pixFileName;
+        {
+            StageTimer span(CaptureStats::CacheWrite);
+            const quint64 hash = imageHash ? imageHash : ContentHasher::hashImage(srcPix);
+            pixFileName = png.isEmpty() ? blobStore().putImage(hash, srcPix) : blobStore().put(hash, png, QStringLiteral(".png"));
         }
+        if (pixFileName.isEmpty())
+            return false;
 
-        info.m_variantImage = srcPix.width() * PixmapHeight > srcPix.height() * PixmapWidth ?
-                              srcPix.scaledToWidth(PixmapWidth, Qt::SmoothTransformation) :
-                              srcPix.scaledToHeight(PixmapHeight, Qt::SmoothTransformation);
+        {
+            StageTimer span(CaptureStats::ThumbnailScale);
+            info.m_variantImage = srcPix.width() * PixmapHeight > srcPix.height() * PixmapWidth ?
+                                  srcPix.scaledToWidth(PixmapWidth, Qt::SmoothTransformation) :
+                                  srcPix.scaledToHeight(PixmapHeight, Qt::SmoothTransformation);
+        }
 
-        // "text/uri-list":"file:///${XDG_CACHE_HOME}/deepin/dde-clipboard-daemon/clipboard-pix/xxx"
+        // "text/uri-list":"file:///${XDG_CACHE_HOME}/deepin/dde-clipboard-daemon/clipboard-pix/xx/xxxxxxxxxxxxxxxx.png"
         info.m_formatMap.insert(TextUriListLiteral, QUrl::fromLocalFile(pixFileName).toEncoded());
 
         info.m_urls.push_back(QUrl::fromLocalFile(pixFileName));
@@ -478,19 +931,27 @@ bool ClipboardLoader::cachePixmap(const QImage &srcPix, ItemInfo &info)
 
 bool ClipboardLoader::initPixPath()
 {
+    // 采集线程池中的多个任务可能同时调用
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
     if (!m_pixPath.isEmpty()) {
         return true;
     }
 
     QDir dir;
     m_pixPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + PixCacheDir;
+    // 缓存的是剪贴板的原始内容，只有所有者可以访问
+    const QFileDevice::Permissions permissions = QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner;
     if (dir.exists(m_pixPath)) {
         qDebug() << "dir exists:" << m_pixPath;
+        QFile::setPermissions(m_pixPath, permissions);
         return true;
     }
 
     if (dir.mkdir(m_pixPath)) {
         qDebug() << "mkdir:" << m_pixPath;
+        QFile::setPermissions(m_pixPath, permissions);
         return true;
     }
 
@@ -508,13 +969,53 @@ void ClipboardLoader::setImageData(const ItemInfo &info, QMimeData *&mimeData)
         return;
     }
 
-    const QString &fileName = info.m_urls.front().path();
-    QImage cachedImage(fileName);
-    if (cachedImage.isNull()) {
-        qDebug() << "QImage failed to read cached image file" << fileName;
+    // 只使用daemon自己的图片缓存文件，其他进程传入的数据可能指向任意文件
+    const QString fileName = QDir::cleanPath(info.m_urls.front().path());
+    if (!fileName.startsWith(blobStore().path() + QLatin1Char('/'))) {
+        qDebug() << "image file is not in cache directory:" << fileName;
         mimeData->setImageData(info.m_variantImage);
         return;
     }
 
-    mimeData->setImageData(cachedImage);
+    if (!QFileInfo::exists(fileName)) {
+        qDebug() << "cached image file not exists:" << fileName;
+        mimeData->setImageData(info.m_variantImage);
+        return;
+    }
+
+    // 粘贴时直接使用缓存文件和保存的原始编码数据，不再解码后重新编码
+    ImageMimeData *imageData = new ImageMimeData(fileName, &blobStore());
+    const BlobMimeData *blobData = qobject_cast<const BlobMimeData *>(mimeData);
+    for (const QString &format : mimeData->formats()) {
+        const QString file = blobData ? blobData->file(format) : QString();
+        if (file.isEmpty())
+            imageData->setData(format, mimeData->data(format));
+        else
+            imageData->setFile(format, file);
+    }
+    delete mimeData;
+    mimeData = imageData;
+}
+
+QMimeData *ClipboardLoader::createMimeData(const ItemInfo &info)
+{
+    // 单独保存的格式只记录文件，使用时再读取；数据存在期间持有缓存文件的引用，删除历史记录后仍然可以粘贴
+    BlobMimeData *blobData = new BlobMimeData(&blobStore());
+    for (auto it = info.m_formatMap.cbegin(); it != info.m_formatMap.cend(); ++it) {
+        const QString file = info.m_blobFiles.value(it.key());
+        if (file.isEmpty())
+            blobData->setData(it.key(), it.value());
+        else
+            blobData->setFile(it.key(), file);
+    }
+
+    QMimeData *mimeData = blobData;
+    switch (info.m_type) {
+    case DataType::Image:
+        setImageData(info, mimeData);
+        break;
+    default:
+        break;
+    }
+    return mimeData;
 }
@@ -6,10 +6,15 @@
 #define CLIPBOARDLOADER_H
 
 #include "constants.h"
-#include "wlrintegration/wlrdatacontrolclipboardinterface.h"
+#include "clipboardbackend.h"
 #include "iteminfo.h"
+#include "capturepipeline.h"
+#include "capturescheduler.h"
+#include "historystore.h"
+#include "deferredformatfetcher.h"
 
 #include <QObject>
+#include <QDBusContext>
 #include <QClipboard>
 #include <QDBusMetaType>
 #include <QIcon>
@@ -17,43 +22,83 @@
 #include <QList>
 #include <QDebug>
 #include <QDBusArgument>
+#include <QDBusUnixFileDescriptor>
+#include <QDBusVariant>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QUrl>
 
-class ClipboardLoader : public QObject
+class ClipboardLoader : public QObject, protected QDBusContext
 {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.ClipboardLoader1")
 
 public:
     explicit ClipboardLoader(QObject *parent = nullptr);
+    /*!
+     * \~chinese \brief 使用指定的剪贴板后端，接管backend的所有权
+     */
+    explicit ClipboardLoader(ClipboardBackend *backend, QObject *parent = nullptr);
 
-    bool cachePixmap(const QImage &srcPix, ItemInfo &info);
+    static bool cachePixmap(const QImage &srcPix, ItemInfo &info, quint64 imageHash = 0, const QByteArray &png = QByteArray());
     void setImageData(const ItemInfo &info, QMimeData *&mimeData);
+    QMimeData *createMimeData(const ItemInfo &info);
 
     static bool initPixPath();
 
 public Q_SLOTS:
     void dataReborned(const QByteArray &buf);
+    void RebornItem(qulonglong id);
+    void RemoveItem(qulonglong id);
+    void ClearItems();
+    /*!
+     * \~chinese \brief 获取记录的完整数据，较小的数据直接作为ay回复，较大的数据通过memfd回复，见PayloadTransport::pack
+     */
+    QDBusVariant FetchItem(qulonglong id, const QStringList &formats);
+    /*!
+     * \~chinese \brief 按页获取复制时间早于(time, id)的记录的预览数据，id为0时从最新的开始。
+     * \~chinese cursorTime、cursorId返回本页最后一条记录，作为下一页的游标，hasMore表示是否还有更早的记录
+     */
+    QList<QByteArray> ListItemsBefore(qlonglong time, qulonglong id, int count,
+                                      qlonglong &cursorTime, qulonglong &cursorId, bool &hasMore);
+    QList<QByteArray> ListItemsSince(qulonglong id);
+    QVariantMap GetStats();
+    void ResetStats();
 
 private Q_SLOTS:
     void doWork(int protocolType);
+    void onCaptured(const CaptureResult &result);
+    void onDeferredFetched(quint64 id, const QMap<QString, QByteArray> &formatData,
+                           const QMap<QString, QDBusUnixFileDescriptor> &spooledFiles);
 
 Q_SIGNALS:
-    void dataComing(const QByteArray &buf);
+    void itemAdded(const QByteArray &preview);
 
 private:
-    void extracted(const QMimeData *&mimeData, bool &dataChanged);
+    void takeSnapshot(const QMimeData *mimeData, CaptureSnapshot &snapshot);
+    void sweepPixCache(const QDateTime &before);
+    void trimHistory();                             // 删除超过保留上限的旧记录
+    /*!
+     * \~chinese \brief 还原历史记录中的完整数据，会读取缓存文件，可以在工作线程中调用
+     */
+    static QByteArray loadItem(const QByteArray &payload, qint64 time, const QStringList &formats = QStringList());
+    QByteArray loadPreview(quint64 id);
+    QList<QByteArray> loadPreviews(const QList<quint64> &ids);
 
 private:
-    QClipboard *m_board;
+    ClipboardBackend *m_backend;                    // 系统剪贴板
     QByteArray m_lastTimeStamp;
-    QImage m_lastImage;
-    WlrDataControlClipboardInterface *m_wlrClipboard;
+    quint64 m_lastImageHash = 0;                    // 上次图片像素数据的指纹
+    CaptureScheduler *m_scheduler;                  // 合并连续的剪贴板变化事件
+    CapturePipeline *m_pipeline;                    // 数据采集流水线，耗时操作都在工作线程中完成
+    DeferredFormatFetcher *m_fetcher;               // 保存后在后台读取其他格式
+    quint64 m_changeSerial = 0;                     // 剪贴板变化的序号
+    QElapsedTimer m_lastCapture;                    // 上次采集的时间
+    HistoryStore *m_store;                          // 持久化的历史记录
 
     static QString m_pixPath;
 
-    QMap<QString, QByteArray> m_lastFormatMap;
+    QMap<QString, quint64> m_lastFormatHashes;     // 上次数据各格式的指纹
     bool m_clearLastData = false;
 };
 
@@ -46,6 +46,7 @@ static const QString ApplicationXQtImageLiteral QStringLiteral("application/x-qt
 typedef struct {
     QStringList cornerIconList;
     QIcon fileIcon;
+    QString iconPath;       // 图标来自文件时为文件路径，用于区分合成的图标
 } FileIconData;
 
 namespace  Globals {
@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "contenthash.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+// XXH64 算法常量
+static constexpr quint64 Prime1 = 11400714785074694791ULL;
+static constexpr quint64 Prime2 = 14029467366897019727ULL;
+static constexpr quint64 Prime3 = 1609587929392839161ULL;
+static constexpr quint64 Prime4 = 9650029242287828579ULL;
+static constexpr quint64 Prime5 = 2870177450012600261ULL;
+
+static inline quint64 rotl64(quint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline quint64 read64(const uchar *p)
+{
+    quint64 v;
+    memcpy(&v, p, sizeof(v));
+    return qFromLittleEndian(v);
+}
+
+static inline quint32 read32(const uchar *p)
+{
+    quint32 v;
+    memcpy(&v, p, sizeof(v));
+    return qFromLittleEndian(v);
+}
+
+static inline quint64 round64(quint64 acc, quint64 input)
+{
+    acc += input * Prime2;
+    acc = rotl64(acc, 31);
+    acc *= Prime1;
+    return acc;
+}
+
+static inline quint64 mergeRound64(quint64 acc, quint64 val)
+{
+    val = round64(0, val);
+    acc ^= val;
+    acc = acc * Prime1 + Prime4;
+    return acc;
+}
+
+ContentHasher::ContentHasher(quint64 seed)
+{
+    reset(seed);
+}
+
+void ContentHasher::reset(quint64 seed)
+{
+    m_seed = seed;
+    m_v[0] = seed + Prime1 + Prime2;
+    m_v[1] = seed + Prime2;
+    m_v[2] = seed;
+    m_v[3] = seed - Prime1;
+    m_totalLen = 0;
+    m_bufferSize = 0;
+}
+
+void ContentHasher::addData(const char *data, qsizetype len)
+{
+    if (!data || len <= 0)
+        return;
+
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    const uchar *const end = p + len;
+    m_totalLen += static_cast<quint64>(len);
+
+    // 先补齐上次剩余的不足32字节的数据
+    if (m_bufferSize + len < 32) {
+        memcpy(m_buffer + m_bufferSize, p, static_cast<size_t>(len));
+        m_bufferSize += static_cast<int>(len);
+        return;
+    }
+
+    if (m_bufferSize > 0) {
+        const int fill = 32 - m_bufferSize;
+        memcpy(m_buffer + m_bufferSize, p, static_cast<size_t>(fill));
+        m_v[0] = round64(m_v[0], read64(m_buffer));
+        m_v[1] = round64(m_v[1], read64(m_buffer + 8));
+        m_v[2] = round64(m_v[2], read64(m_buffer + 16));
+        m_v[3] = round64(m_v[3], read64(m_buffer + 24));
+        p += fill;
+        m_bufferSize = 0;
+    }
+
+    // 主循环，每次处理32字节，四条累加通道互不依赖，便于编译器展开和流水
+    if (end - p >= 32) {
+        quint64 v1 = m_v[0];
+        quint64 v2 = m_v[1];
+        quint64 v3 = m_v[2];
+        quint64 v4 = m_v[3];
+        const uchar *const limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        m_v[0] = v1;
+        m_v[1] = v2;
+        m_v[2] = v3;
+        m_v[3] = v4;
+    }
+
+    if (p < end) {
+        m_bufferSize = static_cast<int>(end - p);
+        memcpy(m_buffer, p, static_cast<size_t>(m_bufferSize));
+    }
+}
+
+void ContentHasher::addValue(quint64 value)
+{
+    const quint64 le = qToLittleEndian(value);
+    addData(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+void ContentHasher::addString(const QString &str)
+{
+    // 带上长度，避免 "ab"+"c" 与 "a"+"bc" 得到相同的结果
+    addValue(static_cast<quint64>(str.size()));
+    addData(reinterpret_cast<const char *>(str.constData()), str.size() * qsizetype(sizeof(QChar)));
+}
+
+quint64 ContentHasher::result() const
+{
+    quint64 h;
+    if (m_totalLen >= 32) {
+        h = rotl64(m_v[0], 1) + rotl64(m_v[1], 7) + rotl64(m_v[2], 12) + rotl64(m_v[3], 18);
+        h = mergeRound64(h, m_v[0]);
+        h = mergeRound64(h, m_v[1]);
+        h = mergeRound64(h, m_v[2]);
+        h = mergeRound64(h, m_v[3]);
+    } else {
+        h = m_seed + Prime5;
+    }
+
+    h += m_totalLen;
+
+    const uchar *p = m_buffer;
+    const uchar *const end = m_buffer + m_bufferSize;
+    while (p + 8 <= end) {
+        h ^= round64(0, read64(p));
+        h = rotl64(h, 27) * Prime1 + Prime4;
+        p += 8;
+    }
+
+    if (p + 4 <= end) {
+        h ^= static_cast<quint64>(read32(p)) * Prime1;
+        h = rotl64(h, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+
+    while (p < end) {
+        h ^= static_cast<quint64>(*p) * Prime5;
+        h = rotl64(h, 11) * Prime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+quint64 ContentHasher::hash(const char *data, qsizetype len, quint64 seed)
+{
+    ContentHasher hasher(seed);
+    hasher.addData(data, len);
+    return hasher.result();
+}
+
+quint64 ContentHasher::hashImage(const QImage &image)
+{
+    if (image.isNull())
+        return 0;
+
+    // 32位格式直接计算，其他格式统一转换，保证同一张图片以不同格式提供时得到相同的指纹
+    // RGB32 的 alpha 通道固定为 0xff，与不透明的 ARGB32 数据一致
+    QImage srcImage = image;
+    if (srcImage.format() != QImage::Format_RGB32 && srcImage.format() != QImage::Format_ARGB32)
+        srcImage = srcImage.convertToFormat(QImage::Format_ARGB32);
+
+    ContentHasher hasher;
+    hasher.addValue(static_cast<quint64>(srcImage.width()));
+    hasher.addValue(static_cast<quint64>(srcImage.height()));
+
+    // 行与行之间可能有对齐填充，只计算每行的有效像素
+    const qsizetype lineBytes = qsizetype(srcImage.width()) * 4;
+    if (srcImage.bytesPerLine() == lineBytes) {
+        hasher.addData(reinterpret_cast<const char *>(srcImage.constBits()), lineBytes * srcImage.height());
+    } else {
+        for (int y = 0; y < srcImage.height(); ++y)
+            hasher.addData(reinterpret_cast<const char *>(srcImage.constScanLine(y)), lineBytes);
+    }
+
+    return hasher.result();
+}
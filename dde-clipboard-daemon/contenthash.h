@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CONTENTHASH_H
+#define CONTENTHASH_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+#include <QImage>
+
+/*!
+ * \~chinese \class ContentHasher
+ * \~chinese \brief 流式内容指纹(XXH64)，用于剪贴板数据去重。
+ * \~chinese 每种格式的数据在采集时只计算一次指纹，之后的比对只比较64位的指纹，不再保留数据副本逐字节比较。
+ * \~chinese 图片直接对像素数据计算指纹，不需要先编码成PNG。
+ */
+class ContentHasher
+{
+public:
+    explicit ContentHasher(quint64 seed = 0);
+
+    void reset(quint64 seed = 0);
+    void addData(const char *data, qsizetype len);
+    void addData(const QByteArray &data) { addData(data.constData(), data.size()); }
+    void addValue(quint64 value);
+    void addString(const QString &str);
+
+    quint64 result() const;
+
+    static quint64 hash(const char *data, qsizetype len, quint64 seed = 0);
+    static quint64 hash(const QByteArray &data, quint64 seed = 0) { return hash(data.constData(), data.size(), seed); }
+    static quint64 hashImage(const QImage &image);
+
+private:
+    quint64 m_v[4];
+    quint64 m_totalLen;
+    uchar m_buffer[32];
+    int m_bufferSize;
+    quint64 m_seed;
+};
+
+#endif // CONTENTHASH_H
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "deferredformatfetcher.h"
+#include "clipboardbackend.h"
+#include "capturestats.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMimeData>
+
+// 每条记录在GUI线程中读取延后格式的总时间和总数据量上限
+const qint64 MaxReadTime = 500 * 1000 * 1000;      // 500ms
+const qint64 MaxReadBytes = 64 * 1024 * 1024;
+
+DeferredFormatFetcher::DeferredFormatFetcher(ClipboardBackend *backend, QObject *parent)
+    : QObject(parent)
+    , m_backend(backend)
+{
+    // 间隔为0，每次事件循环空闲时读取一种格式
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &DeferredFormatFetcher::step);
+
+    // 后端读取结束后继续
+    connect(m_backend, &ClipboardBackend::pendingFormatsFinished, this, [this] {
+        if (isRunning())
+            m_timer.start();
+    });
+}
+
+void DeferredFormatFetcher::start(quint64 itemId, const QStringList &formats)
+{
+    cancel();
+    if (formats.isEmpty())
+        return;
+
+    m_itemId = itemId;
+    m_formats = formats;
+    m_readTime = 0;
+    m_readBytes = 0;
+    m_timer.start();
+}
+
+void DeferredFormatFetcher::cancel()
+{
+    if (isRunning())
+        qDebug() << "clipboard changed, deferred formats are not read, id:" << m_itemId << "formats:" << m_formats;
+
+    m_timer.stop();
+    m_itemId = 0;
+    m_formats.clear();
+    m_formatData.clear();
+    m_spooledFiles.clear();
+}
+
+void DeferredFormatFetcher::step()
+{
+    const QMimeData *mimeData = m_backend->mimeData();
+    if (!mimeData) {
+        cancel();
+        return;
+    }
+
+    const QStringList pending = m_backend->pendingFormats();
+    for (auto it = m_formats.begin(); it != m_formats.end(); ++it) {
+        const QString format = *it;
+        if (pending.contains(format))
+            continue;
+
+        m_formats.erase(it);
+        // 后端没有读取到的格式直接跳过
+        if (!mimeData->hasFormat(format))
+            break;
+
+        // 保存在文件中的格式只传递文件，不在GUI线程中读取
+        const QDBusUnixFileDescriptor file = m_backend->spooledFile(format);
+        if (file.isValid()) {
+            m_spooledFiles.insert(format, file);
+            break;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        const QByteArray data = mimeData->data(format);
+        const qint64 elapsed = timer.nsecsElapsed();
+        CaptureStats::instance().record(CaptureStats::DeferredRead, elapsed);
+        CaptureStats::instance().addFormatBytes(format, data.size());
+        CaptureStats::instance().addFormatTime(format, elapsed);
+
+        if (!data.isEmpty())
+            m_formatData.insert(format, data);
+
+        // 超过上限后剩下的格式不再读取，已经读取的格式照常保存
+        m_readTime += elapsed;
+        m_readBytes += data.size();
+        if (m_readTime > MaxReadTime || m_readBytes > MaxReadBytes) {
+            qWarning() << "deferred formats read too long, skipped, id:" << m_itemId << "time(ms):" << m_readTime / 1000000
+                       << "bytes:" << m_readBytes << "formats:" << m_formats;
+            m_formats.clear();
+        }
+        break;
+    }
+
+    if (m_formats.isEmpty()) {
+        const quint64 itemId = m_itemId;
+        const QMap<QString, QByteArray> formatData = m_formatData;
+        const QMap<QString, QDBusUnixFileDescriptor> spooledFiles = m_spooledFiles;
+        m_itemId = 0;
+        m_formatData.clear();
+        m_spooledFiles.clear();
+        Q_EMIT finished(itemId, formatData, spooledFiles);
+        return;
+    }
+
+    // 剩下的格式都还在后台读取时，等待pendingFormatsFinished
+    for (const QString &format : std::as_const(m_formats)) {
+        if (!pending.contains(format)) {
+            m_timer.start();
+            return;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEFERREDFORMATFETCHER_H
+#define DEFERREDFORMATFETCHER_H
+
+#include <QObject>
+#include <QMap>
+#include <QStringList>
+#include <QTimer>
+#include <QDBusUnixFileDescriptor>
+
+class ClipboardBackend;
+
+/*!
+ * \~chinese \class DeferredFormatFetcher
+ * \~chinese \brief 在数据保存后读取延后的格式。
+ * \~chinese 每次事件循环只读取一种格式，不影响其他事件的处理；还在后台读取的格式等待后端读取结束后再获取。
+ * \~chinese 剪贴板内容变化后需要调用cancel，之后的数据不再属于这条记录。
+ * \~chinese X11下QMimeData只能在GUI线程中使用，读取时同步等待来源程序转换数据，单次读取最长会阻塞到Qt剪贴板的超时时间；
+ * \~chinese 因此每条记录在GUI线程中读取的总时间和总数据量都有上限，超过后剩下的格式不再读取。
+ * \~chinese 后端保存在文件中的格式(wayland)不在GUI线程中读取，不计入上限。
+ */
+class DeferredFormatFetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DeferredFormatFetcher(ClipboardBackend *backend, QObject *parent = nullptr);
+
+    void start(quint64 itemId, const QStringList &formats);
+    void cancel();
+    bool isRunning() const { return m_itemId != 0; }
+
+Q_SIGNALS:
+    /*!
+     * \~chinese \brief 读取结束，后端保存在文件中的格式不读入内存，以spooledFiles传递，由接收方在工作线程中读取
+     */
+    void finished(quint64 itemId, const QMap<QString, QByteArray> &formatData,
+                  const QMap<QString, QDBusUnixFileDescriptor> &spooledFiles);
+
+private:
+    void step();
+
+private:
+    ClipboardBackend *m_backend;
+    QTimer m_timer;
+    quint64 m_itemId = 0;
+    QStringList m_formats;                  // 还没有读取的格式
+    qint64 m_readTime = 0;                  // 已经在GUI线程中读取的时间(ns)
+    qint64 m_readBytes = 0;                 // 已经在GUI线程中读取的数据量
+    QMap<QString, QByteArray> m_formatData;
+    QMap<QString, QDBusUnixFileDescriptor> m_spooledFiles;
+};
+
+#endif // DEFERREDFORMATFETCHER_H
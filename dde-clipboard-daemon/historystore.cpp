@@ -0,0 +1,1032 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "historystore.h"
+#include "contenthash.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QDebug>
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#include <unistd.h>
+
+namespace {
+
+const quint32 RecordMagic = 0x48434244;                 // "DBCH"
+const quint32 IndexMagic = 0x58434244;                  // "DBCX"
+const quint32 IndexVersion = 1;
+const qint64 MaxSegmentSize = 64 * 1024 * 1024;         // 单个段文件的最大长度
+const qint64 CompactMinDeadBytes = 4 * 1024 * 1024;     // 无效数据超过该大小且多于有效数据时才压缩
+const int CompactInterval = 10 * 60 * 1000;             // 定期检查是否需要压缩
+
+// 历史记录中是剪贴板的原始内容，只有所有者可以访问
+const QFileDevice::Permissions DirPermissions = QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner;
+const QFileDevice::Permissions FilePermissions = QFileDevice::ReadOwner | QFileDevice::WriteOwner;
+
+enum Op : quint8 {
+    PutOp = 1,
+    TouchOp,
+    RemoveOp,
+    ClearOp,
+    ExtendOp,
+};
+
+enum EntryFlag : quint16 {
+    HasFilesFlag = 0x1,
+};
+
+// 段文件中的记录头，后面紧跟引用的文件列表和数据内容
+// 文件只在本机使用，直接按本机字节序写入
+struct RecordHeader {
+    quint32 magic;
+    quint8 op;
+    quint8 type;
+    quint16 flags;
+    quint64 id;
+    quint64 hash;
+    qint64 time;
+    quint32 filesLength;
+    quint32 payloadLength;
+    quint64 checksum;           // 记录头(不含本字段)、文件列表和数据内容的校验值
+};
+static_assert(sizeof(RecordHeader) == 48, "unexpected RecordHeader layout");
+
+struct IndexHeader {
+    quint32 magic;
+    quint32 version;
+    quint64 reserved;
+};
+static_assert(sizeof(IndexHeader) == 16, "unexpected IndexHeader layout");
+
+// 索引项，与段文件中的记录一一对应
+struct IndexEntry {
+    quint8 op;
+    quint8 type;
+    quint16 flags;
+    quint32 segment;
+    quint64 id;
+    quint64 hash;
+    qint64 time;
+    quint64 offset;
+    quint32 length;
+    quint32 checksum;           // 索引项(不含本字段)的校验值
+};
+static_assert(sizeof(IndexEntry) == 48, "unexpected IndexEntry layout");
+
+quint64 recordChecksum(const RecordHeader &header, const char *files, qsizetype filesLength,
+                       const char *payload, qsizetype payloadLength)
+{
+    ContentHasher hasher;
+    hasher.addData(reinterpret_cast<const char *>(&header), offsetof(RecordHeader, checksum));
+    hasher.addData(files, filesLength);
+    hasher.addData(payload, payloadLength);
+    return hasher.result();
+}
+
+quint32 indexChecksum(const IndexEntry &item)
+{
+    return static_cast<quint32>(ContentHasher::hash(reinterpret_cast<const char *>(&item), offsetof(IndexEntry, checksum)));
+}
+
+IndexEntry makeIndexEntry(quint8 op, const HistoryStore::Entry &entry)
+{
+    IndexEntry item;
+    memset(&item, 0, sizeof(item));
+    item.op = op;
+    item.type = static_cast<quint8>(entry.type);
+    item.flags = entry.hasFiles ? HasFilesFlag : 0;
+    item.segment = entry.segment;
+    item.id = entry.id;
+    item.hash = entry.hash;
+    item.time = entry.time;
+    item.offset = entry.offset;
+    item.length = entry.length;
+    item.checksum = indexChecksum(item);
+    return item;
+}
+
+QList<quint32> listSegments(const QString &path)
+{
+    QList<quint32> segments;
+    const QStringList names = QDir(path).entryList({QStringLiteral("segment-*.log")}, QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        bool ok = false;
+        const quint32 segment = name.mid(8, 8).toUInt(&ok);
+        if (ok)
+            segments.append(segment);
+    }
+    return segments;
+}
+
+} // namespace
+
+HistoryStore::HistoryStore(const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+    , m_compactTimer(new QTimer(this))
+{
+    m_compactTimer->setInterval(CompactInterval);
+    connect(m_compactTimer, &QTimer::timeout, this, [this] {
+        compact();
+    });
+}
+
+HistoryStore::~HistoryStore()
+{
+    unmapAll();
+}
+
+bool HistoryStore::open()
+{
+    if (!QDir().mkpath(m_path)) {
+        qWarning() << "mkpath failed:" << m_path;
+        return false;
+    }
+
+    // 之前的版本按默认的umask创建，打开时一并收紧
+    QFile::setPermissions(m_path, DirPermissions);
+    if (QFile::exists(indexPath()))
+        QFile::setPermissions(indexPath(), FilePermissions);
+    for (quint32 segment : listSegments(m_path))
+        QFile::setPermissions(segmentPath(segment), FilePermissions);
+    m_fileBytesLoaded = false;
+    m_fileBytes.clear();
+    m_totalFileBytes = 0;
+
+    quint32 lastSegment = 0;
+    quint64 lastEnd = 0;
+    if (!loadIndex(lastSegment, lastEnd)) {
+        // 索引文件丢失或者损坏，从段文件重建
+        qWarning() << "history index is invalid, rebuild from segments, path:" << m_path;
+        m_entries.clear();
+        m_extensions.clear();
+        m_hashIndex.clear();
+        m_order.clear();
+        m_liveBytes = 0;
+        m_deadBytes = 0;
+        lastSegment = 0;
+        lastEnd = 0;
+        if (!resetIndex())
+            return false;
+    }
+
+    // 补上写入段文件后、写入索引前进程退出而缺失的索引项
+    const QList<quint32> segments = listSegments(m_path);
+    for (quint32 segment : segments) {
+        if (segment < lastSegment)
+            continue;
+        if (!recoverSegment(segment, segment == lastSegment ? lastEnd : 0))
+            return false;
+    }
+
+    const quint32 active = segments.isEmpty() ? qMax<quint32>(lastSegment, 1) : qMax(segments.last(), lastSegment);
+    if (!openActiveSegment(active))
+        return false;
+
+    // 比所有有效记录都旧的段文件只剩下无效数据，压缩后异常退出时可能遗留下来
+    quint32 minSegment = active;
+    for (const Entry &entry : std::as_const(m_entries))
+        minSegment = qMin(minSegment, entry.segment);
+    for (const QList<Entry> &extensions : std::as_const(m_extensions)) {
+        for (const Entry &entry : extensions)
+            minSegment = qMin(minSegment, entry.segment);
+    }
+    for (quint32 segment : segments) {
+        if (segment < minSegment)
+            QFile::remove(segmentPath(segment));
+    }
+
+    m_compactTimer->start();
+
+    qInfo() << "history store opened, items:" << m_order.size() << "path:" << m_path;
+    return true;
+}
+
+static QByteArray filesToBuf(const QStringList &files)
+{
+    QByteArray filesBuf;
+    if (!files.isEmpty()) {
+        QDataStream stream(&filesBuf, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_11);
+        stream << files;
+    }
+    return filesBuf;
+}
+
+bool HistoryStore::append(quint64 id, quint64 hash, int type, qint64 time, const QByteArray &payload, const QStringList &files)
+{
+    if (!isOpen())
+        return false;
+
+    const QByteArray filesBuf = filesToBuf(files);
+
+    Entry entry;
+    entry.id = id;
+    entry.hash = hash;
+    entry.time = time;
+    entry.type = type;
+
+    Entry written;
+    if (!writeRecord(PutOp, entry, filesBuf, payload, &written))
+        return false;
+
+    apply(PutOp, written);
+    if (m_fileBytesLoaded)
+        setFileBytes(id, filesSize(files));
+    return true;
+}
+
+bool HistoryStore::replace(quint64 id, const QByteArray &payload, const QStringList &files)
+{
+    if (!isOpen() || !m_entries.contains(id))
+        return false;
+
+    // 替换数据内容，指纹、类型、复制时间和顺序不变
+    const QStringList released = this->files(id);
+    const Entry entry = m_entries.value(id);
+    const QList<Entry> extensions = m_extensions.value(id);
+
+    Entry written;
+    if (!writeRecord(PutOp, entry, filesToBuf(files), payload, &written))
+        return false;
+
+    apply(PutOp, written);
+    if (m_fileBytesLoaded)
+        setFileBytes(id, filesSize(files));
+    wipeRecord(entry);
+    for (const Entry &extension : extensions)
+        wipeRecord(extension);
+
+    if (!released.isEmpty())
+        Q_EMIT filesReleased(released);
+    return true;
+}
+
+bool HistoryStore::extend(quint64 id, const QByteArray &fragment, const QStringList &files)
+{
+    if (!isOpen() || !m_entries.contains(id))
+        return false;
+
+    // 只写入追加的部分，原有的记录不变
+    Entry written;
+    if (!writeRecord(ExtendOp, m_entries.value(id), filesToBuf(files), fragment, &written))
+        return false;
+
+    apply(ExtendOp, written);
+    if (m_fileBytesLoaded)
+        setFileBytes(id, m_fileBytes.value(id) + filesSize(files));
+    return true;
+}
+
+bool HistoryStore::touch(quint64 id, qint64 time)
+{
+    if (!isOpen() || !m_entries.contains(id))
+        return false;
+
+    Entry entry = m_entries.value(id);
+    entry.time = time;
+
+    Entry written;
+    if (!writeRecord(TouchOp, entry, QByteArray(), QByteArray(), &written))
+        return false;
+
+    apply(TouchOp, written);
+    return true;
+}
+
+bool HistoryStore::remove(quint64 id)
+{
+    if (!isOpen() || !m_entries.contains(id))
+        return false;
+
+    const QStringList released = files(id);
+    const Entry removed = m_entries.value(id);
+    const QList<Entry> extensions = m_extensions.value(id);
+
+    Entry entry;
+    entry.id = id;
+
+    Entry written;
+    if (!writeRecord(RemoveOp, entry, QByteArray(), QByteArray(), &written))
+        return false;
+
+    apply(RemoveOp, written);
+    setFileBytes(id, 0);
+    // 删除标记写入后再清除数据内容，被删除的数据(可能包含密码等)不再以明文留在段文件中
+    wipeRecord(removed);
+    for (const Entry &extension : extensions)
+        wipeRecord(extension);
+
+    if (!released.isEmpty())
+        Q_EMIT filesReleased(released);
+    return true;
+}
+
+void HistoryStore::clear()
+{
+    if (!isOpen() || m_order.isEmpty())
+        return;
+
+    const QStringList released = referencedFiles();
+
+    Entry written;
+    if (!writeRecord(ClearOp, Entry(), QByteArray(), QByteArray(), &written))
+        return;
+
+    apply(ClearOp, written);
+    m_fileBytes.clear();
+    m_totalFileBytes = 0;
+
+    if (!released.isEmpty())
+        Q_EMIT filesReleased(released);
+
+    // 立即压缩，删除所有旧的段文件
+    compact(true);
+}
+
+QList<quint64> HistoryStore::ids() const
+{
+    QList<quint64> list;
+    list.reserve(m_order.size());
+    for (auto it = m_order.crbegin(); it != m_order.crend(); ++it)
+        list.append(*it);
+    return list;
+}
+
+QList<quint64> HistoryStore::idsBefore(qint64 time, quint64 id, int count) const
+{
+    // 以上一页最后一条记录的复制时间和id为游标，期间新增、置顶或删除的记录不会使后面的页重复或遗漏
+    QList<quint64> list;
+    for (auto it = m_order.crbegin(); it != m_order.crend() && list.size() < count; ++it) {
+        const Entry &entry = m_entries[*it];
+        if (id == 0 || entry.time < time || (entry.time == time && entry.id < id))
+            list.append(entry.id);
+    }
+    return list;
+}
+
+QList<quint64> HistoryStore::idsSince(quint64 id) const
+{
+    // 在该记录之后复制(包括重复复制)的记录，按复制时间从新到旧
+    QList<quint64> list;
+    if (m_entries.contains(id)) {
+        for (auto it = m_order.crbegin(); it != m_order.crend() && *it != id; ++it)
+            list.append(*it);
+        return list;
+    }
+
+    // 记录已被删除时返回之后新增的记录
+    for (auto it = m_order.crbegin(); it != m_order.crend(); ++it) {
+        if (*it > id)
+            list.append(*it);
+    }
+    return list;
+}
+
+QByteArray HistoryStore::payload(quint64 id)
+{
+    const auto it = m_entries.constFind(id);
+    if (it == m_entries.constEnd())
+        return QByteArray();
+
+    // 每部分读取后立即复制，读取下一部分时段文件可能被重新映射
+    const QByteArray view = recordPayload(*it);
+    if (view.isEmpty())
+        return QByteArray();
+
+    QByteArray buf(view.constData(), view.size());
+    for (const Entry &extension : m_extensions.value(id)) {
+        const QByteArray fragment = recordPayload(extension);
+        if (fragment.isEmpty())
+            return QByteArray();
+        buf.append(fragment.constData(), fragment.size());
+    }
+    return buf;
+}
+
+QByteArray HistoryStore::payloadView(quint64 id)
+{
+    const auto it = m_entries.constFind(id);
+    if (it == m_entries.constEnd())
+        return QByteArray();
+
+    if (m_extensions.contains(id))
+        return payload(id);
+    return recordPayload(*it);
+}
+
+QStringList HistoryStore::files(quint64 id)
+{
+    const auto it = m_entries.constFind(id);
+    if (it == m_entries.constEnd())
+        return QStringList();
+
+    QStringList list = recordFiles(*it);
+    for (const Entry &extension : m_extensions.value(id))
+        list.append(recordFiles(extension));
+    return list;
+}
+
+QStringList HistoryStore::referencedFiles()
+{
+    QStringList list;
+    for (quint64 id : std::as_const(m_order))
+        list.append(files(id));
+    return list;
+}
+
+bool HistoryStore::compact(bool force)
+{
+    if (!isOpen())
+        return false;
+
+    if (!force && (m_deadBytes < CompactMinDeadBytes || m_deadBytes < m_liveBytes))
+        return false;
+
+    // 有效记录按顺序写入新的段文件，重复复制更新的时间合并到记录中
+    const quint32 segment = m_activeSegment + 1;
+    QFile segmentFile(segmentPath(segment));
+    if (!segmentFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "open file failed, file name:" << segmentFile.fileName();
+        return false;
+    }
+    segmentFile.setPermissions(FilePermissions);
+
+    QSaveFile indexFile(indexPath());
+    if (!indexFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "open file failed, file name:" << indexPath();
+        segmentFile.remove();
+        return false;
+    }
+    indexFile.setPermissions(FilePermissions);
+
+    IndexHeader indexHeader;
+    memset(&indexHeader, 0, sizeof(indexHeader));
+    indexHeader.magic = IndexMagic;
+    indexHeader.version = IndexVersion;
+    bool ok = indexFile.write(reinterpret_cast<const char *>(&indexHeader), sizeof(indexHeader)) == sizeof(indexHeader);
+
+    QHash<quint64, Entry> entries;
+    entries.reserve(m_entries.size());
+    quint64 offset = 0;
+    for (quint64 id : std::as_const(m_order)) {
+        if (!ok)
+            break;
+
+        const Entry &old = m_entries[id];
+        RecordHeader header;
+        QByteArray filesBuf;
+        QByteArray payloadBuf;
+        const char *files = nullptr;
+        const char *payload = nullptr;
+        if (m_extensions.contains(id)) {
+            // 追加过数据的记录合并为一条
+            filesBuf = filesToBuf(this->files(id));
+            payloadBuf = this->payload(id);
+            if (payloadBuf.isEmpty() || qint64(sizeof(header)) + filesBuf.size() + payloadBuf.size() > std::numeric_limits<quint32>::max()) {
+                ok = false;
+                break;
+            }
+
+            memset(&header, 0, sizeof(header));
+            header.magic = RecordMagic;
+            header.type = static_cast<quint8>(old.type);
+            header.id = old.id;
+            header.hash = old.hash;
+            header.filesLength = static_cast<quint32>(filesBuf.size());
+            header.payloadLength = static_cast<quint32>(payloadBuf.size());
+            files = filesBuf.constData();
+            payload = payloadBuf.constData();
+        } else {
+            const uchar *data = record(old);
+            if (!data) {
+                ok = false;
+                break;
+            }
+
+            memcpy(&header, data, sizeof(header));
+            files = reinterpret_cast<const char *>(data + sizeof(header));
+            payload = files + header.filesLength;
+        }
+        header.op = PutOp;
+        header.flags = header.filesLength > 0 ? HasFilesFlag : 0;
+        header.time = old.time;
+        header.checksum = recordChecksum(header, files, header.filesLength, payload, header.payloadLength);
+
+        Entry entry = old;
+        entry.hasFiles = header.filesLength > 0;
+        entry.segment = segment;
+        entry.offset = offset;
+        entry.length = static_cast<quint32>(sizeof(header) + header.filesLength + header.payloadLength);
+        const IndexEntry item = makeIndexEntry(PutOp, entry);
+
+        ok = segmentFile.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header)
+                && segmentFile.write(files, header.filesLength) == header.filesLength
+                && segmentFile.write(payload, header.payloadLength) == header.payloadLength
+                && indexFile.write(reinterpret_cast<const char *>(&item), sizeof(item)) == sizeof(item);
+
+        entries.insert(id, entry);
+        offset += entry.length;
+    }
+
+    // 新的段文件落盘后再替换索引，替换之前异常退出时旧的索引和段文件仍然有效
+    if (ok)
+        ok = segmentFile.flush() && ::fsync(segmentFile.handle()) == 0;
+    segmentFile.close();
+    if (!ok || !indexFile.commit()) {
+        qWarning() << "compact history failed, path:" << m_path;
+        indexFile.cancelWriting();
+        QFile::remove(segmentPath(segment));
+        return false;
+    }
+
+    unmapAll();
+    m_segmentFile.close();
+    for (quint32 old : listSegments(m_path)) {
+        if (old != segment)
+            QFile::remove(segmentPath(old));
+    }
+
+    m_entries = entries;
+    m_extensions.clear();
+    m_liveBytes = static_cast<qint64>(offset);
+    m_deadBytes = 0;
+
+    m_indexFile.close();
+    m_indexFile.setFileName(indexPath());
+    if (!m_indexFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered) || !m_indexFile.seek(m_indexFile.size())) {
+        qWarning() << "open file failed, file name:" << indexPath();
+        return false;
+    }
+
+    if (!openActiveSegment(segment))
+        return false;
+
+    qInfo() << "history store compacted, items:" << m_order.size() << "bytes:" << m_liveBytes;
+    return true;
+}
+
+void HistoryStore::setRetention(int maxItems, qint64 maxBytes)
+{
+    m_maxItems = qMax(0, maxItems);
+    m_maxBytes = qMax<qint64>(0, maxBytes);
+}
+
+QList<quint64> HistoryStore::trim()
+{
+    QList<quint64> removed;
+    if (!isOpen() || (m_maxItems == 0 && m_maxBytes == 0))
+        return removed;
+
+    if (m_maxBytes > 0)
+        loadFileBytes();
+
+    // 从最旧的开始删除，引用的缓存文件通过filesReleased释放。多条记录共用的缓存文件会重复计算，只会删除得更多
+    while (m_order.size() > 1
+           && ((m_maxItems > 0 && m_order.size() > m_maxItems)
+               || (m_maxBytes > 0 && m_liveBytes + m_totalFileBytes > m_maxBytes))) {
+        const quint64 id = m_order.first();
+        if (!remove(id))
+            break;
+        removed.append(id);
+    }
+    return removed;
+}
+
+QString HistoryStore::segmentPath(quint32 segment) const
+{
+    return m_path + QStringLiteral("/segment-%1.log").arg(segment, 8, 10, QLatin1Char('0'));
+}
+
+QString HistoryStore::indexPath() const
+{
+    return m_path + QStringLiteral("/index");
+}
+
+bool HistoryStore::loadIndex(quint32 &segment, quint64 &end)
+{
+    m_indexFile.close();
+    m_indexFile.setFileName(indexPath());
+    if (!m_indexFile.exists() || !m_indexFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered))
+        return false;
+
+    const qint64 size = m_indexFile.size();
+    uchar *data = size >= qint64(sizeof(IndexHeader)) ? m_indexFile.map(0, size) : nullptr;
+    if (!data) {
+        m_indexFile.close();
+        return false;
+    }
+
+    IndexHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != IndexMagic || header.version != IndexVersion) {
+        m_indexFile.unmap(data);
+        m_indexFile.close();
+        return false;
+    }
+
+    // 只遍历映射的索引项恢复记录列表，不读取段文件中的数据内容
+    QHash<quint32, qint64> segmentSizes;
+    qint64 pos = sizeof(IndexHeader);
+    while (pos + qint64(sizeof(IndexEntry)) <= size) {
+        IndexEntry item;
+        memcpy(&item, data + pos, sizeof(item));
+        if (item.checksum != indexChecksum(item))
+            break;
+
+        // 索引项指向的记录不完整时，从该位置开始重新扫描段文件
+        if (!segmentSizes.contains(item.segment))
+            segmentSizes.insert(item.segment, QFileInfo(segmentPath(item.segment)).size());
+        if (qint64(item.offset) + item.length > segmentSizes.value(item.segment))
+            break;
+
+        Entry entry;
+        entry.id = item.id;
+        entry.hash = item.hash;
+        entry.time = item.time;
+        entry.type = item.type;
+        entry.hasFiles = item.flags & HasFilesFlag;
+        entry.segment = item.segment;
+        entry.offset = item.offset;
+        entry.length = item.length;
+        apply(item.op, entry);
+
+        segment = item.segment;
+        end = item.offset + item.length;
+        pos += sizeof(IndexEntry);
+    }
+    m_indexFile.unmap(data);
+
+    if (pos != size) {
+        qWarning() << "truncate incomplete history index, offset:" << pos << "size:" << size;
+        m_indexFile.resize(pos);
+    }
+
+    return m_indexFile.seek(pos);
+}
+
+bool HistoryStore::recoverSegment(quint32 segment, quint64 from)
+{
+    QFile file(segmentPath(segment));
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "open file failed, file name:" << file.fileName();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (qint64(from) >= size)
+        return true;
+
+    uchar *data = file.map(0, size);
+    if (!data) {
+        qWarning() << "map file failed, file name:" << file.fileName();
+        return false;
+    }
+
+    qint64 pos = static_cast<qint64>(from);
+    while (pos + qint64(sizeof(RecordHeader)) <= size) {
+        RecordHeader header;
+        memcpy(&header, data + pos, sizeof(header));
+        const qint64 length = qint64(sizeof(header)) + header.filesLength + header.payloadLength;
+        if (header.magic != RecordMagic || pos + length > size)
+            break;
+
+        const char *files = reinterpret_cast<const char *>(data + pos + sizeof(header));
+        if (recordChecksum(header, files, header.filesLength, files + header.filesLength, header.payloadLength) != header.checksum)
+            break;
+
+        Entry entry;
+        entry.id = header.id;
+        entry.hash = header.hash;
+        entry.time = header.time;
+        entry.type = header.type;
+        entry.hasFiles = header.filesLength > 0;
+        entry.segment = segment;
+        entry.offset = static_cast<quint64>(pos);
+        entry.length = static_cast<quint32>(length);
+        apply(header.op, entry);
+        writeIndexEntry(header.op, entry);
+
+        pos += length;
+    }
+    file.unmap(data);
+
+    // 截断进程异常退出时写了一半的记录
+    if (pos != size) {
+        qWarning() << "truncate incomplete history record, file name:" << file.fileName() << "offset:" << pos;
+        file.resize(pos);
+    }
+    return true;
+}
+
+bool HistoryStore::openActiveSegment(quint32 segment)
+{
+    m_segmentFile.close();
+    m_segmentFile.setFileName(segmentPath(segment));
+    if (!m_segmentFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        qWarning() << "open file failed, file name:" << m_segmentFile.fileName();
+        return false;
+    }
+    m_segmentFile.setPermissions(FilePermissions);
+
+    m_activeSegment = segment;
+    m_segmentSize = m_segmentFile.size();
+    return true;
+}
+
+bool HistoryStore::resetIndex()
+{
+    m_indexFile.close();
+    m_indexFile.setFileName(indexPath());
+    if (!m_indexFile.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        qWarning() << "open file failed, file name:" << indexPath();
+        return false;
+    }
+    m_indexFile.setPermissions(FilePermissions);
+
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = IndexMagic;
+    header.version = IndexVersion;
+    return m_indexFile.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+}
+
+bool HistoryStore::writeRecord(quint8 op, const Entry &entry, const QByteArray &files, const QByteArray &payload, Entry *written)
+{
+    const qint64 length = qint64(sizeof(RecordHeader)) + files.size() + payload.size();
+    if (length > std::numeric_limits<quint32>::max()) {
+        qWarning() << "history record is too large, size:" << length;
+        return false;
+    }
+
+    // 当前段文件写满后切换到新的段文件
+    if (m_segmentSize > 0 && m_segmentSize + length > MaxSegmentSize) {
+        if (!openActiveSegment(m_activeSegment + 1))
+            return false;
+    }
+
+    RecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = RecordMagic;
+    header.op = op;
+    header.type = static_cast<quint8>(entry.type);
+    header.flags = files.isEmpty() ? 0 : HasFilesFlag;
+    header.id = entry.id;
+    header.hash = entry.hash;
+    header.time = entry.time;
+    header.filesLength = static_cast<quint32>(files.size());
+    header.payloadLength = static_cast<quint32>(payload.size());
+    header.checksum = recordChecksum(header, files.constData(), files.size(), payload.constData(), payload.size());
+
+    const qint64 offset = m_segmentSize;
+    if (m_segmentFile.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)
+            || m_segmentFile.write(files) != files.size()
+            || m_segmentFile.write(payload) != payload.size()) {
+        qWarning() << "write history record failed:" << m_segmentFile.errorString();
+        m_segmentFile.resize(offset);
+        return false;
+    }
+    m_segmentSize += length;
+
+    *written = entry;
+    written->hasFiles = !files.isEmpty();
+    written->segment = m_activeSegment;
+    written->offset = static_cast<quint64>(offset);
+    written->length = static_cast<quint32>(length);
+
+    // 索引写入失败时，下次启动会从段文件中补上
+    writeIndexEntry(op, *written);
+    return true;
+}
+
+bool HistoryStore::writeIndexEntry(quint8 op, const Entry &entry)
+{
+    const IndexEntry item = makeIndexEntry(op, entry);
+    if (m_indexFile.write(reinterpret_cast<const char *>(&item), sizeof(item)) != sizeof(item)) {
+        qWarning() << "write history index failed:" << m_indexFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+void HistoryStore::apply(quint8 op, const Entry &entry)
+{
+    m_nextId = qMax(m_nextId, entry.id + 1);
+
+    switch (op) {
+    case PutOp: {
+        // 同一条记录再次写入时(替换数据内容)以最后一次为准，保持原来的顺序
+        const auto it = m_entries.find(entry.id);
+        if (it != m_entries.end()) {
+            dropExtensions(entry.id);
+            m_liveBytes -= it->length;
+            m_deadBytes += it->length;
+            if (it->hash != 0 && it->hash != entry.hash && m_hashIndex.value(it->hash) == entry.id)
+                m_hashIndex.remove(it->hash);
+            *it = entry;
+        } else {
+            m_entries.insert(entry.id, entry);
+            m_order.append(entry.id);
+        }
+        if (entry.hash != 0)
+            m_hashIndex.insert(entry.hash, entry.id);
+        m_liveBytes += entry.length;
+        break;
+    }
+    case TouchOp: {
+        m_deadBytes += entry.length;
+        const auto it = m_entries.find(entry.id);
+        if (it == m_entries.end())
+            break;
+        it->time = entry.time;
+        m_order.removeOne(entry.id);
+        m_order.append(entry.id);
+        break;
+    }
+    case RemoveOp: {
+        m_deadBytes += entry.length;
+        const auto it = m_entries.constFind(entry.id);
+        if (it == m_entries.constEnd())
+            break;
+        dropExtensions(entry.id);
+        m_liveBytes -= it->length;
+        m_deadBytes += it->length;
+        if (it->hash != 0 && m_hashIndex.value(it->hash) == entry.id)
+            m_hashIndex.remove(it->hash);
+        m_order.removeOne(entry.id);
+        m_entries.erase(it);
+        break;
+    }
+    case ClearOp:
+        m_deadBytes += m_liveBytes + entry.length;
+        m_liveBytes = 0;
+        m_entries.clear();
+        m_extensions.clear();
+        m_hashIndex.clear();
+        m_order.clear();
+        break;
+    case ExtendOp:
+        // 追加到已经删除的记录时直接作为无效数据
+        if (m_entries.contains(entry.id)) {
+            m_extensions[entry.id].append(entry);
+            m_liveBytes += entry.length;
+        } else {
+            m_deadBytes += entry.length;
+        }
+        break;
+    default:
+        qWarning() << "unknown history record, op:" << op;
+        break;
+    }
+}
+
+const uchar *HistoryStore::record(const Entry &entry)
+{
+    Mapping &mapping = m_mappings[entry.segment];
+    const qint64 end = qint64(entry.offset) + entry.length;
+
+    // 当前段文件在映射之后又追加了数据，需要重新映射
+    if (mapping.data && end > mapping.size) {
+        mapping.file->unmap(mapping.data);
+        mapping.data = nullptr;
+    }
+
+    if (!mapping.data) {
+        if (!mapping.file)
+            mapping.file = new QFile(segmentPath(entry.segment));
+        if (!mapping.file->isOpen() && !mapping.file->open(QIODevice::ReadOnly)) {
+            qWarning() << "open file failed, file name:" << mapping.file->fileName();
+            return nullptr;
+        }
+
+        mapping.size = mapping.file->size();
+        if (end > mapping.size) {
+            qWarning() << "history record out of range, file name:" << mapping.file->fileName() << "offset:" << entry.offset;
+            return nullptr;
+        }
+
+        mapping.data = mapping.file->map(0, mapping.size);
+        if (!mapping.data) {
+            qWarning() << "map file failed, file name:" << mapping.file->fileName();
+            return nullptr;
+        }
+    }
+
+    const uchar *data = mapping.data + entry.offset;
+    RecordHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != RecordMagic || header.id != entry.id) {
+        qWarning() << "invalid history record, id:" << entry.id;
+        return nullptr;
+    }
+    return data;
+}
+
+QByteArray HistoryStore::recordPayload(const Entry &entry)
+{
+    const uchar *data = record(entry);
+    if (!data)
+        return QByteArray();
+
+    RecordHeader header;
+    memcpy(&header, data, sizeof(header));
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(data + sizeof(header) + header.filesLength), header.payloadLength);
+}
+
+QStringList HistoryStore::recordFiles(const Entry &entry)
+{
+    if (!entry.hasFiles)
+        return QStringList();
+
+    const uchar *data = record(entry);
+    if (!data)
+        return QStringList();
+
+    RecordHeader header;
+    memcpy(&header, data, sizeof(header));
+    const QByteArray filesBuf = QByteArray::fromRawData(reinterpret_cast<const char *>(data + sizeof(header)), header.filesLength);
+
+    QStringList list;
+    QDataStream stream(filesBuf);
+    stream.setVersion(QDataStream::Qt_5_11);
+    stream >> list;
+    return list;
+}
+
+qint64 HistoryStore::filesSize(const QStringList &files) const
+{
+    qint64 size = 0;
+    for (const QString &file : files)
+        size += QFileInfo(file).size();
+    return size;
+}
+
+void HistoryStore::loadFileBytes()
+{
+    if (m_fileBytesLoaded)
+        return;
+
+    m_fileBytesLoaded = true;
+    for (quint64 id : std::as_const(m_order))
+        setFileBytes(id, filesSize(files(id)));
+}
+
+void HistoryStore::setFileBytes(quint64 id, qint64 bytes)
+{
+    m_totalFileBytes += bytes - m_fileBytes.value(id);
+    if (bytes > 0) {
+        m_fileBytes.insert(id, bytes);
+    } else {
+        m_fileBytes.remove(id);
+    }
+}
+
+void HistoryStore::dropExtensions(quint64 id)
+{
+    const QList<Entry> extensions = m_extensions.take(id);
+    for (const Entry &extension : extensions) {
+        m_liveBytes -= extension.length;
+        m_deadBytes += extension.length;
+    }
+}
+
+bool HistoryStore::wipeRecord(const Entry &entry)
+{
+    const uchar *data = record(entry);
+    if (!data)
+        return false;
+
+    // 文件列表和数据内容清零，重新计算校验值，从段文件重建索引时记录仍然有效
+    RecordHeader header;
+    memcpy(&header, data, sizeof(header));
+    const QByteArray zeros(qsizetype(header.filesLength) + header.payloadLength, '\0');
+    header.checksum = recordChecksum(header, zeros.constData(), header.filesLength,
+                                     zeros.constData() + header.filesLength, header.payloadLength);
+
+    QFile file(segmentPath(entry.segment));
+    if (!file.open(QIODevice::ReadWrite) || !file.seek(qint64(entry.offset))
+            || file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)
+            || file.write(zeros) != zeros.size()
+            || !file.flush() || ::fdatasync(file.handle()) != 0) {
+        qWarning() << "wipe history record failed, file name:" << file.fileName() << "offset:" << entry.offset;
+        return false;
+    }
+    return true;
+}
+
+void HistoryStore::unmapAll()
+{
+    for (Mapping &mapping : m_mappings) {
+        if (mapping.data)
+            mapping.file->unmap(mapping.data);
+        delete mapping.file;
+    }
+    m_mappings.clear();
+}
@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+
+/*!
+ * \~chinese \class HistoryStore
+ * \~chinese \brief 剪贴板历史记录的持久化存储。
+ * \~chinese 数据以只追加的方式写入段文件(segment-xxxxxxxx.log)，每写入一条记录同时向索引文件追加一条定长的索引项。
+ * \~chinese 启动时只映射索引文件恢复记录列表，数据内容在需要时才从映射的段文件中读取。
+ * \~chinese 删除记录时追加删除标记，并将旧记录的数据内容清零，无效数据达到一定比例后定期压缩。
+ * \~chinese 已保存的记录补充数据时只追加新的部分，读取时按顺序拼接在原有数据内容之后，压缩时合并为一条记录。
+ * \~chinese 每条记录都带有校验值，进程异常退出造成的不完整数据在下次启动时会被截断，索引丢失时从段文件重建。
+ * \~chinese 目录和文件只有所有者可以访问；可以设置记录数量和总大小的上限，超过后由trim删除最旧的记录。
+ */
+class HistoryStore : public QObject
+{
+    Q_OBJECT
+public:
+    struct Entry {
+        quint64 id = 0;
+        quint64 hash = 0;
+        qint64 time = 0;            // 复制时间(ms)，重复复制时更新
+        int type = 0;
+        bool hasFiles = false;      // 记录是否引用了外部缓存文件
+        quint32 segment = 0;
+        quint64 offset = 0;         // 记录在段文件中的偏移
+        quint32 length = 0;         // 记录的总长度
+    };
+
+    explicit HistoryStore(const QString &path, QObject *parent = nullptr);
+    ~HistoryStore() override;
+
+    bool open();
+    bool isOpen() const { return m_segmentFile.isOpen(); }
+    QString path() const { return m_path; }
+
+    quint64 allocateId() { return m_nextId++; }
+    bool append(quint64 id, quint64 hash, int type, qint64 time, const QByteArray &payload,
+                const QStringList &files = QStringList());
+    bool replace(quint64 id, const QByteArray &payload, const QStringList &files = QStringList());
+    /*!
+     * \~chinese \brief 在记录的数据内容之后追加fragment，引用的缓存文件增加files，原有的数据不重新写入
+     */
+    bool extend(quint64 id, const QByteArray &fragment, const QStringList &files = QStringList());
+    bool touch(quint64 id, qint64 time);
+    bool remove(quint64 id);
+    void clear();
+
+    bool contains(quint64 id) const { return m_entries.contains(id); }
+    quint64 findByHash(quint64 hash) const { return m_hashIndex.value(hash); }
+    int count() const { return m_order.size(); }
+    QList<quint64> ids() const;             // 按复制时间从新到旧
+    QList<quint64> idsBefore(qint64 time, quint64 id, int count) const;    // 复制时间早于(time, id)的记录，id为0时从最新的开始
+    QList<quint64> idsSince(quint64 id) const;
+    Entry entry(quint64 id) const { return m_entries.value(id); }
+    QByteArray payload(quint64 id);
+    /*!
+     * \~chinese \brief 直接引用映射的段文件中的数据内容，不复制。
+     * \~chinese 再次读取、写入或压缩历史记录后可能解除映射，返回的数据只能在这之前使用。
+     * \~chinese 记录追加过数据时内容不连续，返回拼接后的副本
+     */
+    QByteArray payloadView(quint64 id);
+    QStringList files(quint64 id);
+    QStringList referencedFiles();
+
+    qint64 liveBytes() const { return m_liveBytes; }
+    qint64 deadBytes() const { return m_deadBytes; }
+    bool compact(bool force = false);
+
+    /*!
+     * \~chinese \brief 设置保留的记录数量和总大小(包括引用的缓存文件)的上限，为0表示不限制
+     */
+    void setRetention(int maxItems, qint64 maxBytes);
+    /*!
+     * \~chinese \brief 超过上限时删除最旧的记录，最新的一条总是保留，返回被删除的记录id
+     */
+    QList<quint64> trim();
+
+Q_SIGNALS:
+    void filesReleased(const QStringList &files);   // 被删除的记录引用的缓存文件，可以清理
+
+private:
+    struct Mapping {
+        QFile *file = nullptr;
+        uchar *data = nullptr;
+        qint64 size = 0;
+    };
+
+    QString segmentPath(quint32 segment) const;
+    QString indexPath() const;
+    bool loadIndex(quint32 &segment, quint64 &end);
+    bool recoverSegment(quint32 segment, quint64 from);
+    bool openActiveSegment(quint32 segment);
+    bool resetIndex();
+    bool writeRecord(quint8 op, const Entry &entry, const QByteArray &files, const QByteArray &payload, Entry *written);
+    bool writeIndexEntry(quint8 op, const Entry &entry);
+    void apply(quint8 op, const Entry &entry);
+    const uchar *record(const Entry &entry);
+    QByteArray recordPayload(const Entry &entry);
+    QStringList recordFiles(const Entry &entry);
+    void dropExtensions(quint64 id);
+    qint64 filesSize(const QStringList &files) const;
+    void loadFileBytes();
+    void setFileBytes(quint64 id, qint64 bytes);
+    bool wipeRecord(const Entry &entry);
+    void unmapAll();
+
+private:
+    QString m_path;
+    QFile m_segmentFile;                    // 当前追加写入的段文件
+    qint64 m_segmentSize = 0;
+    QFile m_indexFile;
+    quint32 m_activeSegment = 1;
+    QHash<quint32, Mapping> m_mappings;     // 已映射的段文件，读取数据时按需映射
+
+    QHash<quint64, Entry> m_entries;
+    QHash<quint64, QList<Entry>> m_extensions;  // 记录id -> 之后追加的数据，按写入顺序
+    QHash<quint64, quint64> m_hashIndex;    // 内容指纹 -> 记录id
+    QList<quint64> m_order;                 // 按复制时间从旧到新
+    quint64 m_nextId = 1;
+    qint64 m_liveBytes = 0;
+    qint64 m_deadBytes = 0;
+
+    int m_maxItems = 0;
+    qint64 m_maxBytes = 0;
+    bool m_fileBytesLoaded = false;         // 引用的缓存文件大小在第一次trim时才统计，启动时不读取段文件
+    QHash<quint64, qint64> m_fileBytes;     // 记录id -> 引用的缓存文件大小
+    qint64 m_totalFileBytes = 0;
+
+    QTimer *m_compactTimer;
+};
+
+#endif // HISTORYSTORE_H
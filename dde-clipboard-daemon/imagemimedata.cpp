@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "imagemimedata.h"
+#include "blobstore.h"
+
+#include <QBuffer>
+#include <QCache>
+#include <QImageWriter>
+#include <QDebug>
+
+static const QString ApplicationXQtImage = QStringLiteral("application/x-qt-image");
+static const QString ImagePng = QStringLiteral("image/png");
+static constexpr qsizetype TranscodeCacheSize = 64 * 1024 * 1024;   // 转换结果最多缓存64MB
+
+// 格式转换的结果，key为缓存文件和格式
+static QCache<QString, QByteArray> &transcodeCache()
+{
+    static QCache<QString, QByteArray> cache(TranscodeCacheSize);
+    return cache;
+}
+
+ImageMimeData::ImageMimeData(const QString &pngFile, BlobStore *store)
+    : BlobMimeData(store)
+{
+    setFile(ImagePng, pngFile);
+}
+
+QStringList ImageMimeData::formats() const
+{
+    QStringList formats = BlobMimeData::formats();
+    for (const QString &format : {ApplicationXQtImage, ImagePng}) {
+        if (!formats.contains(format))
+            formats.append(format);
+    }
+    return formats;
+}
+
+bool ImageMimeData::hasFormat(const QString &mimeType) const
+{
+    return formats().contains(mimeType);
+}
+
+void ImageMimeData::clearTranscodeCache()
+{
+    transcodeCache().clear();
+}
+
+QVariant ImageMimeData::retrieveData(const QString &mimeType, QMetaType type) const
+{
+    if (mimeType == ImagePng)
+        return png();
+
+    // 按字节获取application/x-qt-image时，和Qt的约定一样提供png数据
+    if (mimeType == ApplicationXQtImage)
+        return type.id() == QMetaType::QImage ? QVariant(image()) : QVariant(png());
+
+    // 来源提供的原始编码数据直接使用，没有保存的图片格式从png转换
+    const QVariant data = BlobMimeData::retrieveData(mimeType, type);
+    if (mimeType.startsWith(QLatin1String("image/")) && data.toByteArray().isEmpty())
+        return transcode(mimeType);
+
+    return data;
+}
+
+QByteArray ImageMimeData::png() const
+{
+    if (m_png.isEmpty())
+        m_png = BlobStore::read(pngFile());
+    return m_png;
+}
+
+QImage ImageMimeData::image() const
+{
+    if (m_image.isNull() && !m_image.loadFromData(png(), "PNG"))
+        qDebug() << "QImage failed to read cached image file" << pngFile();
+    return m_image;
+}
+
+QByteArray ImageMimeData::transcode(const QString &mimeType) const
+{
+    const QByteArray format = mimeType.mid(6).toLower().toLatin1();
+    if (!QImageWriter::supportedImageFormats().contains(format))
+        return QByteArray();
+
+    const QString key = pngFile() + QLatin1Char('\n') + mimeType;
+    if (const QByteArray *cached = transcodeCache().object(key))
+        return *cached;
+
+    const QImage source = image();
+    if (source.isNull())
+        return QByteArray();
+
+    QByteArray content;
+    QBuffer buf(&content);
+    buf.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buf, format);
+    if (!writer.write(source)) {
+        qDebug() << "convert image to" << mimeType << "failed:" << writer.errorString();
+        return QByteArray();
+    }
+
+    transcodeCache().insert(key, new QByteArray(content), content.size());
+    return content;
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IMAGEMIMEDATA_H
+#define IMAGEMIMEDATA_H
+
+#include "blobmimedata.h"
+
+#include <QImage>
+
+/*!
+ * \~chinese \class ImageMimeData
+ * \~chinese \brief 重新设置到剪贴板的图片数据。
+ * \~chinese image/png直接使用缓存文件中的编码数据，来源提供的其他编码格式使用保存的原始数据，粘贴时不再重新编码。
+ * \~chinese 只在需要时解码图片，转换成其他格式的结果按照缓存文件和格式缓存，同一张图片多次粘贴只转换一次。
+ * \~chinese 只在GUI线程中使用。
+ */
+class ImageMimeData : public BlobMimeData
+{
+    Q_OBJECT
+public:
+    explicit ImageMimeData(const QString &pngFile, BlobStore *store = nullptr);
+
+    QString pngFile() const { return file(QStringLiteral("image/png")); }
+
+    QStringList formats() const override;
+    bool hasFormat(const QString &mimeType) const override;
+
+    /*!
+     * \~chinese \brief 清空格式转换的缓存
+     */
+    static void clearTranscodeCache();
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QMetaType type) const override;
+
+private:
+    QByteArray png() const;
+    QImage image() const;
+    QByteArray transcode(const QString &mimeType) const;
+
+private:
+    mutable QByteArray m_png;           // 第一次使用时读取
+    mutable QImage m_image;             // 第一次使用时解码
+};
+
+#endif // IMAGEMIMEDATA_H
@@ -11,11 +11,15 @@
 
 #include "clipboarddaemon.h"
 
+#include <csignal>
+
 DCORE_USE_NAMESPACE
 
 int main(int argc, char *argv[])
 {
     QGuiApplication a(argc, argv);
+    // 粘贴的目标程序提前关闭管道时，写入返回EPIPE，不能因为SIGPIPE退出
+    signal(SIGPIPE, SIG_IGN);
     a.setOrganizationName("deepin");
     a.setApplicationName("dde-clipboard-daemon");
 
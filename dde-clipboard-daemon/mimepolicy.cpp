@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mimepolicy.h"
+
+#include <QImageWriter>
+#include <QMimeData>
+#include <QSet>
+
+namespace MimePolicy {
+
+// 过滤数据时需要的标识，以及预览需要的文本、文件格式
+static bool isPreviewFormat(const QString &format)
+{
+    static const QSet<QString> previewFormats = {
+        "TIMESTAMP", "FROM_DEEPIN_CLIPBOARD_MANAGER", "uos/remote-copy",
+        "text/plain", "text/uri-list", "x-dfm-copied/file-icons", "application/x-qt-image"
+    };
+
+    return previewFormats.contains(format) || format.startsWith("text/plain;");
+}
+
+QString imageFormat(const QStringList &formats)
+{
+    if (formats.contains("image/png"))
+        return QStringLiteral("image/png");
+
+    const auto supportedFormats = QImageWriter::supportedImageFormats();
+    for (const QByteArray &supportedFormat : supportedFormats) {
+        const QString format = "image/" + supportedFormat;
+        if (formats.contains(format))
+            return format;
+    }
+    return QString();
+}
+
+QStringList eagerFormats(const QStringList &formats)
+{
+    const QString image = imageFormat(formats);
+    // 没有纯文本时使用html生成预览
+    const bool needHtml = !formats.contains("text/plain");
+
+    QStringList eager;
+    for (const QString &format : formats) {
+        if (isPreviewFormat(format) || format == image || (needHtml && format == "text/html"))
+            eager.append(format);
+    }
+    return eager;
+}
+
+QStringList deferredFormats(const QStringList &formats)
+{
+    const QStringList eager = eagerFormats(formats);
+
+    QStringList deferred;
+    for (const QString &format : formats) {
+        if (!eager.contains(format))
+            deferred.append(format);
+    }
+    return deferred;
+}
+
+bool isConcealed(const QMimeData *mimeData)
+{
+    // KeePassXC等密码管理器复制密码时附带的标识
+    if (mimeData->hasFormat("x-kde-passwordManagerHint"))
+        return mimeData->data("x-kde-passwordManagerHint") == "secret";
+
+    return mimeData->hasFormat("application/x-nspasteboard-concealed-type")
+            || mimeData->hasFormat("org.nspasteboard.ConcealedType");
+}
+
+} // namespace MimePolicy
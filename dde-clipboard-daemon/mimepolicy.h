@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MIMEPOLICY_H
+#define MIMEPOLICY_H
+
+#include <QStringList>
+
+class QMimeData;
+
+/*!
+ * \~chinese \brief 剪贴板格式的读取策略。
+ * \~chinese 办公软件、浏览器复制时通常提供十几到几十种格式，采集时只立即读取生成预览和去重指纹需要的格式：
+ * \~chinese 纯文本、文件列表、一种图片格式以及过滤数据用的标识，其余格式在数据保存后再在后台读取。
+ */
+namespace MimePolicy {
+
+/*!
+ * \~chinese \brief 从formats中选出一种图片格式，优先使用image/png，没有图片格式时返回空
+ */
+QString imageFormat(const QStringList &formats);
+
+/*!
+ * \~chinese \brief 需要立即读取的格式，保持formats中的顺序
+ */
+QStringList eagerFormats(const QStringList &formats);
+
+/*!
+ * \~chinese \brief 可以延后读取的格式，即formats中除eagerFormats以外的格式
+ */
+QStringList deferredFormats(const QStringList &formats);
+
+/*!
+ * \~chinese \brief 是否是密码管理器标记为敏感的数据，这类数据不保存到历史记录中
+ */
+bool isConcealed(const QMimeData *mimeData);
+
+} // namespace MimePolicy
+
+#endif // MIMEPOLICY_H
@@ -4,6 +4,9 @@
 
 #include "dwaylandmimedata.h"
 #include <QImageReader>
+#include <QDebug>
+#include <unistd.h>
+#include <cerrno>
 
 static const QString ApplicationXQtImageLiteral QStringLiteral("application/x-qt-image");
 
@@ -34,7 +37,41 @@ DWaylandMimeData::DWaylandMimeData()
 
 DWaylandMimeData::~DWaylandMimeData()
 {
+    for (const SpooledData &spooled : std::as_const(m_spooledData))
+        close(spooled.fd);
+}
+
+void DWaylandMimeData::setSpooledData(const QString &mimeType, int fd, qint64 size)
+{
+    auto it = m_spooledData.find(mimeType);
+    if (it != m_spooledData.end())
+        close(it->fd);
+    m_spooledData.insert(mimeType, {fd, size});
+
+    // Register the format with an empty placeholder so that formats() keeps the offer order
+    setData(mimeType, QByteArray());
+}
 
+QVariant DWaylandMimeData::rawData(const QString &mimeType, QMetaType preferredType) const
+{
+    auto it = m_spooledData.constFind(mimeType);
+    if (it == m_spooledData.constEnd())
+        return QMimeData::retrieveData(mimeType, preferredType);
+
+    // Read the whole payload with a single allocation
+    QByteArray data(it->size, Qt::Uninitialized);
+    qint64 offset = 0;
+    while (offset < it->size) {
+        const ssize_t ret = pread(it->fd, data.data() + offset, static_cast<size_t>(it->size - offset), offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0) {
+            qWarning() << "Failed to read spooled data of" << mimeType;
+            return QByteArray();
+        }
+        offset += ret;
+    }
+    return data;
 }
 
 QStringList DWaylandMimeData::formats() const
@@ -54,13 +91,13 @@ QStringList DWaylandMimeData::formats() const
 
 QVariant DWaylandMimeData::retrieveData(const QString &mimeType, QMetaType preferredType) const
 {
-    QVariant data = QMimeData::retrieveData(mimeType, preferredType);
+    QVariant data = rawData(mimeType, preferredType);
     if (mimeType == QLatin1String("application/x-qt-image")) {
         if (data.isNull() || (data.userType() == QMetaType::QByteArray && data.toByteArray().isEmpty())) {
             // try to find an image
             QStringList imageFormats = imageReadMimeFormats();
             for (int i = 0; i < imageFormats.size(); ++i) {
-                data = QMimeData::retrieveData(imageFormats.at(i), preferredType);
+                data = rawData(imageFormats.at(i), preferredType);
                 if (data.isNull() || (data.userType() == QMetaType::QByteArray && data.toByteArray().isEmpty()))
                     continue;
                 break;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <QMap>
 #include <QMimeData>
 
 class DWaylandMimeData : public QMimeData
@@ -14,4 +15,25 @@ public:
     ~DWaylandMimeData() override;
     QStringList formats() const override;
     QVariant retrieveData(const QString &mimeType, QMetaType preferredType) const override;
+
+    // Keep a format in a memfd instead of memory. Takes ownership of fd.
+    // data() reads the whole memfd back on every call, callers that can work on a file should use spooledFd().
+    void setSpooledData(const QString &mimeType, int fd, qint64 size);
+    // The sealed memfd holding a spooled format, -1 if the format is kept in memory. Owned by the mime data.
+    int spooledFd(const QString &mimeType) const { return m_spooledData.value(mimeType).fd; }
+    // Formats that were offered but not kept because they are too large, with the bytes seen before skipping
+    void addSkippedFormat(const QString &mimeType, qint64 size) { m_skippedFormats.insert(mimeType, size); }
+    QMap<QString, qint64> skippedFormats() const { return m_skippedFormats; }
+
+private:
+    QVariant rawData(const QString &mimeType, QMetaType preferredType) const;
+
+private:
+    struct SpooledData
+    {
+        int fd = -1;
+        qint64 size = 0;
+    };
+    QMap<QString, SpooledData> m_spooledData;
+    QMap<QString, qint64> m_skippedFormats;
 };
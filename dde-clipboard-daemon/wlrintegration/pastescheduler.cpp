@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pastescheduler.h"
+#include "pastetransfer.h"
+#include <QDebug>
+
+static constexpr int DefaultMaxActive = 8;
+static constexpr int DefaultMaxQueued = 64;
+static constexpr int DefaultIdleTimeout = 10000;    // ms
+static constexpr int TimeoutCheckInterval = 1000;   // ms
+
+PasteScheduler::PasteScheduler(QObject *parent)
+    : QObject(parent)
+    , m_maxActive(DefaultMaxActive)
+    , m_maxQueued(DefaultMaxQueued)
+    , m_idleTimeout(DefaultIdleTimeout)
+{
+    m_timeoutTimer.setInterval(TimeoutCheckInterval);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &PasteScheduler::onTimeout);
+}
+
+void PasteScheduler::submit(PasteTransfer *transfer)
+{
+    transfer->setParent(this);
+    connect(transfer, &PasteTransfer::finished, this, [this, transfer](bool ok) {
+        onFinished(transfer, ok);
+    });
+
+    if (m_queue.size() >= m_maxQueued && m_active.size() >= m_maxActive) {
+        qWarning() << "Too many pending pastes, dropped one of" << transfer->size() << "bytes";
+        transfer->abort();
+        return;
+    }
+
+    m_queue.enqueue(transfer);
+    startQueued();
+}
+
+QVariantMap PasteScheduler::stats() const
+{
+    QVariantMap stats;
+    stats.insert(QStringLiteral("active"), m_active.size());
+    stats.insert(QStringLiteral("queued"), m_queue.size());
+    stats.insert(QStringLiteral("completed"), m_completed);
+    stats.insert(QStringLiteral("aborted"), m_aborted);
+    stats.insert(QStringLiteral("bytesServed"), m_bytesServed);
+    return stats;
+}
+
+void PasteScheduler::resetStats()
+{
+    m_completed = 0;
+    m_aborted = 0;
+    m_bytesServed = 0;
+}
+
+void PasteScheduler::onFinished(PasteTransfer *transfer, bool ok)
+{
+    m_active.removeOne(transfer);
+    m_queue.removeOne(transfer);
+    if (ok)
+        ++m_completed;
+    else
+        ++m_aborted;
+    m_bytesServed += transfer->written();
+    transfer->deleteLater();
+
+    if (m_active.isEmpty())
+        m_timeoutTimer.stop();
+    startQueued();
+}
+
+void PasteScheduler::startQueued()
+{
+    while (m_active.size() < m_maxActive && !m_queue.isEmpty()) {
+        PasteTransfer *transfer = m_queue.dequeue();
+        m_active.append(transfer);
+        if (!m_timeoutTimer.isActive())
+            m_timeoutTimer.start();
+        // May finish right away and re-enter through onFinished()
+        transfer->start();
+    }
+}
+
+void PasteScheduler::onTimeout()
+{
+    const QList<PasteTransfer *> active = m_active;
+    for (PasteTransfer *transfer : active) {
+        if (transfer->idleTime() >= m_idleTimeout) {
+            qWarning() << "Paste target stalled after" << transfer->written() << "of" << transfer->size() << "bytes, aborted";
+            transfer->abort();
+        }
+    }
+}
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QQueue>
+#include <QTimer>
+#include <QVariantMap>
+
+class PasteTransfer;
+
+// Runs paste transfers on the event loop instead of one thread per paste.
+// At most maxActive() transfers write at the same time, further ones wait in a bounded queue
+// and are dropped when it is full. A transfer whose target accepts no data for idleTimeout()
+// is aborted, so hung paste targets cannot pile up. Counters are exported through stats().
+class PasteScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PasteScheduler(QObject *parent = nullptr);
+
+    void setMaxActive(int count) { m_maxActive = qMax(1, count); }
+    int maxActive() const { return m_maxActive; }
+    void setMaxQueued(int count) { m_maxQueued = qMax(0, count); }
+    int maxQueued() const { return m_maxQueued; }
+    // Abort a transfer when its target accepts no data for this long (ms)
+    void setIdleTimeout(int msec) { m_idleTimeout = msec; }
+    int idleTimeout() const { return m_idleTimeout; }
+
+    // Takes ownership of the transfer, it is started when a slot is free.
+    // Transfers still pending when the scheduler is deleted close their fds.
+    void submit(PasteTransfer *transfer);
+
+    int activeCount() const { return m_active.size(); }
+    int queuedCount() const { return m_queue.size(); }
+    quint64 completedCount() const { return m_completed; }
+    quint64 abortedCount() const { return m_aborted; }
+    quint64 bytesServed() const { return m_bytesServed; }
+
+    QVariantMap stats() const;
+    void resetStats();
+
+private:
+    void onFinished(PasteTransfer *transfer, bool ok);
+    void startQueued();
+    void onTimeout();
+
+private:
+    int m_maxActive;
+    int m_maxQueued;
+    int m_idleTimeout;
+    QList<PasteTransfer *> m_active;
+    QQueue<PasteTransfer *> m_queue;
+    QTimer m_timeoutTimer;
+
+    quint64 m_completed = 0;
+    quint64 m_aborted = 0;
+    quint64 m_bytesServed = 0;
+};
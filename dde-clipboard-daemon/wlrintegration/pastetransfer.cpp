@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pastetransfer.h"
+#include <QDebug>
+#include <QFile>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+
+static constexpr qint64 ChunkSize = 256 * 1024;
+// Bytes written per wakeup before yielding to the event loop, so one large paste cannot starve other events
+static constexpr qint64 MaxBytesPerWakeup = 4 * 1024 * 1024;
+
+PasteTransfer::PasteTransfer(int fd, QObject *parent)
+    : QObject(parent)
+    , m_fd(fd)
+{
+    const int flags = fcntl(m_fd, F_GETFL);
+    if (flags < 0 || fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        qWarning() << "Cannot make paste fd non-blocking:" << strerror(errno);
+}
+
+PasteTransfer::~PasteTransfer()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+    if (m_sourceFd >= 0)
+        close(m_sourceFd);
+}
+
+void PasteTransfer::setData(const QByteArray &data)
+{
+    m_data = data;
+    m_size = data.size();
+    m_method = Method::Write;
+}
+
+bool PasteTransfer::setFile(const QString &fileName)
+{
+    const int fd = open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    return setSource(fd);
+}
+
+bool PasteTransfer::setFileDescriptor(int fd)
+{
+    // Reads use explicit offsets, sharing the file offset with the original fd is harmless
+    const int dupFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dupFd < 0)
+        return false;
+
+    return setSource(dupFd);
+}
+
+bool PasteTransfer::setSource(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
+
+    if (m_sourceFd >= 0)
+        close(m_sourceFd);
+    m_sourceFd = fd;
+    m_size = st.st_size;
+    m_method = Method::Splice;
+    return true;
+}
+
+void PasteTransfer::start()
+{
+    // Write as much as possible right away, the notifier takes over when the pipe is full
+    m_lastActivity.start();
+    m_notifier = std::make_unique<QSocketNotifier>(m_fd, QSocketNotifier::Write);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &PasteTransfer::onWritable);
+    onWritable();
+}
+
+void PasteTransfer::abort()
+{
+    finish(false);
+}
+
+void PasteTransfer::onWritable()
+{
+    qint64 budget = MaxBytesPerWakeup;
+    while (m_written < m_size && budget > 0) {
+        const ssize_t ret = writeChunk(qMin(ChunkSize, m_size - m_written));
+        if (ret > 0) {
+            m_written += ret;
+            budget -= ret;
+            m_lastActivity.start();
+            continue;
+        }
+
+        if (ret == 0) {
+            qWarning() << "Paste source ended after" << m_written << "of" << m_size << "bytes";
+            finish(false);
+            return;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return;
+
+        qWarning() << "Failed to write pasted data after" << m_written << "bytes:" << strerror(errno);
+        finish(false);
+        return;
+    }
+
+    if (m_written >= m_size)
+        finish(true);
+}
+
+ssize_t PasteTransfer::writeChunk(qint64 chunk)
+{
+    switch (m_method) {
+    case Method::Write:
+        return ::write(m_fd, m_data.constData() + m_written, static_cast<size_t>(chunk));
+    case Method::Splice: {
+        // Move the page cache pages of the file into the pipe without copying them through user space
+        loff_t offset = m_written;
+        const ssize_t ret = splice(m_sourceFd, &offset, m_fd, nullptr, static_cast<size_t>(chunk), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (ret >= 0 || errno != EINVAL)
+            return ret;
+        // The target is not a pipe
+        m_method = Method::SendFile;
+    }
+        Q_FALLTHROUGH();
+    case Method::SendFile: {
+        off_t offset = m_written;
+        const ssize_t ret = sendfile(m_fd, m_sourceFd, &offset, static_cast<size_t>(chunk));
+        if (ret >= 0 || (errno != EINVAL && errno != ENOSYS))
+            return ret;
+        m_method = Method::Copy;
+    }
+        Q_FALLTHROUGH();
+    case Method::Copy: {
+        // Bytes read but not accepted by the target are read again on the next attempt
+        QByteArray buffer(chunk, Qt::Uninitialized);
+        const ssize_t ret = pread(m_sourceFd, buffer.data(), static_cast<size_t>(chunk), m_written);
+        if (ret <= 0)
+            return ret;
+        return ::write(m_fd, buffer.constData(), static_cast<size_t>(ret));
+    }
+    }
+    return -1;
+}
+
+void PasteTransfer::finish(bool ok)
+{
+    if (m_fd < 0)
+        return;
+
+    // The notifier may be the sender of the signal being handled
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        m_notifier.release()->deleteLater();
+    }
+    close(m_fd);
+    m_fd = -1;
+    if (m_sourceFd >= 0) {
+        close(m_sourceFd);
+        m_sourceFd = -1;
+    }
+    m_data = QByteArray();
+
+    Q_EMIT finished(ok);
+}
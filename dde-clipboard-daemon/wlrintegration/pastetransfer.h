@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+
+#include <memory>
+
+// Streams one pasted format into the file descriptor handed over by the compositor.
+// The target fd is switched to non-blocking mode and written in chunks whenever it becomes
+// writable, so a slow paste target never blocks a thread. Data held in memory is written straight
+// from the (implicitly shared) buffer; data kept in a cache file is moved into the target with
+// splice(), falling back to sendfile() and finally to pread()/write(), without loading the file
+// into memory.
+class PasteTransfer : public QObject
+{
+    Q_OBJECT
+public:
+    // Takes ownership of fd
+    explicit PasteTransfer(int fd, QObject *parent = nullptr);
+    ~PasteTransfer() override;
+
+    void setData(const QByteArray &data);
+    // Returns false if the file cannot be opened
+    bool setFile(const QString &fileName);
+    // Sends from a duplicate of fd, the caller keeps ownership of fd. Returns false if it cannot be duplicated
+    bool setFileDescriptor(int fd);
+
+    void start();
+    // Gives up on the transfer, finished(false) is emitted
+    void abort();
+
+    qint64 size() const { return m_size; }
+    qint64 written() const { return m_written; }
+    bool isStarted() const { return m_lastActivity.isValid(); }
+    bool isFinished() const { return m_fd < 0; }
+    // Time since the target last accepted data (ms), -1 if not started
+    qint64 idleTime() const { return isStarted() ? m_lastActivity.elapsed() : -1; }
+
+Q_SIGNALS:
+    // ok is false when the target went away or a write failed
+    void finished(bool ok);
+
+private:
+    enum class Method { Write, Splice, SendFile, Copy };
+
+    bool setSource(int fd);
+    void onWritable();
+    ssize_t writeChunk(qint64 chunk);
+    void finish(bool ok);
+
+private:
+    int m_fd;
+    int m_sourceFd = -1;
+    Method m_method = Method::Write;
+    QByteArray m_data;
+    qint64 m_size = 0;
+    qint64 m_written = 0;
+    QElapsedTimer m_lastActivity;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+};
@@ -5,6 +5,8 @@
 #include "wlrdatacontrolclipboardinterface.h"
 #include "wlrdatacontrolofferintegration.h"
 #include "dwaylandmimedata.h"
+#include "pastetransfer.h"
+#include "../blobmimedata.h"
 #include <private/qwaylandnativeinterface_p.h>
 #include <private/qwaylandintegration_p.h>
 #include <private/qinternalmimedata_p.h>
@@ -12,6 +14,7 @@
 #include <QImageReader>
 #include <QImageWriter>
 #include <QBuffer>
+#include <QSet>
 #include <unistd.h>
 #include <poll.h>
 
@@ -19,15 +22,6 @@ using namespace Qt::StringLiterals;
 
 const QString PrivateMimeSavedForWayland = u"application/x.deepin-clipboard-daemon.saved-for-wayland"_s;
 
-// File descriptor close guard
-class FdGuard {
-public:
-    FdGuard(int fd) : m_fd(fd) {}
-    ~FdGuard() { close(m_fd); }
-private:
-    int m_fd;
-};
-
 // Extra MIME Type Preprocessing
 static QStringList imageMimeFormats(const QList<QByteArray> &imageFormats)
 {
@@ -58,6 +52,12 @@ static QByteArray getByteArray(QMimeData *mimeData, const QString &mimeType)
     } else if (mimeData->hasImage()
                && (mimeType == QLatin1String("application/x-qt-image")
                    || mimeType.startsWith(QLatin1String("image/")))) {
+        // Serve encoded data kept by the mime data as is (e.g. the cached PNG of a history item),
+        // only encode the image when there is none
+        content = mimeData->data(mimeType);
+        if (!content.isEmpty())
+            return content;
+
         QImage image = qvariant_cast<QImage>(mimeData->imageData());
         if (!image.isNull()) {
             QBuffer buf;
@@ -87,8 +87,7 @@ static QByteArray getByteArray(QMimeData *mimeData, const QString &mimeType)
 }
 
 WlrDataControlClipboardInterface::WlrDataControlClipboardInterface(QObject *parent)
-    : QObject{parent}
-    , m_readLock(1)
+    : ClipboardBackend{parent}
 {   
     m_dcManager = std::make_unique<WlrDataControlManagerIntegration>();
 
@@ -96,9 +95,20 @@ WlrDataControlClipboardInterface::WlrDataControlClipboardInterface(QObject *pare
     connect(m_dcManager.get(), &QWaylandClientExtension::activeChanged,
             this, &WlrDataControlClipboardInterface::onActiveChanged);
 
-    // Clipboard read / write completion signal
-    connect(&m_readTaskWatcher, &QFutureWatcher<std::unique_ptr<QMimeData>>::finished,
-            this, &WlrDataControlClipboardInterface::onReadTaskFinished);
+    // Size caps of a single format and of a whole offer can be tuned through environment variables (MB)
+    bool ok = false;
+    const int formatLimit = qEnvironmentVariableIntValue("DDE_CLIPBOARD_FORMAT_LIMIT_MB", &ok);
+    if (ok && formatLimit > 0)
+        m_reader.setFormatLimit(qint64(formatLimit) * 1024 * 1024);
+    const int offerLimit = qEnvironmentVariableIntValue("DDE_CLIPBOARD_OFFER_LIMIT_MB", &ok);
+    if (ok && offerLimit > 0)
+        m_reader.setOfferLimit(qint64(offerLimit) * 1024 * 1024);
+
+    // Clipboard read completion signal
+    connect(&m_reader, &WlrSelectionReader::finished,
+            this, &WlrDataControlClipboardInterface::onReadFinished);
+    connect(&m_reader, &WlrSelectionReader::deferredFinished,
+            this, &WlrDataControlClipboardInterface::pendingFormatsFinished);
 }
 
 const QMimeData *WlrDataControlClipboardInterface::mimeData() const
@@ -114,11 +124,22 @@ void WlrDataControlClipboardInterface::setMimeData(QMimeData *mimeData)
         return;
     }
 
+    // The formats still being read belong to the data that is replaced
+    m_reader.abort();
+
     // Replace MIME data
     m_mimeData = std::unique_ptr<QMimeData>(mimeData);
     takeoverClipboardDataSource();
 }
 
+QDBusUnixFileDescriptor WlrDataControlClipboardInterface::spooledFile(const QString &format) const
+{
+    auto waylandData = qobject_cast<DWaylandMimeData *>(m_mimeData.get());
+    const int fd = waylandData ? waylandData->spooledFd(format) : -1;
+    // The descriptor holds its own duplicate, it stays valid after the mime data is replaced
+    return fd < 0 ? QDBusUnixFileDescriptor() : QDBusUnixFileDescriptor(fd);
+}
+
 void WlrDataControlClipboardInterface::refreshDataControlSourceDevice()
 {
     // Create data control device to monitor clipboard content changes
@@ -137,13 +158,18 @@ void WlrDataControlClipboardInterface::takeoverClipboardDataSource()
             this, &WlrDataControlClipboardInterface::onSourceSend);
 
     // Send MIME type offers
+    QSet<QString> offered;
     for (const QString &format : m_mimeData->formats()) {
         // 如果是application/x-qt-image类型则需要提供image的全部类型, 比如image/png
         if (u"application/x-qt-image"_s == format) {
             for (auto &i : imageReadMimeFormats()) {
-                m_dcSource->offer(i);
+                if (!offered.contains(i)) {
+                    offered.insert(i);
+                    m_dcSource->offer(i);
+                }
             }
-        } else {
+        } else if (!offered.contains(format)) {
+            offered.insert(format);
             m_dcSource->offer(format);
         }
     }
@@ -153,18 +179,10 @@ void WlrDataControlClipboardInterface::takeoverClipboardDataSource()
     m_dcDevice->set_selection(m_dcSource.get()->object());
 }
 
-void WlrDataControlClipboardInterface::abortLastRead()
-{
-    if (m_readTaskFuture.isRunning()) {
-        qWarning() << "An ongoing read was aborted.";
-        m_readTaskFuture.cancel();
-    }
-}
-
 void WlrDataControlClipboardInterface::onDataControlDeviceFinished()
 {
     // Abort an ongoing read, if any
-    abortLastRead();
+    m_reader.abort();
 
     auto waylandIface = static_cast<QtWaylandClient::QWaylandNativeInterface *>(qGuiApp->platformNativeInterface());
     m_dcDevice = std::make_unique<WlrDataControlDeviceIntegration>(m_dcManager->get_data_device(waylandIface->seat()));
@@ -185,10 +203,13 @@ void WlrDataControlClipboardInterface::onNewSelection(WlrDataControlOfferIntegra
         return;
     }
 
+    // Delete offer object automatically
+    auto offerGuard = std::unique_ptr<WlrDataControlOfferIntegration>(offer);
+
     // Filter MIME types.
     auto mimeTypes = QStringList(offer->availableMimeTypes());
 
-    // Detect recursion caused by saving clipboard content (see onReadTaskFinished for explanation)
+    // Detect recursion caused by saving clipboard content (see onReadFinished for explanation)
     if (mimeTypes.contains(PrivateMimeSavedForWayland)) {
         return;
     }
@@ -209,67 +230,14 @@ void WlrDataControlClipboardInterface::onNewSelection(WlrDataControlOfferIntegra
         return;
     }
 
-    // Abort ongoing read if any, wait until it fully stops
-    if (!m_readLock.tryAcquire()) {
-        abortLastRead();
-        m_readLock.acquire();
-    }
-
-    // Stage 3: Start a read.
-    // QMimeData is "not move constructible" so we had to wrap it with a unique_ptr
-    auto result = std::make_unique<DWaylandMimeData>();
-
-    // Delete offer object automatically
-    auto offerGuard = std::unique_ptr<WlrDataControlOfferIntegration>(offer);
-
-    // Auto release semaphore
-    QSemaphoreReleaser semReleaser(m_readLock);
-
-    // Used to force roundtrip
-    auto display = QtWaylandClient::QWaylandIntegration::instance()->display();
-
-    // Read each requested MIME type
-    for (auto i : mimeTypes) {
-        // Open communication pipe
-        int pipefd[2];
-        if (pipe(pipefd) != 0) {
-            // Fail
-            qCritical() << "Failed to create pipe, errno =" << errno;
-            return;
-        }
-
-        // Close pipe read end automatically in case of error
-        FdGuard fdGuard(pipefd[0]);
-
-        // Tell it what MIME type we want, and close our copy of pipe write end
-        offer->receive(i, pipefd[1]);
-        close(pipefd[1]);
-        display->forceRoundTrip(); // FIXME: Sometimes it will deadlock
-
-        // Begin reading from pipe
-        QFile pipeFile;
-        if (!pipeFile.open(pipefd[0], QFile::ReadOnly)) {
-            qWarning() << "Cannot open pipe; error " << pipeFile.errorString();
-            continue;
-        }
-        if (!pipeFile.isReadable()) {
-            qWarning() << "Pipe is not readable; failing.";
-            return;
-        }
+    // Stage 3: Start a read. All formats are received at once and read asynchronously,
+    // a slow or hung source application no longer blocks the daemon. An ongoing read is aborted.
+    m_reader.start(std::move(offerGuard), mimeTypes);
+}
 
-        QByteArray data;
-        constexpr int readLimit = 4096;
-        QByteArray buffer(readLimit, 0);
-        int readCount = 0;
-        do {
-            auto buf = pipeFile.read(readLimit);
-            readCount = buf.size();
-            data.append(buf);
-        } while (readCount == readLimit);
-
-        result->setData(i, data);
-    }
-    m_mimeData = std::move(result);
+void WlrDataControlClipboardInterface::onReadFinished()
+{
+    m_mimeData = m_reader.takeMimeData();
 
     Q_EMIT dataChanged();
 
@@ -290,29 +258,23 @@ void WlrDataControlClipboardInterface::onNewSelection(WlrDataControlOfferIntegra
 #endif
 }
 
-void WlrDataControlClipboardInterface::onReadTaskFinished()
-{
-}
-
 void WlrDataControlClipboardInterface::onSourceSend(QString mimeType, int fd)
 {
-    // Write clipboard Stage 3: dispatch write task.
-    // This should be put into a thread because daemon itself will also reply on reading
-    // the clipboard (design burden)
-    auto _ = QtConcurrent::run([](QByteArray data, int fd){
-        FdGuard fdGuard(fd);
-        QFile fdFile;
-        if (!fdFile.open(fd, QFile::WriteOnly)) {
-            qWarning() << "Cannot open pipe; error:" << fdFile.errorString();
-            return;
-        }
-        if (!fdFile.isWritable()) {
-            qWarning() << "Pipe file is not writable.";
-            return;
-        }
-
-        fdFile.write(data);
-    }, getByteArray(m_mimeData.get(), mimeType), fd);
+    // Write clipboard Stage 3: stream the data into the pipe without blocking.
+    // The daemon itself also reads the clipboard (design burden), so waiting for the reader here
+    // would deadlock. Formats kept in cache files or memfds are sent from the file instead of memory.
+    auto transfer = new PasteTransfer(fd);
+    auto blobData = qobject_cast<BlobMimeData *>(m_mimeData.get());
+    auto waylandData = qobject_cast<DWaylandMimeData *>(m_mimeData.get());
+    const QString file = blobData ? blobData->file(mimeType) : QString();
+    const int spooledFd = waylandData ? waylandData->spooledFd(mimeType) : -1;
+    // Formats the reader kept in a memfd are streamed from it as well
+    const bool streamed = (!file.isEmpty() && transfer->setFile(file))
+            || (spooledFd >= 0 && transfer->setFileDescriptor(spooledFd));
+    if (!streamed)
+        transfer->setData(getByteArray(m_mimeData.get(), mimeType));
+
+    m_pasteScheduler.submit(transfer);
 }
 
 void WlrDataControlClipboardInterface::onSourceCancelled()
@@ -7,23 +7,30 @@
 
 #include <QtConcurrent>
 #include <QSharedPointer>
-#include <QSemaphore>
 
 #include <memory>
 
+#include "../clipboardbackend.h"
 #include "wlrdatacontrolmanagerintegration.h"
 #include "wlrdatacontroldeviceintegration.h"
 #include "wlrdatacontrolsourceintegration.h"
+#include "wlrselectionreader.h"
+#include "pastescheduler.h"
 
-class WlrDataControlClipboardInterface : public QObject
+class WlrDataControlClipboardInterface : public ClipboardBackend
 {
     Q_OBJECT
 public:
     explicit WlrDataControlClipboardInterface(QObject *parent = nullptr);
 
     // R/W interfaces
-    const QMimeData *mimeData() const;
-    void setMimeData(QMimeData *mimeData);
+    const QMimeData *mimeData() const override;
+    void setMimeData(QMimeData *mimeData) override;
+    int protocolType() const override { return WAYLAND_PROTOCOL; }
+    QStringList pendingFormats() const override { return m_reader.pendingFormats(); }
+    QDBusUnixFileDescriptor spooledFile(const QString &format) const override;
+    QVariantMap pasteStats() const override { return m_pasteScheduler.stats(); }
+    void resetPasteStats() override { m_pasteScheduler.resetStats(); }
 
 protected:
     bool managerReady() { return m_dcManager && m_dcManager->isActive(); }
@@ -31,38 +38,31 @@ protected:
 
     void takeoverClipboardDataSource();
 
-    void abortLastRead();
-
 protected slots:
     void onActiveChanged() { refreshDataControlSourceDevice(); }
     void onDataControlDeviceFinished();
 
     // Read clipboard, Stage 2
     void onNewSelection(WlrDataControlOfferIntegration *offer);
-    // Read clipboard, read task finished
-    void onReadTaskFinished();
+    // Read clipboard, all formats are read
+    void onReadFinished();
 
     // Write clipboard, Stage 2
     void onSourceSend(QString mimeType, int fd);
     // Write clipboard (abort signal from compositor)
     void onSourceCancelled();
 
-signals:
-    // Notifies daemon the clipboard content changed
-    void dataChanged();
-
 private:
     // Wayland objects
     std::unique_ptr<WlrDataControlManagerIntegration> m_dcManager;
     std::unique_ptr<WlrDataControlSourceIntegration> m_dcSource;
     std::unique_ptr<WlrDataControlDeviceIntegration> m_dcDevice;
 
-    // Clipboard reading synchronization (used to cancelling reading)
-    QSemaphore m_readLock;
-    QFuture<std::unique_ptr<QMimeData>> m_readTaskFuture;
-    QFutureWatcher<std::unique_ptr<QMimeData>> m_readTaskWatcher;
+    // Asynchronous clipboard reader, a new selection aborts the ongoing read
+    WlrSelectionReader m_reader;
 
-    // Clipboard write doesn't need a synchronization mechanism
+    // Serves paste requests on the event loop with bounded concurrency
+    PasteScheduler m_pasteScheduler;
 
     // Clipboard content read from / written to clipboard
     std::unique_ptr<QMimeData> m_mimeData;
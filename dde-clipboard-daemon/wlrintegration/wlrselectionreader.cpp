@@ -0,0 +1,381 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "wlrselectionreader.h"
+#include "wlrdatacontrolofferintegration.h"
+#include "../mimepolicy.h"
+#include <private/qwaylandintegration_p.h>
+#include <private/qwaylanddisplay_p.h>
+#include <QDebug>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+static constexpr int DefaultFormatTimeout = 2000;   // ms
+static constexpr int DefaultOfferTimeout = 5000;    // ms
+static constexpr qint64 DefaultFormatLimit = 256 * 1024 * 1024;
+static constexpr qint64 DefaultOfferLimit = 512 * 1024 * 1024;
+static constexpr qint64 DefaultSpoolThreshold = 4 * 1024 * 1024;
+static constexpr qint64 MinReadSize = 64 * 1024;
+static constexpr qint64 MaxReadSize = 4 * 1024 * 1024;
+
+WlrSelectionReader::WlrSelectionReader(QObject *parent)
+    : QObject(parent)
+    , m_formatTimeout(DefaultFormatTimeout)
+    , m_offerTimeout(DefaultOfferTimeout)
+    , m_formatLimit(DefaultFormatLimit)
+    , m_offerLimit(DefaultOfferLimit)
+    , m_spoolThreshold(DefaultSpoolThreshold)
+{
+    m_timeoutTimer.setSingleShot(true);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &WlrSelectionReader::onTimeout);
+}
+
+WlrSelectionReader::~WlrSelectionReader()
+{
+    reset();
+}
+
+void WlrSelectionReader::start(std::unique_ptr<WlrDataControlOfferIntegration> offer, const QStringList &mimeTypes)
+{
+    if (isRunning()) {
+        qWarning() << "An ongoing read was aborted.";
+    }
+    reset();
+
+    m_offer = std::move(offer);
+    m_started.start();
+
+    // Receive the formats needed for the preview first, the others are received once they are published.
+    // If none of the formats is known, everything is read in a single phase.
+    QStringList eagerTypes = MimePolicy::eagerFormats(mimeTypes);
+    if (eagerTypes.isEmpty()) {
+        eagerTypes = mimeTypes;
+    } else {
+        for (const QString &mimeType : mimeTypes) {
+            if (!eagerTypes.contains(mimeType))
+                m_deferredTypes.append(mimeType);
+        }
+    }
+
+    receive(eagerTypes);
+    if (m_remaining == 0)
+        reset();
+}
+
+void WlrSelectionReader::abort()
+{
+    if (isRunning()) {
+        qWarning() << "An ongoing read was aborted.";
+    }
+    reset();
+}
+
+QStringList WlrSelectionReader::pendingFormats() const
+{
+    if (!m_deferredPhase || !m_published)
+        return {};
+    return m_deferredTypes;
+}
+
+void WlrSelectionReader::receive(const QStringList &mimeTypes)
+{
+    // Issue every receive request up front, the source application writes all formats in parallel
+    for (const QString &mimeType : mimeTypes) {
+        int pipefd[2];
+        if (pipe2(pipefd, O_CLOEXEC | O_NONBLOCK) != 0) {
+            qCritical() << "Failed to create pipe for" << mimeType << ", errno =" << errno;
+            continue;
+        }
+
+        // Tell it what MIME type we want, and close our copy of pipe write end
+        m_offer->receive(mimeType, pipefd[1]);
+        close(pipefd[1]);
+
+        auto format = std::make_unique<PendingFormat>();
+        format->mimeType = mimeType;
+        format->fd = pipefd[0];
+        format->lastActivity.start();
+        format->notifier = std::make_unique<QSocketNotifier>(pipefd[0], QSocketNotifier::Read);
+        PendingFormat *pending = format.get();
+        connect(format->notifier.get(), &QSocketNotifier::activated, this, [this, pending] {
+            onReadable(*pending);
+        });
+        m_formats.push_back(std::move(format));
+        ++m_remaining;
+    }
+
+    if (m_remaining == 0)
+        return;
+
+    // Send the requests now instead of waiting for the next event loop iteration.
+    // No roundtrip is needed: the data arrives through the pipes.
+    QtWaylandClient::QWaylandIntegration::instance()->display()->flushRequests();
+    scheduleTimeout();
+}
+
+void WlrSelectionReader::onReadable(PendingFormat &format)
+{
+    // Drain everything that is available right now
+    for (;;) {
+        // Read at least 64 KB at a time, or everything the pipe holds
+        int available = 0;
+        if (ioctl(format.fd, FIONREAD, &available) < 0)
+            available = 0;
+        const qint64 chunk = qBound(MinReadSize, qint64(available), MaxReadSize);
+
+        const ssize_t ret = format.spoolFd >= 0 ? readToSpool(format, chunk) : readToBuffer(format, chunk);
+        if (ret > 0) {
+            format.size += ret;
+            m_offerSize += ret;
+            format.lastActivity.start();
+
+            if (format.size > m_formatLimit || m_offerSize > m_offerLimit) {
+                qWarning() << "Format" << format.mimeType << "exceeds the size limit after" << format.size << "bytes, skipped";
+                format.skipped = true;
+                closeFormat(format, false);
+                break;
+            }
+
+            if (format.spoolFd < 0 && format.size > m_spoolThreshold && !startSpool(format))
+                qWarning() << "Cannot spool" << format.mimeType << ", keep reading into memory";
+            continue;
+        }
+
+        if (ret == 0) {
+            closeFormat(format, true);
+            break;
+        }
+
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            qWarning() << "Failed to read" << format.mimeType << ":" << strerror(errno);
+            closeFormat(format, false);
+        }
+        break;
+    }
+
+    if (m_remaining == 0) {
+        finishPhase();
+    } else {
+        scheduleTimeout();
+    }
+}
+
+ssize_t WlrSelectionReader::readToBuffer(PendingFormat &format, qint64 chunk)
+{
+    // Grow geometrically so that large formats are not reallocated for every chunk
+    const qsizetype oldSize = format.data.size();
+    const qsizetype needed = oldSize + chunk;
+    if (format.data.capacity() < needed)
+        format.data.reserve(qMax(needed, format.data.capacity() * 2));
+
+    format.data.resize(needed);
+    const ssize_t ret = ::read(format.fd, format.data.data() + oldSize, static_cast<size_t>(chunk));
+    format.data.resize(oldSize + qMax<ssize_t>(ret, 0));
+    return ret;
+}
+
+ssize_t WlrSelectionReader::readToSpool(PendingFormat &format, qint64 chunk)
+{
+    // Move the pages from the pipe into the memfd without copying them through user space
+    ssize_t ret = splice(format.fd, nullptr, format.spoolFd, nullptr, static_cast<size_t>(chunk), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (ret >= 0 || errno != EINVAL)
+        return ret;
+
+    // splice is not supported between these files, copy through a buffer instead
+    QByteArray buffer(chunk, Qt::Uninitialized);
+    ret = ::read(format.fd, buffer.data(), static_cast<size_t>(chunk));
+    if (ret <= 0)
+        return ret;
+
+    for (ssize_t written = 0; written < ret; ) {
+        const ssize_t n = ::write(format.spoolFd, buffer.constData() + written, static_cast<size_t>(ret - written));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            qWarning() << "Failed to spool" << format.mimeType << ":" << strerror(errno);
+            errno = EIO;
+            return -1;
+        }
+        written += n;
+    }
+    return ret;
+}
+
+bool WlrSelectionReader::startSpool(PendingFormat &format)
+{
+    const int fd = memfd_create("dde-clipboard-spool", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        return false;
+
+    for (qsizetype written = 0; written < format.data.size(); ) {
+        const ssize_t n = ::write(fd, format.data.constData() + written, static_cast<size_t>(format.data.size() - written));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            close(fd);
+            return false;
+        }
+        written += n;
+    }
+
+    format.spoolFd = fd;
+    format.data = QByteArray();
+    return true;
+}
+
+void WlrSelectionReader::onTimeout()
+{
+    const bool offerExpired = m_started.elapsed() >= m_offerTimeout;
+    for (auto &format : m_formats) {
+        if (format->fd < 0)
+            continue;
+
+        if (offerExpired || format->lastActivity.elapsed() >= m_formatTimeout) {
+            qWarning() << "Reading" << format->mimeType << "timed out after" << format->data.size() << "bytes, ignored";
+            closeFormat(*format, false);
+        }
+    }
+
+    if (m_remaining == 0) {
+        finishPhase();
+    } else {
+        scheduleTimeout();
+    }
+}
+
+void WlrSelectionReader::closeFormat(PendingFormat &format, bool ok)
+{
+    if (format.fd < 0)
+        return;
+
+    // The notifier may be the sender of the signal being handled
+    format.notifier->setEnabled(false);
+    format.notifier.release()->deleteLater();
+    close(format.fd);
+    format.fd = -1;
+    format.ok = ok;
+    if (!ok) {
+        // Data that is thrown away does not count towards the offer limit
+        m_offerSize -= format.size;
+        format.data = QByteArray();
+        if (format.spoolFd >= 0) {
+            close(format.spoolFd);
+            format.spoolFd = -1;
+        }
+    }
+    --m_remaining;
+}
+
+void WlrSelectionReader::scheduleTimeout()
+{
+    // Wake up at the earliest deadline of the offer or any format still being read
+    qint64 next = m_offerTimeout - m_started.elapsed();
+    for (const auto &format : m_formats) {
+        if (format->fd >= 0)
+            next = qMin(next, m_formatTimeout - format->lastActivity.elapsed());
+    }
+
+    m_timeoutTimer.start(static_cast<int>(qMax<qint64>(0, next)));
+}
+
+void WlrSelectionReader::finishPhase()
+{
+    if (m_deferredPhase) {
+        // The published mime data may have been replaced in the meantime
+        if (m_published) {
+            addFormats(m_published);
+            qDebug() << "Read" << m_deferredTypes.size() << "deferred formats in" << m_started.elapsed() << "ms";
+        }
+        const bool published = !m_published.isNull();
+        reset();
+        if (published)
+            Q_EMIT deferredFinished();
+        return;
+    }
+
+    auto result = std::make_unique<DWaylandMimeData>();
+    addFormats(result.get());
+    if (result->formats().isEmpty()) {
+        if (!m_deferredTypes.isEmpty()) {
+            // Nothing to preview, fall back to reading the remaining formats before publishing
+            const QStringList deferredTypes = std::exchange(m_deferredTypes, {});
+            m_formats.clear();
+            m_started.start();
+            receive(deferredTypes);
+            if (m_remaining == 0)
+                reset();
+            return;
+        }
+
+        reset();
+        qWarning() << "No format of the selection could be read.";
+        return;
+    }
+
+    qDebug() << "Read" << result->formats().size() << "formats in" << m_started.elapsed() << "ms";
+    m_published = result.get();
+    m_mimeData = std::move(result);
+    m_formats.clear();
+
+    if (m_deferredTypes.isEmpty()) {
+        reset();
+    } else {
+        // The offer stays valid until the next selection, keep receiving the remaining formats
+        m_deferredPhase = true;
+        m_started.start();
+        receive(m_deferredTypes);
+        if (m_remaining == 0)
+            reset();
+    }
+
+    Q_EMIT finished();
+}
+
+void WlrSelectionReader::addFormats(DWaylandMimeData *mimeData)
+{
+    for (const auto &format : m_formats) {
+        if (format->skipped)
+            mimeData->addSkippedFormat(format->mimeType, format->size);
+        if (!format->ok)
+            continue;
+
+        if (format->spoolFd >= 0) {
+            // Nothing writes the memfd any more, seal it so that readers can map it safely
+            if (fcntl(format->spoolFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)
+                qWarning() << "Cannot seal spooled" << format->mimeType << ":" << strerror(errno);
+            // The mime data takes over the memfd
+            mimeData->setSpooledData(format->mimeType, format->spoolFd, format->size);
+            format->spoolFd = -1;
+        } else {
+            format->data.squeeze();
+            mimeData->setData(format->mimeType, format->data);
+        }
+    }
+}
+
+void WlrSelectionReader::reset()
+{
+    m_timeoutTimer.stop();
+    for (auto &format : m_formats) {
+        closeFormat(*format, false);
+        if (format->spoolFd >= 0)
+            close(format->spoolFd);
+    }
+    m_formats.clear();
+    m_remaining = 0;
+    m_offerSize = 0;
+    m_deferredTypes.clear();
+    m_deferredPhase = false;
+    m_published = nullptr;
+
+    // Delete offer object
+    m_offer.reset();
+}
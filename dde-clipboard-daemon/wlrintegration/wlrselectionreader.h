@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMimeData>
+#include <QPointer>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include "dwaylandmimedata.h"
+
+#include <memory>
+#include <vector>
+
+class WlrDataControlOfferIntegration;
+
+// Reads all MIME types of a selection offer concurrently without blocking the GUI thread.
+// Every receive request is issued in one batch, the pipe read ends are non-blocking and watched
+// by socket notifiers, so the capture latency approaches the slowest single format instead of
+// the sum of all formats. A format that stops sending data, or an offer that takes too long as
+// a whole, is given up on instead of freezing the daemon.
+// Formats larger than the spool threshold are moved into a memfd instead of growing in RAM,
+// formats exceeding the byte caps are skipped and recorded in DWaylandMimeData::skippedFormats().
+// Reading happens in two phases: the formats needed for the preview (see MimePolicy) are received
+// first and published with finished(), the remaining formats are received afterwards and added to
+// the published mime data before deferredFinished().
+class WlrSelectionReader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WlrSelectionReader(QObject *parent = nullptr);
+    ~WlrSelectionReader() override;
+
+    // Give up on a format when no data arrives for this long (ms)
+    void setFormatTimeout(int msec) { m_formatTimeout = msec; }
+    int formatTimeout() const { return m_formatTimeout; }
+    // Give up on the remaining formats when the whole offer takes this long (ms)
+    void setOfferTimeout(int msec) { m_offerTimeout = msec; }
+    int offerTimeout() const { return m_offerTimeout; }
+    // Skip a format when it is larger than this (bytes)
+    void setFormatLimit(qint64 bytes) { m_formatLimit = bytes; }
+    qint64 formatLimit() const { return m_formatLimit; }
+    // Skip the formats that push the whole offer over this size (bytes)
+    void setOfferLimit(qint64 bytes) { m_offerLimit = bytes; }
+    qint64 offerLimit() const { return m_offerLimit; }
+    // Move a format into a memfd once it grows larger than this (bytes)
+    void setSpoolThreshold(qint64 bytes) { m_spoolThreshold = bytes; }
+    qint64 spoolThreshold() const { return m_spoolThreshold; }
+
+    // Start reading the given MIME types, aborting an ongoing read. Takes ownership of the offer.
+    void start(std::unique_ptr<WlrDataControlOfferIntegration> offer, const QStringList &mimeTypes);
+    void abort();
+    bool isRunning() const { return m_remaining > 0; }
+
+    // Formats read by the last finished read, in the order they were offered
+    std::unique_ptr<QMimeData> takeMimeData() { return std::move(m_mimeData); }
+    // Deferred formats of the published mime data that are still being read
+    QStringList pendingFormats() const;
+
+Q_SIGNALS:
+    // The preview formats are read, failed or timed out. Not emitted for aborted reads or when nothing could be read.
+    void finished();
+    // The deferred formats are added to the published mime data
+    void deferredFinished();
+
+private:
+    struct PendingFormat
+    {
+        QString mimeType;
+        int fd = -1;
+        bool ok = false;
+        bool skipped = false;
+        qint64 size = 0;            // bytes received so far
+        QByteArray data;
+        int spoolFd = -1;           // memfd holding the data once spooled
+        std::unique_ptr<QSocketNotifier> notifier;
+        QElapsedTimer lastActivity;
+    };
+
+    void receive(const QStringList &mimeTypes);
+    void onReadable(PendingFormat &format);
+    ssize_t readToBuffer(PendingFormat &format, qint64 chunk);
+    ssize_t readToSpool(PendingFormat &format, qint64 chunk);
+    bool startSpool(PendingFormat &format);
+    void onTimeout();
+    void closeFormat(PendingFormat &format, bool ok);
+    void scheduleTimeout();
+    void finishPhase();
+    void addFormats(DWaylandMimeData *mimeData);
+    void reset();
+
+private:
+    int m_formatTimeout;
+    int m_offerTimeout;
+    qint64 m_formatLimit;
+    qint64 m_offerLimit;
+    qint64 m_spoolThreshold;
+
+    std::unique_ptr<WlrDataControlOfferIntegration> m_offer;
+    std::vector<std::unique_ptr<PendingFormat>> m_formats;
+    int m_remaining = 0;
+    QStringList m_deferredTypes;            // formats received after the preview formats
+    bool m_deferredPhase = false;
+    qint64 m_offerSize = 0;
+    QElapsedTimer m_started;
+    QTimer m_timeoutTimer;
+
+    std::unique_ptr<QMimeData> m_mimeData;
+    QPointer<DWaylandMimeData> m_published; // owned by whoever took m_mimeData
+};
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "clipboardmodel.h"
+#include "payloadtransport.h"
+#include "itemcodec.h"
 
 #include <QApplication>
 #include <QPointer>
@@ -11,23 +13,47 @@
 #include <QDBusInterface>
 #include <QDBusReply>
 #include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusServiceWatcher>
 
-ClipboardModel::ClipboardModel(ListView *list, QObject *parent) : QAbstractListModel(parent)
+const int PageSize = 20;    // 每次从daemon获取的记录数
+
+ClipboardModel::ClipboardModel(ListView *list, QObject *parent)
+    : ClipboardModel(list, QDBusConnection::sessionBus(), parent)
+{
+}
+
+ClipboardModel::ClipboardModel(ListView *list, const QDBusConnection &connection, QObject *parent) : QAbstractListModel(parent)
     , m_list(list)
     , m_loaderInter(new ClipboardLoader("org.deepin.dde.ClipboardLoader1",
                                         "/org/deepin/dde/ClipboardLoader1",
-                                        QDBusConnection::sessionBus(), this))
+                                        connection, this))
 {
+    qDBusRegisterMetaType<QList<QByteArray>>();
+
+    // daemon重启后获取断开期间产生的数据
+    QDBusServiceWatcher *watcher = new QDBusServiceWatcher("org.deepin.dde.ClipboardLoader1", connection,
+                                                           QDBusServiceWatcher::WatchForRegistration, this);
+    connect(watcher, &QDBusServiceWatcher::serviceRegistered, this, &ClipboardModel::syncItems);
+
     checkDbusConnect();
 }
 
 void ClipboardModel::clear()
 {
+    // 历史记录由daemon持久化保存，需要同步清除
+    m_loaderInter->ClearItems();
+
     foreach (ItemData *item, m_data) {
         item->deleteLater();
     }
     beginResetModel();
     m_data.clear();
+    m_hashIndex.clear();
+    m_hasMore = false;
+    m_cursorTime = 0;
+    m_cursorId = 0;
     endResetModel();
 
     Q_EMIT dataChanged();
@@ -58,7 +84,8 @@ QVariant ClipboardModel::data(const QModelIndex &index, int role) const
 Qt::ItemFlags ClipboardModel::flags(const QModelIndex &index) const
 {
     if (index.isValid()) {
-        if (m_list != nullptr) m_list->openPersistentEditor(index);
+        // PaintMode下剪切块由ItemDelegate绘制，只有当前剪切块有编辑器
+        if (m_list != nullptr && m_list->renderMode() == ListView::WidgetMode) m_list->openPersistentEditor(index);
         return QAbstractListModel::flags(index) | Qt::ItemIsEditable;
     }
     return QAbstractListModel::flags(index);
@@ -75,8 +102,12 @@ void ClipboardModel::destroy(ItemData *data)
         if (m_data.indexOf(data) == -1) return;
         beginRemoveRows(QModelIndex(), row, row);
         auto item = m_data.takeAt(m_data.indexOf(data));
+        removeFromIndex(item);
         endRemoveRows();
 
+        if (item->id() != 0)
+            m_loaderInter->RemoveItem(item->id());
+
         item->deleteLater();
 
         beginResetModel();
@@ -94,27 +125,38 @@ void ClipboardModel::reborn(ItemData *data)
         return;
     }
 
-    QByteArray buf;
-    QDataStream stream(&buf, QIODevice::WriteOnly);
-    QByteArray iconBuf;
-    stream << data->formatMap()
-           << data->type()
-           << data->urls()
-           << data->imageData().isValid();
-    if (data->imageData().isValid()) {
-        stream << data->imageData();
-    }
-    stream  << data->dataEnabled()
-            << data->text()
-            << data->time()
-            << iconBuf;
+    if (data->hasPayload()) {
+        ItemInfo info;
+        info.m_formatMap = data->formatMap();
+        info.m_type = data->type();
+        info.m_urls = data->urls();
+        info.m_hasImage = data->imageData().isValid();
+        info.m_variantImage = data->imageData();
+        info.m_pixSize = data->pixSize();
+        info.m_enable = data->dataEnabled();
+        info.m_text = data->text();
+        info.m_createTime = data->time();
+        info.m_hash = data->hash();
+        info.m_id = data->id();
+        m_loaderInter->dataReborned(ItemCodec::encode(info));
+    } else {
+        // 界面只保存了预览数据，由daemon直接使用历史记录中的数据设置剪贴板，完整数据不再经过界面
+        if (data->id() == 0) {
+            Q_EMIT dataReborn();
+            return;
+        }
 
-    m_loaderInter->dataReborned(buf);
+        const quint64 id = data->id();
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(m_loaderInter->RebornItem(id), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [id](QDBusPendingCallWatcher *call) {
+            call->deleteLater();
+            if (call->isError())
+                qWarning() << "reborn clipboard item failed:" << id << call->error().message();
+        });
+    }
 
-    beginRemoveRows(QModelIndex(), idx, idx);
-    m_data.removeOne(data);
-    endRemoveRows();
-    data->deleteLater();
+    // daemon在历史记录中置顶同一条记录，重新采集到的数据按指纹去重，界面中只需要置顶，不删除后重新添加
+    promote(data);
 
     Q_EMIT dataReborn();
 }
@@ -127,8 +169,14 @@ void ClipboardModel::checkDbusConnect()
     connect(timer, &QTimer::timeout, this, [ = ] {
         if (m_loaderInter->isValid())
         {
-            connect(m_loaderInter, &ClipboardLoader::dataComing, this, &ClipboardModel::dataComing);
+            connect(m_loaderInter, &ClipboardLoader::itemAdded, this, &ClipboardModel::itemAdded);
             timer->stop();
+
+            // 先获取第一页，其余数据在列表滚动时再获取
+            m_hasMore = true;
+            m_cursorTime = 0;
+            m_cursorId = 0;
+            fetchMore(QModelIndex());
         }
     });
     timer->start();
@@ -136,17 +184,199 @@ void ClipboardModel::checkDbusConnect()
 
 void ClipboardModel::dataComing(const QByteArray &buf)
 {
-    ItemData *item = new ItemData(buf);
+    addItem(new ItemData(buf));
+}
+
+void ClipboardModel::itemAdded(const QByteArray &preview)
+{
+    addItem(ItemData::fromPreview(preview));
+}
+
+void ClipboardModel::fetchFormats(ItemData *data, const QObject *context,
+                                  const std::function<void(const QMap<QString, QByteArray> &)> &callback,
+                                  const QStringList &formats)
+{
+    if (data->hasPayload()) {
+        callback(data->formatMap());
+        return;
+    }
+
+    if (data->id() == 0) {
+        callback(QMap<QString, QByteArray>());
+        return;
+    }
+
+    // 完整数据可能很大，daemon读取缓存文件期间不阻塞界面
+    const quint64 id = data->id();
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(m_loaderInter->FetchItem(id, formats), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, context, [id, callback](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+
+        QDBusPendingReply<QDBusVariant> reply = *call;
+        if (reply.isError()) {
+            qWarning() << "fetch clipboard item failed:" << id << reply.error().message();
+            callback(QMap<QString, QByteArray>());
+            return;
+        }
+
+        // 解码时复制各格式的数据，通过memfd传递的数据在返回前解除映射
+        const PayloadTransport::MappedPayload payload(reply.value());
+        callback(payload.isValid() ? ItemCodec::decode(payload.data()).m_formatMap : QMap<QString, QByteArray>());
+    });
+}
+
+bool ClipboardModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_hasMore && !m_fetching;
+}
+
+void ClipboardModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    // 以daemon返回的最后一条记录为游标获取下一页，期间新增、置顶或删除的数据不影响后面的页
+    m_fetching = true;
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(m_loaderInter->ListItemsBefore(m_cursorTime, m_cursorId, PageSize), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+        m_fetching = false;
+
+        QDBusPendingReply<QList<QByteArray>, qlonglong, qulonglong, bool> reply = *call;
+        if (reply.isError()) {
+            qWarning() << "list clipboard items failed:" << reply.error().message();
+            return;
+        }
+
+        // 清除后返回的旧数据不再添加
+        if (!m_hasMore)
+            return;
+
+        m_cursorTime = reply.argumentAt<1>();
+        m_cursorId = reply.argumentAt<2>();
+        m_hasMore = reply.argumentAt<3>() && m_cursorId != 0;
+        appendItems(reply.argumentAt<0>());
+    });
+}
+
+void ClipboardModel::appendItems(const QList<QByteArray> &previews)
+{
+    QList<ItemData *> items;
+    for (const QByteArray &preview : previews) {
+        ItemData *item = ItemData::fromPreview(preview);
+        if (item->type() == Unknown) {
+            qWarning() << "invalid clipboard item preview, skipped, id:" << item->id();
+            item->deleteLater();
+            continue;
+        }
+
+        // 获取期间新复制的数据可能已经通过itemAdded添加
+        if (item->hash() != 0 && m_hashIndex.contains(item->hash())) {
+            item->deleteLater();
+            continue;
+        }
+
+        if (item->hash() != 0)
+            m_hashIndex.insert(item->hash(), item);
+        connect(item, &ItemData::destroy, this, &ClipboardModel::destroy);
+        connect(item, &ItemData::reborn, this, &ClipboardModel::reborn);
+        connect(item, &ItemData::contentLoaded, this, [this, item] { contentLoaded(item); });
+        items.append(item);
+    }
+
+    if (items.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), m_data.size(), m_data.size() + items.size() - 1);
+    m_data.append(items);
+    endInsertRows();
+
+    Q_EMIT dataChanged();
+}
+
+void ClipboardModel::syncItems()
+{
+    if (m_data.isEmpty() || m_data.first()->id() == 0)
+        return;
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(m_loaderInter->ListItemsSince(m_data.first()->id()), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+
+        QDBusPendingReply<QList<QByteArray>> reply = *call;
+        if (reply.isError()) {
+            qWarning() << "sync clipboard items failed:" << reply.error().message();
+            return;
+        }
+
+        // 返回的数据从新到旧，从旧的开始插入到头部，已有的数据会被置顶
+        const QList<QByteArray> previews = reply.value();
+        for (auto it = previews.crbegin(); it != previews.crend(); ++it)
+            itemAdded(*it);
+    });
+}
+
+void ClipboardModel::addItem(ItemData *item)
+{
     if (item->type() == Unknown) {
         item->deleteLater();
         return;
     }
 
+    // 历史记录中已存在相同内容时，将已有的数据置顶，不再重复保存
+    if (item->hash() != 0) {
+        ItemData *exists = m_hashIndex.value(item->hash());
+        if (exists) {
+            item->deleteLater();
+            promote(exists);
+            return;
+        }
+        m_hashIndex.insert(item->hash(), item);
+    }
+
     beginInsertRows(QModelIndex(), 0, 0);
     connect(item, &ItemData::destroy, this, &ClipboardModel::destroy);
     connect(item, &ItemData::reborn, this, &ClipboardModel::reborn);
+    connect(item, &ItemData::contentLoaded, this, [this, item] { contentLoaded(item); });
     m_data.push_front(item);
     endInsertRows();
 
     Q_EMIT dataChanged();
 }
+
+void ClipboardModel::contentLoaded(ItemData *data)
+{
+    const int row = m_data.indexOf(data);
+    if (row == -1)
+        return;
+
+    // 通知视图重新绘制后台加载完成的剪切块
+    const QModelIndex dataIndex = index(row);
+    Q_EMIT QAbstractListModel::dataChanged(dataIndex, dataIndex);
+}
+
+void ClipboardModel::promote(ItemData *data)
+{
+    int row = m_data.indexOf(data);
+    if (row == -1)
+        return;
+
+    data->setTime(QDateTime::currentDateTime());
+    if (row > 0) {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), 0);
+        m_data.move(row, 0);
+        endMoveRows();
+    }
+
+    // 通知编辑器刷新复制时间
+    const QModelIndex topIndex = index(0);
+    Q_EMIT QAbstractListModel::dataChanged(topIndex, topIndex);
+
+    Q_EMIT dataChanged();
+}
+
+void ClipboardModel::removeFromIndex(ItemData *data)
+{
+    if (data->hash() != 0 && m_hashIndex.value(data->hash()) == data)
+        m_hashIndex.remove(data->hash());
+}
@@ -7,6 +7,8 @@
 
 #include <QAbstractListModel>
 
+#include <functional>
+
 #include "listview.h"
 #include "itemdata.h"
 #include "dbus/clipboardloaderinterface.h"
@@ -24,6 +26,10 @@ class ClipboardModel : public QAbstractListModel
     Q_OBJECT
 public:
     explicit ClipboardModel(ListView *list, QObject *parent = nullptr);
+    /*!
+     * \~chinese \brief 通过connection访问daemon，单元测试传入未连接的总线，不会修改正在运行的daemon中的历史记录
+     */
+    ClipboardModel(ListView *list, const QDBusConnection &connection, QObject *parent = nullptr);
 
     /*!
      * \~chinese \name data
@@ -31,6 +37,18 @@ public:
      * \~chinese \return 返回存放数据的容器
      */
     const QList<ItemData *> data();
+    /*!
+     * \~chinese \name fetchFormats
+     * \~chinese \brief 获取剪切块各格式的原始数据,只有预览数据的剪切块需要从daemon获取。
+     * \~chinese 从daemon获取时不等待回复,数据返回后在GUI线程中调用callback,获取失败时传入空的数据
+     * \~chinese \param data 剪切块数据
+     * \~chinese \param context callback的接收者,销毁后不再调用callback
+     * \~chinese \param callback 获取到数据后调用
+     * \~chinese \param formats 需要的格式,为空表示全部格式
+     */
+    void fetchFormats(ItemData *data, const QObject *context,
+                      const std::function<void(const QMap<QString, QByteArray> &)> &callback,
+                      const QStringList &formats = QStringList());
 
 public Q_SLOTS:
     /*!
@@ -48,7 +66,7 @@ public Q_SLOTS:
     void destroy(ItemData *data);
     /*!
      * \~chinese \name reborn
-     * \~chinese \brief 将当前剪切块的数据删除后,重新插入到第一个.当ItemWidget::mouseDoubleClickEvent事
+     * \~chinese \brief 将当前剪切块的数据重新设置到系统剪贴板,并置顶到第一个.当ItemWidget::mouseDoubleClickEvent事
      * \~chinese 件产生时,ItemData::popTop()函数执行,发送出ItemData::reborn信号,ItemData::reborn信号
      * \~chinese 关联到的槽函数ClipboardModel::reborn被执行
      * \~chinese \param 当前剪切块的数据
@@ -71,11 +89,31 @@ Q_SIGNALS:
 
 private:
     void checkDbusConnect();
+    /*!
+     * \~chinese \name promote
+     * \~chinese \brief 再次复制历史记录中已存在的内容时，将已有的数据置顶并刷新复制时间
+     */
+    void promote(ItemData *data);
+    /*!
+     * \~chinese \name contentLoaded
+     * \~chinese \brief 剪切块的文件图标或缩略图在后台加载完成后，刷新对应的行
+     */
+    void contentLoaded(ItemData *data);
+    void removeFromIndex(ItemData *data);
+    void addItem(ItemData *item);
+    void appendItems(const QList<QByteArray> &previews);
+    void syncItems();
 
 protected:
     int rowCount(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
+    /*!
+     * \~chinese \name fetchMore
+     * \~chinese \brief 历史记录由daemon保存,列表显示或滚动到底部时按页获取预览数据
+     */
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
 protected slots:
     /*!
@@ -83,11 +121,21 @@ protected slots:
      * \~chinese \brief 当系统剪切块中的数据发生改变时,该槽函数被执行
      */
     void dataComing(const QByteArray &buf);
+    /*!
+     * \~chinese \name itemAdded
+     * \~chinese \brief daemon保存新的数据后发送预览数据,该槽函数被执行,完整数据在拖拽、置顶时再获取
+     */
+    void itemAdded(const QByteArray &preview);
 
 private:
     QList<ItemData *> m_data;
+    QHash<quint64, ItemData *> m_hashIndex;     // 内容指纹索引，用于去重
     ListView *m_list;
     ClipboardLoader *m_loaderInter;
+    bool m_hasMore = false;                     // daemon中是否还有没有获取的历史记录
+    qint64 m_cursorTime = 0;                    // 已获取的最后一条历史记录的复制时间和id，下一页从它之后开始
+    quint64 m_cursorId = 0;
+    bool m_fetching = false;
 };
 
 #endif // CLIPBOARDMODEL_H
@@ -33,7 +33,11 @@ inline constexpr int PixmapyStep = 5;
 inline constexpr int ContentMargin = 21;
 inline constexpr int TextContentTopMargin = 20;
 inline constexpr int TextLineSpacing = 8;           //文本行间距
+inline constexpr int TextMaxLines = 4;              //文本剪切块最多显示的行数
 inline constexpr int AnimationTime = 300;           //ms
+inline constexpr int ItemRadius = 8;                //剪切块圆角
+inline constexpr int ItemHoverAlpha = 200;          //悬停时剪切块背景的透明度
+inline constexpr int ItemUnHoverAlpha = 80;
 
 static const QString DBusClipBoardService = "org.deepin.dde.Clipboard1";
 static const QString DBusClipBoardPath = "/org/deepin/dde/Clipboard1";
@@ -47,6 +51,7 @@ static const QString ApplicationXQtImageLiteral QStringLiteral("application/x-qt
 typedef struct {
     QStringList cornerIconList;
     QIcon fileIcon;
+    QString iconPath;       // 图标来自文件时为文件路径，用于区分合成的图标
 } FileIconData;
 
 namespace  Globals {
@@ -43,8 +43,49 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QStringLiteral("dataReborned"), argumentList);
     }
 
+    inline QDBusPendingReply<> RebornItem(qulonglong id)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(id);
+        return asyncCallWithArgumentList(QStringLiteral("RebornItem"), argumentList);
+    }
+
+    inline QDBusPendingReply<> RemoveItem(qulonglong id)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(id);
+        return asyncCallWithArgumentList(QStringLiteral("RemoveItem"), argumentList);
+    }
+
+    inline QDBusPendingReply<> ClearItems()
+    {
+        QList<QVariant> argumentList;
+        return asyncCallWithArgumentList(QStringLiteral("ClearItems"), argumentList);
+    }
+
+    inline QDBusPendingReply<QDBusVariant> FetchItem(qulonglong id, const QStringList &formats)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(id) << QVariant::fromValue(formats);
+        return asyncCallWithArgumentList(QStringLiteral("FetchItem"), argumentList);
+    }
+
+    inline QDBusPendingReply<QList<QByteArray>, qlonglong, qulonglong, bool> ListItemsBefore(qlonglong time, qulonglong id, int count)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(time) << QVariant::fromValue(id) << QVariant::fromValue(count);
+        return asyncCallWithArgumentList(QStringLiteral("ListItemsBefore"), argumentList);
+    }
+
+    inline QDBusPendingReply<QList<QByteArray>> ListItemsSince(qulonglong id)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(id);
+        return asyncCallWithArgumentList(QStringLiteral("ListItemsSince"), argumentList);
+    }
+
 Q_SIGNALS: // SIGNALS
-    void dataComing(const QByteArray &buf);
+    void itemAdded(const QByteArray &preview);
 };
 
 namespace com {
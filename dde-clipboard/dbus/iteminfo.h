@@ -28,9 +28,15 @@ struct ItemInfo {
     QString m_text;
     QDateTime m_createTime;
     QList<FileIconData> m_iconDataList;
+    quint64 m_hash = 0;             // 内容指纹，用于历史记录去重
+    quint64 m_id = 0;               // 在daemon保存的历史记录中的id
+    QMap<QString, QString> m_blobFiles; // daemon历史记录中单独保存的格式 -> 缓存文件，这些格式在m_formatMap中的数据为空
 };
 
 Q_DECLARE_METATYPE(ItemInfo)
 
+const quint8 ItemPreviewVersion = 1;    // 预览数据的格式版本
+const int PreviewTextLength = 1024;     // 预览数据中最多保留的文本长度
+
 #endif //ITEMINFO_H
 
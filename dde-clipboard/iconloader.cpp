@@ -0,0 +1,311 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "iconloader.h"
+#include "itemdata.h"
+#include "itemwidget.h"
+
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QDir>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QMimeDatabase>
+#include <QScopedPointer>
+#include <QDebug>
+
+#include "dgiofile.h"
+#include "dgiofileinfo.h"
+
+// 多个线程同时查询，一个慢速挂载点上的文件不会挡住其他文件
+const int IconLoaderThreadCount = 4;
+// 缓存的缩略图最多占用16MB，以KB计算
+const int IconCacheCost = 16 * 1024;
+// 多个文件时最多显示的图标数量
+const int MaxFileIcons = 3;
+// freedesktop缩略图规范中large缩略图的最大边长
+const int LargeThumbnailSize = 256;
+
+IconLoader *IconLoader::instance()
+{
+    static IconLoader *loader = new IconLoader;
+    return loader;
+}
+
+IconLoader::IconLoader(QObject *parent)
+    : QObject(parent)
+    , m_cache(IconCacheCost)
+{
+    m_pool.setMaxThreadCount(IconLoaderThreadCount);
+    m_pool.setObjectName(QStringLiteral("ClipboardIconLoader"));
+}
+
+IconLoader::~IconLoader()
+{
+    for (auto &task : m_tasks)
+        task.future.cancel();
+    m_pool.waitForDone();
+}
+
+void IconLoader::request(ItemData *data)
+{
+    if (!data || data->urls().isEmpty() || m_tasks.contains(data))
+        return;
+
+    // 单个文件时与ItemWidget一致，图片文件显示缩略图
+    const bool thumbnail = data->urls().size() == 1;
+    const QList<QUrl> urls = data->urls().mid(0, thumbnail ? 1 : MaxFileIcons);
+
+    Task task;
+    task.id = m_nextId++;
+    task.future = QtConcurrent::run(&m_pool, [this, urls, thumbnail](QPromise<QList<FileIconInfo>> &promise) {
+        load(promise, urls, thumbnail);
+    });
+    task.destroyed = connect(data, &QObject::destroyed, this, [this, data] {
+        cancel(data);
+    });
+    m_tasks.insert(data, task);
+
+    const quint64 id = task.id;
+    auto watcher = new QFutureWatcher<QList<FileIconInfo>>(this);
+    connect(watcher, &QFutureWatcher<QList<FileIconInfo>>::finished, this, [this, watcher, data, id] {
+        onTaskFinished(data, id);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(task.future);
+}
+
+void IconLoader::cancel(ItemData *data)
+{
+    auto it = m_tasks.find(data);
+    if (it == m_tasks.end())
+        return;
+
+    it->future.cancel();
+    disconnect(it->destroyed);
+    m_tasks.erase(it);
+}
+
+void IconLoader::onTaskFinished(ItemData *data, quint64 id)
+{
+    // 已经被取消或被新的请求替换
+    auto it = m_tasks.find(data);
+    if (it == m_tasks.end() || it->id != id)
+        return;
+
+    const Task task = it.value();
+    disconnect(task.destroyed);
+    m_tasks.erase(it);
+
+    if (task.future.isCanceled() || task.future.resultCount() == 0)
+        return;
+
+    const QList<FileIconInfo> infos = task.future.result();
+    if (infos.isEmpty())
+        return;
+
+    // 与ItemWidget::setThumnail、setFileIcon、setFileIcons保存的内容一致
+    if (data->urls().size() == 1) {
+        const FileIconInfo &info = infos.first();
+        if (!info.thumbnail.isNull()) {
+            data->setPixmap(QPixmap::fromImage(info.thumbnail));
+        } else {
+            data->saveFileIcons(QList<QPixmap>() << Globals::pixmapScaled(ItemWidget::GetFileIcon(iconData(info))));
+        }
+    } else {
+        QList<QPixmap> pixmapList;
+        for (const FileIconInfo &info : infos)
+            pixmapList << ItemWidget::GetFileIcon(iconData(info));
+        data->saveFileIcons(pixmapList);
+    }
+
+    Q_EMIT data->contentLoaded();
+}
+
+void IconLoader::load(QPromise<QList<FileIconInfo>> &promise, const QList<QUrl> &urls, bool thumbnail)
+{
+    QList<FileIconInfo> infos;
+    for (const QUrl &url : urls) {
+        if (promise.isCanceled())
+            return;
+        infos << loadFile(thumbnail ? url.path() : url.toLocalFile(), thumbnail);
+    }
+
+    promise.addResult(infos);
+}
+
+FileIconInfo IconLoader::loadFile(const QString &path, bool thumbnail)
+{
+    // 文件被修改后重新获取
+    const QString key = QString("%1\n%2\n%3").arg(path)
+                        .arg(QFileInfo(path).lastModified().toMSecsSinceEpoch())
+                        .arg(thumbnail);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const FileIconInfo *info = m_cache.object(key))
+            return *info;
+    }
+
+    FileIconInfo info;
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile(path);
+    if (thumbnail && mime.name().startsWith("image/")) { //如果文件是图片,提供缩略图
+        // 只需要显示大小的缩略图，考虑高分屏多保留一倍
+        info.thumbnail = loadThumbnail(path, QSize(PixmapWidth, PixmapHeight) * 2);
+        if (info.thumbnail.isNull())
+            info.iconName = mime.genericIconName();
+    } else {
+        info = queryFileIcon(path);
+    }
+
+    QMutexLocker locker(&m_cacheMutex);
+    m_cache.insert(key, new FileIconInfo(info), int(info.thumbnail.sizeInBytes() / 1024) + 1);
+    return info;
+}
+
+QImage IconLoader::loadThumbnail(const QString &path, const QSize &bound)
+{
+    const QFileInfo fileInfo(path);
+    const QString uri = QUrl::fromLocalFile(fileInfo.absoluteFilePath()).toString(QUrl::FullyEncoded);
+    const QString name = QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Md5).toHex() + ".png";
+    const QString mtime = QString::number(fileInfo.lastModified().toSecsSinceEpoch());
+    const QString thumbnailDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/thumbnails";
+
+    // 优先使用文件管理器等生成的缩略图，只读取PNG头部的信息判断是否有效，修改时间不一致说明文件已经被修改
+    for (const char *flavor : {"large", "normal"}) {
+        QImageReader reader(QString("%1/%2/%3").arg(thumbnailDir, QLatin1String(flavor), name));
+        if (reader.text("Thumb::MTime") != mtime || reader.text("Thumb::URI") != uri)
+            continue;
+
+        const QImage image = reader.read();
+        if (!image.isNull())
+            return image;
+    }
+
+    // 按显示大小解码，JPEG等格式可以直接以较低的分辨率解码，避免大图片占用大量内存。
+    // 写回的large缩略图长边需要达到256，正方形和竖向图片按显示大小解码时达不到，解码时至少保留256x256
+    const QSize decodeBound = bound.expandedTo(QSize(LargeThumbnailSize, LargeThumbnailSize));
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    const QSize size = reader.size();
+    if (size.isValid() && (size.width() > decodeBound.width() || size.height() > decodeBound.height()))
+        reader.setScaledSize(size.scaled(decodeBound, Qt::KeepAspectRatio));
+
+    QImage image = reader.read();
+    if (image.isNull())
+        return image;
+
+    // 源图片比缩略图还小时解码很快，不需要保存，缩略图目录中的文件也不再生成缩略图
+    if (size.isValid() && qMax(size.width(), size.height()) > LargeThumbnailSize
+            && qMax(image.width(), image.height()) >= LargeThumbnailSize
+            && !fileInfo.absoluteFilePath().startsWith(thumbnailDir + '/')) {
+        saveThumbnail(image, QString("%1/large/%2").arg(thumbnailDir, name), uri, mtime, fileInfo.size());
+    }
+
+    if (image.width() > bound.width() || image.height() > bound.height())
+        image = image.scaled(bound, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    return image;
+}
+
+void IconLoader::saveThumbnail(const QImage &image, const QString &target, const QString &uri, const QString &mtime, qint64 size)
+{
+    // 规范要求缩略图目录只有所有者可以访问
+    const QFileDevice::Permissions dirPermissions = QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner;
+    const QDir largeDir = QFileInfo(target).absoluteDir();
+    if (!largeDir.exists()) {
+        const QString thumbnailDir = QFileInfo(largeDir.absolutePath()).absolutePath();
+        const bool created = !QFileInfo::exists(thumbnailDir);
+        if (!QDir().mkpath(largeDir.absolutePath()))
+            return;
+        if (created)
+            QFile::setPermissions(thumbnailDir, dirPermissions);
+        QFile::setPermissions(largeDir.absolutePath(), dirPermissions);
+    }
+
+    QImage thumbnail = image;
+    if (thumbnail.width() > LargeThumbnailSize || thumbnail.height() > LargeThumbnailSize)
+        thumbnail = thumbnail.scaled(LargeThumbnailSize, LargeThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    // 先写入临时文件再重命名，其他程序不会读到写了一半的缩略图
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QImageWriter writer(&file, "png");
+    writer.setText("Thumb::URI", uri);
+    writer.setText("Thumb::MTime", mtime);
+    writer.setText("Thumb::Size", QString::number(size));
+    writer.setText("Software", "dde-clipboard");
+    if (!writer.write(thumbnail)) {
+        qWarning() << "write thumbnail failed:" << target << writer.errorString();
+        file.cancelWriting();
+        return;
+    }
+
+    if (file.commit())
+        QFile::setPermissions(target, QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+}
+
+QList<QPixmap> IconLoader::placeholders(const QList<QUrl> &urls)
+{
+    QList<QPixmap> pixmapList;
+    QMimeDatabase db;
+    const int iconNum = urls.size() == 1 ? 1 : MIN(MaxFileIcons, urls.size());
+    for (int i = 0; i < iconNum; ++i) {
+        const QMimeType mime = db.mimeTypeForFile(urls[i].path(), QMimeDatabase::MatchExtension);
+        pixmapList << QIcon::fromTheme(mime.iconName(), QIcon::fromTheme(mime.genericIconName())).pixmap(FileIconWidth, FileIconWidth);
+    }
+    return pixmapList;
+}
+
+FileIconInfo IconLoader::queryFileIcon(const QString &path)
+{
+    FileIconInfo info;
+    QFileInfo fileInfo(path);
+    if (!fileInfo.exists()) {
+        QMimeDatabase db;
+        info.iconName = db.mimeTypeForFile(path).genericIconName();
+        return info;
+    }
+
+    QScopedPointer<DGioFile> file(DGioFile::createFromPath(fileInfo.absoluteFilePath()));
+    QExplicitlySharedDataPointer<DGioFileInfo> gioInfo = file->createFileInfo();
+    if (!gioInfo)
+        return info;
+
+    const QStringList icons = gioInfo->themedIconNames();
+    info.iconName = icons.isEmpty() ? gioInfo->iconString() : icons.first();
+
+    //get additional icons
+    if (fileInfo.isSymLink())
+        info.cornerIcons << "emblem-symbolic-link";
+
+    if (!fileInfo.isWritable())
+        info.cornerIcons << "emblem-readonly";
+
+    if (!fileInfo.isReadable())
+        info.cornerIcons << "emblem-unreadable";
+
+    //if info is shared()  add icon "emblem-shared"(code from 'dde-file-manager')
+
+    return info;
+}
+
+FileIconData IconLoader::iconData(const FileIconInfo &info)
+{
+    FileIconData data;
+    data.cornerIconList = info.cornerIcons;
+    if (info.iconName.startsWith('/')) {
+        data.fileIcon = QIcon(info.iconName);
+        data.iconPath = info.iconName;
+    } else if (!info.iconName.isEmpty()) {
+        data.fileIcon = QIcon::fromTheme(info.iconName);
+    }
+    return data;
+}
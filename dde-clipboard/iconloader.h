@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ICONLOADER_H
+#define ICONLOADER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QFuture>
+#include <QPromise>
+#include <QPointer>
+#include <QCache>
+#include <QMutex>
+#include <QImage>
+#include <QHash>
+
+#include "constants.h"
+
+class ItemData;
+
+/*!
+ * \~chinese \brief 工作线程中获取的单个文件的显示内容，不含QPixmap、QIcon，由GUI线程生成图片
+ */
+struct FileIconInfo
+{
+    QImage thumbnail;               // 图片文件的缩略图，为空时显示图标
+    QString iconName;               // 主题图标名称或图标文件路径
+    QStringList cornerIcons;        // 角标图标名称
+};
+
+/*!
+ * \~chinese \class IconLoader
+ * \~chinese \brief 文件类型剪切块的图标和缩略图加载服务。
+ * \~chinese 文件查询、读取和解码都在线程池中完成，避免网络文件系统上的文件卡住界面，
+ * \~chinese 结果以文件路径加修改时间为键缓存。加载完成后保存到ItemData中并发出ItemData::contentLoaded信号，
+ * \~chinese 加载期间显示根据文件名得到的占位图标。
+ */
+class IconLoader : public QObject
+{
+    Q_OBJECT
+public:
+    static IconLoader *instance();
+    ~IconLoader() override;
+
+    /*!
+     * \~chinese \name request
+     * \~chinese \brief 在后台加载剪切块中文件的图标或缩略图，已经在加载中的不会重复请求
+     */
+    void request(ItemData *data);
+    /*!
+     * \~chinese \name cancel
+     * \~chinese \brief 取消剪切块的加载请求，已经开始查询的文件会在查询完成后停止
+     */
+    void cancel(ItemData *data);
+    bool isLoading(ItemData *data) const { return m_tasks.contains(data); }
+
+    /*!
+     * \~chinese \name placeholders
+     * \~chinese \brief 只根据文件名获取的占位图标，不访问文件
+     */
+    static QList<QPixmap> placeholders(const QList<QUrl> &urls);
+    /*!
+     * \~chinese \name queryFileIcon
+     * \~chinese \brief 查询文件的图标和角标，会访问文件系统，可以在工作线程中调用
+     */
+    static FileIconInfo queryFileIcon(const QString &path);
+    /*!
+     * \~chinese \name iconData
+     * \~chinese \brief 在GUI线程中将查询结果转换为图标数据
+     */
+    static FileIconData iconData(const FileIconInfo &info);
+    /*!
+     * \~chinese \name loadThumbnail
+     * \~chinese \brief 获取图片文件的缩略图，可以在工作线程中调用。
+     * \~chinese 先按freedesktop缩略图规范查找~/.cache/thumbnails中已有的缩略图，没有时按bound缩小解码，
+     * \~chinese 并将结果写回large缩略图
+     */
+    static QImage loadThumbnail(const QString &path, const QSize &bound);
+
+private:
+    explicit IconLoader(QObject *parent = nullptr);
+
+    void load(QPromise<QList<FileIconInfo>> &promise, const QList<QUrl> &urls, bool thumbnail);
+    FileIconInfo loadFile(const QString &path, bool thumbnail);
+    static void saveThumbnail(const QImage &image, const QString &target, const QString &uri, const QString &mtime, qint64 size);
+    void onTaskFinished(ItemData *data, quint64 id);
+
+private:
+    struct Task {
+        quint64 id = 0;                             // 同一剪切块取消后重新请求时区分新旧任务
+        QFuture<QList<FileIconInfo>> future;
+        QMetaObject::Connection destroyed;
+    };
+
+    QThreadPool m_pool;
+    quint64 m_nextId = 1;
+    QHash<ItemData *, Task> m_tasks;
+
+    QMutex m_cacheMutex;                            // 缓存在工作线程中访问
+    QCache<QString, FileIconInfo> m_cache;          // 键为文件路径、修改时间和是否需要缩略图
+};
+
+#endif // ICONLOADER_H
@@ -4,11 +4,11 @@
 
 #include "itemdata.h"
 #include "constants.h"
+#include "itemcodec.h"
 
 #include <QDebug>
 #include <QApplication>
 #include <QWidget>
-#include <QDataStream>
 
 #include <QLabel>
 #include <QFontMetrics>
@@ -22,51 +22,10 @@ static inline QString applicationXQtImageLiteral() { return QStringLiteral("appl
 
 static constexpr int RESERVED_WIDTH_FOR_TEXT = ItemWidth - ContentMargin * 2;
 
-ItemInfo Buf2Info(const QByteArray &buf)
-{
-    QByteArray tempBuf = buf;
-
-    ItemInfo info;
-
-    QDataStream stream(&tempBuf, QIODevice::ReadOnly);
-    stream.setVersion(QDataStream::Qt_5_11);
-    int type;
-    QByteArray iconBuf;
-    stream >> info.m_formatMap
-           >> type
-           >> info.m_urls
-           >> info.m_hasImage;
-    if (info.m_hasImage) {
-        stream >> info.m_variantImage;
-        stream >> info.m_pixSize;
-    }
-
-    stream >> info.m_enable
-           >> info.m_text
-           >> info.m_createTime
-           >> iconBuf;
-
-    QDataStream stream2(&iconBuf, QIODevice::ReadOnly);
-    stream2.setVersion(QDataStream::Qt_5_11);
-    for (int i = 0 ; i < info.m_urls.size(); ++i) {
-        FileIconData data;
-        stream2 >> data.cornerIconList >> data.fileIcon;
-        if (data.fileIcon.isNull()) {
-            continue;
-        }
-        info.m_iconDataList.push_back(data);
-    }
-
-    info.m_type = static_cast<DataType>(type);
-
-    return info;
-}
-
 ItemData::ItemData(const QByteArray &buf)
 {
     // get
-    ItemInfo info;
-    info = Buf2Info(buf);
+    const ItemInfo info = ItemCodec::decode(buf, ItemCodec::FileIcons);
 
     // convert
     QStringList formats = info.m_formatMap.keys();
@@ -100,27 +59,98 @@ ItemData::ItemData(const QByteArray &buf)
 
     m_createTime = QDateTime::currentDateTime();
     m_enable = true;
+    m_hash = info.m_hash;
+    m_id = info.m_id;
     m_iconDataList = info.m_iconDataList;
     m_formatMap = info.m_formatMap;
-    QString textBefore = m_text.replace("\n"," ");
-    QFont font = DFontSizeManager::instance()->t8();
-    QFontMetrics fontMetrics(font);
-    while (!textBefore.isEmpty()) {
-        int index = 0;
-        while (true) {
-            if (fontMetrics.horizontalAdvance(textBefore.left(index + 1)) > RESERVED_WIDTH_FOR_TEXT) {
-                m_text_list.push_back(textBefore.left(index));
-                textBefore.remove(0, index);
-                break;
-            }
-            index += 1;
-            if (index == textBefore.length()) {
-                m_text_list.push_back(textBefore);
-                textBefore.clear();
-                break;
-            }
-        }
+    m_textLength = m_text.length();
+}
+
+ItemData *ItemData::fromPreview(const QByteArray &preview)
+{
+    ItemData *data = new ItemData;
+    data->m_hasPayload = false;
+
+    ItemInfo info;
+    qint64 textLength = 0;
+    if (!ItemCodec::decodePreview(preview, info, &textLength, ItemCodec::FileIcons))
+        return data;
+
+    const int type = info.m_type;
+    data->m_id = info.m_id;
+    data->m_hash = info.m_hash;
+    data->m_urls = info.m_urls;
+    data->m_variantImage = info.m_variantImage;
+    data->m_pixSize = info.m_pixSize;
+    data->m_text = info.m_text;
+    data->m_createTime = info.m_createTime;
+
+    switch (type) {
+    case Image:
+        if (data->m_variantImage.isNull())
+            return data;
+        break;
+    case File:
+        if (data->m_urls.isEmpty())
+            return data;
+        break;
+    case Text:
+        if (data->m_text.isEmpty())
+            return data;
+        break;
+    default:
+        return data;
     }
+
+    data->m_type = static_cast<DataType>(type);
+    data->m_enable = true;
+    data->m_textLength = textLength;
+    data->m_iconDataList = info.m_iconDataList;
+    return data;
+}
+
+QStringList ItemData::get_text() const
+{
+    // 字体大小可能被DFontSizeManager修改,每次按当前字体取缓存,字体变化后重新折行
+    return textLines(DFontSizeManager::instance()->t8(), RESERVED_WIDTH_FOR_TEXT);
+}
+
+QStringList ItemData::textLines(const QFont &font, int width) const
+{
+    const QString fontKey = font.key();
+    if (m_textLinesWidth == width && m_textLinesFont == fontKey)
+        return m_textLines;
+
+    m_textLines.clear();
+    m_textLinesFont = fontKey;
+    m_textLinesWidth = width;
+    if (m_text.isEmpty() || width <= 0)
+        return m_textLines;
+
+    // 最后一行显示时会拼接下一行再省略,所以多折一行;每个字符至少占一个像素,
+    // 可显示的字符数不会超过行数乘以宽度,只需要处理这部分前缀
+    const int maxLines = TextMaxLines + 1;
+    QString text = m_text.left(qsizetype(maxLines) * width);
+    text.replace('\n', ' ');
+
+    QTextOption option;
+    option.setWrapMode(QTextOption::WrapAnywhere);
+
+    QTextLayout layout(text, font);
+    layout.setTextOption(option);
+    layout.setCacheEnabled(false);
+    layout.beginLayout();
+    while (m_textLines.size() < maxLines) {
+        QTextLine line = layout.createLine();
+        if (!line.isValid())
+            break;
+
+        line.setLineWidth(width);
+        m_textLines << text.mid(line.textStart(), line.textLength());
+    }
+    layout.endLayout();
+
+    return m_textLines;
 }
 
 QString ItemData::title()
@@ -143,7 +173,7 @@ QString ItemData::subTitle()
     case Image:
         return "";
     case Text:
-        return QString(tr("%1 characters")).arg(m_text.length());
+        return QString(tr("%1 characters")).arg(m_textLength);
     case File:
         return "";
     default:
@@ -161,6 +191,11 @@ const QDateTime &ItemData::time()
     return m_createTime;
 }
 
+void ItemData::setTime(const QDateTime &time)
+{
+    m_createTime = time;
+}
+
 const QString &ItemData::text()
 {
     return m_text;
@@ -217,7 +252,7 @@ QSize ItemData::sizeHint(int fontHeight)
 int ItemData::itemHeight(int fontHeight)
 {
     if (m_type == Text) {
-        auto length = m_text_list.length() > 4 ? 4 : m_text_list.length();
+        const int length = qMin(int(get_text().length()), TextMaxLines);
         return length * fontHeight + (length - 1) * TextLineSpacing + ItemTitleHeight + ItemStatusBarHeight + TextContentTopMargin;
     }
     return ItemHeight;
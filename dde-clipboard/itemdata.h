@@ -25,6 +25,10 @@ class ItemData : public QObject
     Q_OBJECT
 public:
     explicit ItemData(const QByteArray &buf);
+    /*!
+     * \~chinese \brief 根据daemon发送的预览数据创建剪切块，不包含各格式的原始数据，需要时通过id获取
+     */
+    static ItemData *fromPreview(const QByteArray &preview);
 
     /*!
      * \~chinese \brief 提供剪切块属性的接口
@@ -33,10 +37,13 @@ public:
     QString subTitle();                         // 字符数，像素信息，文件名称（多个文件显示XXX等X个文件）
     const QList<QUrl> &urls();                  // 文件链接
     const QDateTime &time();                    // 复制时间
+    void setTime(const QDateTime &time);
     const QString &text();                      // 内容预览
-    QStringList get_text() const {
-        return m_text_list;
-    };
+    QStringList get_text() const;               // 按当前字体折行后的预览文本
+    /*!
+     * \~chinese \brief 按指定字体和宽度折行，只处理可显示行数对应的前缀，结果按字体和宽度缓存
+     */
+    QStringList textLines(const QFont &font, int width) const;
     QSize sizeHint(int height);
 
     int itemHeight(int fontHeight);
@@ -48,10 +55,13 @@ public:
     const DataType &type() {return m_type;}
     const QVariant &imageData();
     const QMap<QString, QByteArray> &formatMap();
+    bool hasPayload() const { return m_hasPayload; } //是否包含各格式的原始数据
     void saveFileIcons(const QList<QPixmap> &list);
     const QList<QPixmap> &FileIcons();          //IconDataList没有数据时再使用FileIcons
     const QList<FileIconData> &IconDataList();  //优先使用IconDataList
     const QSize &pixSize() const;               //返回m_variantImage中pixmap原始size
+    quint64 hash() const { return m_hash; }     //内容指纹,为0表示未知
+    quint64 id() const { return m_id; }         //历史记录中的id,为0表示未保存
 
     void remove();
     void popTop();
@@ -71,6 +81,14 @@ Q_SIGNALS:
      * \~chinese \param data 需要置顶的数据
      */
     void reborn(ItemData *data);
+    /*!
+     * \~chinese \name contentLoaded
+     * \~chinese \brief 文件的图标或缩略图由IconLoader在后台加载完成并保存后发出,显示的剪切块需要刷新内容
+     */
+    void contentLoaded();
+
+private:
+    ItemData() = default;
 
 private:
     QMap<QString, QByteArray> m_formatMap;
@@ -79,11 +97,18 @@ private:
     QVariant m_variantImage;
     QSize m_pixSize;
     QString m_text;
-    QStringList m_text_list;
-    bool m_enable;
+    qsizetype m_textLength = 0;
+    mutable QStringList m_textLines;            // 折行结果缓存
+    mutable QString m_textLinesFont;            // 缓存对应的字体,QFont::key()
+    mutable int m_textLinesWidth = -1;          // 缓存对应的宽度
+    bool m_enable = false;
+    bool m_hasPayload = true;
     QDateTime m_createTime;
+    quint64 m_hash = 0;
+    quint64 m_id = 0;
     QList<FileIconData> m_iconDataList;
     QPixmap m_thumnail;
     QList<QPixmap> m_fileIcons;
 };
+
 #endif // ITEMDATA_H
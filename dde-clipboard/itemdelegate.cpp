@@ -4,38 +4,70 @@
 
 #include "itemdelegate.h"
 #include "itemwidget.h"
+#include "itemoverlay.h"
+#include "iconloader.h"
+#include "listview.h"
+#include "pixmaplabel.h"
+#include "constants.h"
 
 #include <QPointer>
 #include <QDebug>
 #include <QEvent>
 #include <QKeyEvent>
 #include <QApplication>
+#include <QPainter>
+#include <QPainterPath>
+
+#include <DFontSizeManager>
 
 DWIDGET_USE_NAMESPACE
 
+static constexpr int RowCacheSize = 32 * 1024 * 1024;   // 绘制内容的缓存最多占用32MB，按图片大小计算
+
+static bool isPaintMode(const QStyleOptionViewItem &option)
+{
+    const ListView *view = qobject_cast<const ListView *>(option.widget);
+    return view && view->renderMode() == ListView::PaintMode;
+}
+
 ItemDelegate::ItemDelegate(QObject *parent)
     : QStyledItemDelegate(parent)
+    , m_cache(RowCacheSize)
 {
 
 }
 
 void ItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
-    Q_UNUSED(painter);
-    Q_UNUSED(option);
-    Q_UNUSED(index);
-    return;
+    if (!isPaintMode(option))
+        return;
+
+    QPointer<ItemData> data = index.data().value<QPointer<ItemData>>();
+    if (data)
+        paintItem(painter, option, data);
 }
 
 QWidget *ItemDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
-    Q_UNUSED(option);
     QPointer<ItemData> data = index.data().value<QPointer<ItemData>>();
-    ItemWidget *w = new ItemWidget(data, parent);
+    QWidget *w = nullptr;
+    if (isPaintMode(option)) {
+        w = new ItemOverlay(data, parent);
+    } else {
+        w = new ItemWidget(data, parent);
+    }
     w->installEventFilter(parent);
     return w;
 }
 
+void ItemDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+    ItemWidget *w = qobject_cast<ItemWidget *>(editor);
+    QPointer<ItemData> data = index.data().value<QPointer<ItemData>>();
+    if (w && data)
+        w->setCreateTime(data->time());
+}
+
 QSize ItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
     QPointer<ItemData> data = index.data().value<QPointer<ItemData>>();
@@ -71,3 +103,125 @@ bool ItemDelegate::eventFilter(QObject *obj, QEvent *event)
 
     return false;
 }
+
+void ItemDelegate::paintItem(QPainter *painter, const QStyleOptionViewItem &option, ItemData *data) const
+{
+    const QRect rect(option.rect.x() + ItemMargin, option.rect.y(), ItemWidth, data->itemHeight(option.fontMetrics.height()));
+    // 当前剪切块上有ItemOverlay，标题栏右侧显示关闭按钮
+    const bool hover = option.state & QStyle::State_Selected;
+    const RowCache cache = rowCache(option, data);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(Qt::NoPen);
+
+    //与ItemWidget::paintEvent一致，先绘制标题区域再绘制背景
+    QPainterPath path;
+    path.addRoundedRect(rect, ItemRadius, ItemRadius);
+    painter->setClipPath(path);
+
+    QColor brushColor(option.palette.color(QPalette::Base));
+    brushColor.setAlpha(80);
+    painter->setBrush(brushColor);
+    painter->drawRect(QRect(rect.x(), rect.y(), rect.width(), ItemTitleHeight));
+
+    brushColor.setAlpha(hover ? ItemHoverAlpha : ItemUnHoverAlpha);
+    painter->setBrush(brushColor);
+    painter->drawRect(rect);
+    painter->setClipping(false);
+
+    //标题和复制时间
+    const QRect titleRect(rect.x() + 10, rect.y(), rect.width() - 20, ItemTitleHeight);
+    QFont titleFont = DFontSizeManager::instance()->t4();
+    titleFont.setWeight(QFont::Thin);
+    painter->setFont(titleFont);
+    painter->setPen(option.palette.color(QPalette::WindowText));
+    painter->drawText(titleRect, Qt::AlignVCenter | Qt::AlignLeft, data->title());
+
+    painter->setFont(option.font);
+    if (!hover)
+        painter->drawText(titleRect, Qt::AlignVCenter | Qt::AlignRight, ItemWidget::CreateTimeString(data->time()));
+
+    //内容
+    const QRect contentRect(rect.x() + ContentMargin, rect.y() + ItemTitleHeight,
+                            rect.width() - ContentMargin * 2, rect.height() - ItemTitleHeight - ItemStatusBarHeight);
+    if (data->type() == Text) {
+        PixmapLabel::drawTextLines(painter, contentRect, data->get_text(), option.fontMetrics, option.palette);
+    } else {
+        // 缓存中的图片已经缩放并按需置灰
+        QStyleOption pixmapOption(option);
+        pixmapOption.state |= QStyle::State_Enabled;
+        QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+        PixmapLabel::drawPixmaps(painter, contentRect, cache.pixmaps, style, pixmapOption);
+    }
+
+    //状态栏
+    painter->setPen(option.palette.color(QPalette::WindowText));
+    painter->drawText(QRect(rect.x(), rect.bottom() + 1 - ItemStatusBarHeight, rect.width(), ItemStatusBarHeight),
+                      Qt::AlignCenter, cache.status);
+
+    painter->restore();
+}
+
+ItemDelegate::RowCache ItemDelegate::rowCache(const QStyleOptionViewItem &option, ItemData *data) const
+{
+    const QRgb base = option.palette.color(QPalette::Base).rgba();
+    if (const RowCache *cached = m_cache.object(data)) {
+        // 占位图标在后台加载完成后需要替换
+        const bool loaded = cached->loading && !IconLoader::instance()->isLoading(data);
+        if (cached->data == data && cached->base == base && cached->enabled == data->dataEnabled() && !loaded)
+            return *cached;
+    }
+
+    RowCache *cache = new RowCache;
+    cache->data = data;
+    cache->base = base;
+    cache->enabled = data->dataEnabled();
+
+    // 与ItemWidget显示的内容一致，获取的结果保存在data中
+    bool thumbnail = false;
+    QList<QPixmap> list;
+    if (data->type() == Image) {
+        thumbnail = !data->pixmap().isNull();
+        if (thumbnail)
+            list << data->pixmap();
+    } else if (data->type() == File) {
+        list = ItemWidget::fileContent(data, &thumbnail, &cache->loading);
+        if (cache->loading) {
+            //占位图标不保存到data中
+        } else if (thumbnail) {
+            data->setPixmap(list.value(0));
+        } else {
+            if (list.size() == 1)
+                list.first() = Globals::pixmapScaled(list.first());
+            data->saveFileIcons(list);
+        }
+    }
+
+    QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+    qsizetype cost = 1;
+    for (QPixmap pix : std::as_const(list)) {
+        if (pix.isNull())
+            continue;
+
+        //先缩放,再设置圆角,保证缩略图边框宽度在显示后不会变化
+        if (thumbnail)
+            pix = Globals::GetRoundPixmap(Globals::pixmapScaled(pix), QColor::fromRgba(base));
+        qreal scale = Globals::GetScale(pix.size(), FileIconWidth, FileIconHeight);
+        pix = pix.scaled(pix.size() / scale, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        if (!cache->enabled)
+            pix = style->generatedIconPixmap(QIcon::Disabled, pix, &option);
+
+        cost += qsizetype(pix.width()) * pix.height() * 4;
+        cache->pixmaps << pix;
+    }
+
+    if (data->type() != Image || thumbnail)
+        cache->status = ItemWidget::statusText(data, option.fontMetrics);
+    if (!cache->enabled)
+        cache->status = ItemWidget::deletedText(cache->status, option.fontMetrics);
+
+    const RowCache result = *cache;
+    m_cache.insert(data, cache, cost);
+    return result;
+}
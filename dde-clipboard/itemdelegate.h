@@ -6,6 +6,11 @@
 #define LISTDELEGATE_H
 
 #include <QStyledItemDelegate>
+#include <QCache>
+#include <QPixmap>
+#include <QPointer>
+
+class ItemData;
 
 /*!
  * \~chinese \class ItemDelegate
@@ -20,7 +25,8 @@ public:
 
     /*!
      * \~chinese \name paint
-     * \~chinese \brief 重写paint函数消除Qt默认提供的背景颜色,如果不重写此函数,剪切块显示时会提供一个默认的背景色
+     * \~chinese \brief WidgetMode下剪切块由ItemWidget显示,这里不绘制,消除Qt默认提供的背景颜色;
+     * \~chinese PaintMode下直接绘制标题、复制时间、内容和状态栏,内容使用缓存的图片
      */
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
 
@@ -29,6 +35,11 @@ public:
      * \~chinese \brief 重写父类的createEditor函数,创建一个自定义的编辑器
      */
     QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
+    /*!
+     * \~chinese \name setEditorData
+     * \~chinese \brief 数据被置顶时刷新编辑器上显示的复制时间
+     */
+    void setEditorData(QWidget *editor, const QModelIndex &index) const override;
     /*!
      * \~chinese \name sizeHint
      * \~chinese \brief 返回一个推荐的窗口大小
@@ -45,6 +56,25 @@ public:
      * \~chinese \brief 过滤Qt::Key_Tab,Qt::Key_Backtab事件,将其转变为特殊按键事件，表示切换内部‘焦点’
      */
     bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    /*!
+     * \~chinese \brief PaintMode下每个剪切块缓存的绘制内容
+     */
+    struct RowCache {
+        QPointer<ItemData> data;    // 剪切块释放后地址可能被复用，用于判断缓存是否失效
+        QList<QPixmap> pixmaps;     // 已经缩放、圆角处理的图片，可以直接绘制
+        QString status;
+        QRgb base = 0;              // 生成缩略图边框时的Base颜色，主题变化后重新生成
+        bool enabled = true;
+        bool loading = false;       // 显示的是占位图标，文件图标还在后台加载
+    };
+
+    void paintItem(QPainter *painter, const QStyleOptionViewItem &option, ItemData *data) const;
+    RowCache rowCache(const QStyleOptionViewItem &option, ItemData *data) const;
+
+private:
+    mutable QCache<const ItemData *, RowCache> m_cache;
 };
 
 #endif // LISTDELEGATE_H
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "itemoverlay.h"
+#include "itemwidget.h"
+#include "iconbutton.h"
+#include "constants.h"
+
+#include <QKeyEvent>
+#include <QMouseEvent>
+
+ItemOverlay::ItemOverlay(QPointer<ItemData> data, QWidget *parent)
+    : DWidget(parent)
+    , m_data(data)
+    , m_closeButton(new IconButton(this))
+{
+    m_closeButton->setFixedSize(QSize(ItemTitleHeight, ItemTitleHeight) * 2 / 3);
+    m_closeButton->setRadius(ItemTitleHeight);
+
+    // 背景和内容由ItemDelegate绘制，鼠标移动和按下事件交给列表处理
+    setAttribute(Qt::WA_NoSystemBackground);
+    setFocusPolicy(Qt::StrongFocus);
+    setMouseTracking(true);
+
+    connect(m_closeButton, &IconButton::clicked, this, &ItemOverlay::onClose);
+    connect(this, &ItemOverlay::closeHasFocus, m_closeButton, &IconButton::setFocusState);
+}
+
+void ItemOverlay::onSelect()
+{
+    if (!m_data || !m_data->dataEnabled())
+        return;
+
+    if (m_data->type() == File && !ItemWidget::filesExist(m_data->urls())) {
+        //源文件被删除需要提示，由ItemDelegate重新绘制
+        m_data->setDataEnabled(false);
+        if (parentWidget())
+            parentWidget()->update();
+        return;
+    }
+
+    m_data->popTop();
+}
+
+void ItemOverlay::onClose()
+{
+    if (m_data)
+        m_data->remove();
+}
+
+void ItemOverlay::keyPressEvent(QKeyEvent *event)
+{
+    switch (event->key()) {
+    case Qt::Key_0:
+        //表示切换‘焦点’，tab按键事件在delegate中已被拦截
+        if (event->text() == "change focus") {
+            Q_EMIT closeHasFocus(m_closeFocus = !m_closeFocus);
+            return;
+        }
+        break;
+    case Qt::Key_Enter:
+    case Qt::Key_Return:
+        if (m_closeFocus) {
+            onClose();
+        } else {
+            onSelect();
+        }
+        return;
+    default:
+        break;
+    }
+
+    return DWidget::keyPressEvent(event);
+}
+
+void ItemOverlay::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    onSelect();
+    return DWidget::mouseDoubleClickEvent(event);
+}
+
+void ItemOverlay::focusOutEvent(QFocusEvent *event)
+{
+    m_closeFocus = false;
+    Q_EMIT closeHasFocus(false);
+
+    return DWidget::focusOutEvent(event);
+}
+
+void ItemOverlay::resizeEvent(QResizeEvent *event)
+{
+    // 与ItemWidget标题栏中的位置一致
+    const QSize size = m_closeButton->size();
+    m_closeButton->move(width() - 10 - size.width(), (ItemTitleHeight - size.height()) / 2);
+
+    return DWidget::resizeEvent(event);
+}
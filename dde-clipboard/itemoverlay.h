@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef ITEMOVERLAY_H
+#define ITEMOVERLAY_H
+
+#include <DWidget>
+
+#include <QPointer>
+
+#include "itemdata.h"
+
+DWIDGET_USE_NAMESPACE
+
+class IconButton;
+/*!
+ * \~chinese \class ItemOverlay
+ * \~chinese \brief PaintMode下覆盖在当前剪切块上的编辑器,剪切块的内容由ItemDelegate绘制,
+ * \~chinese 这里只放置关闭按钮并处理双击、回车和Tab切换关闭按钮焦点,列表中同时只有一个
+ */
+class ItemOverlay : public DWidget
+{
+    Q_OBJECT
+public:
+    explicit ItemOverlay(QPointer<ItemData> data, QWidget *parent = nullptr);
+
+    const QPointer<ItemData> itemData() { return m_data; }
+
+Q_SIGNALS:
+    /*!
+     * \~chinese \name closeHasFocus
+     * \~chinese \brief 通知别人，关闭按钮的‘焦点’状态改变了
+     */
+    void closeHasFocus(bool has);
+
+protected:
+    virtual void keyPressEvent(QKeyEvent *event) override;
+    virtual void mouseDoubleClickEvent(QMouseEvent *event) override;
+    virtual void focusOutEvent(QFocusEvent *event) override;
+    virtual void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void onSelect();
+    void onClose();
+
+private:
+    QPointer<ItemData> m_data;
+    IconButton *m_closeButton = nullptr;
+    bool m_closeFocus = false;  //关闭按钮是否置于选中状态
+};
+
+#endif // ITEMOVERLAY_H
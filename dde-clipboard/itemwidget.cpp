@@ -6,6 +6,7 @@
 #include "constants.h"
 #include "pixmaplabel.h"
 #include "refreshtimer.h"
+#include "iconloader.h"
 
 #include <QPainter>
 #include <QPainterPath>
@@ -22,22 +23,60 @@
 #include <QBitmap>
 #include <QImageReader>
 #include <QIcon>
-#include <QScopedPointer>
-#include <QFile>
+#include <QCache>
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
-#include <QMimeDatabase>
 #include <QGraphicsOpacityEffect>
 
 #include <DFontSizeManager>
-
-#include "dgiofile.h"
-#include "dgiofileinfo.h"
+#include <DGuiApplicationHelper>
 
 #include <cmath>
 
-#define HoverAlpha 200
-#define UnHoverAlpha 80
+DGUI_USE_NAMESPACE
+
+// 合成后的文件图标最多占用16MB，以KB计算
+static constexpr int FileIconCacheCost = 16 * 1024;
+
+/*!
+ * \~chinese \class FileIconCache
+ * \~chinese \brief 合成角标后的文件图标缓存，最近最少使用的先被移除。
+ * \~chinese 图标主题或主题类型变化后，主题图标对应的图片会改变，缓存全部失效
+ */
+class FileIconCache
+{
+public:
+    static FileIconCache &instance()
+    {
+        static FileIconCache cache;
+        return cache;
+    }
+
+    const QPixmap *object(const QString &key)
+    {
+        const QString theme = QIcon::themeName() + QString::number(DGuiApplicationHelper::instance()->themeType());
+        if (theme != m_theme) {
+            m_cache.clear();
+            m_theme = theme;
+        }
+        return m_cache.object(key);
+    }
+
+    void insert(const QString &key, const QPixmap &pix)
+    {
+        m_cache.insert(key, new QPixmap(pix), int(qsizetype(pix.width()) * pix.height() * 4 / 1024) + 1);
+    }
+
+private:
+    FileIconCache()
+        : m_cache(FileIconCacheCost)
+    {
+    }
+
+private:
+    QCache<QString, QPixmap> m_cache;
+    QString m_theme;
+};
 
 /*!
  * \~chinese \class ItemWidget
@@ -272,9 +311,9 @@ void ItemWidget::initUI()
     m_statusLabel->setFixedHeight(ItemStatusBarHeight);
     m_statusLabel->setAlignment(Qt::AlignCenter);
 
-    setHoverAlpha(HoverAlpha);
-    setUnHoverAlpha(UnHoverAlpha);
-    setRadius(8);
+    setHoverAlpha(ItemHoverAlpha);
+    setUnHoverAlpha(ItemUnHoverAlpha);
+    setRadius(ItemRadius);
 
     setFocusPolicy(Qt::StrongFocus);
 
@@ -307,107 +346,8 @@ void ItemWidget::initData(QPointer<ItemData> data)
             return;
         }
 
-        QUrl url = data->urls().first();
-        if (data->urls().size() == 1) {
-            if (!m_data->pixmap().isNull()) {//避免重复获取
-                setThumnail(m_data->pixmap());
-            } else if (m_data->FileIcons().size() == 1) { //避免重复获取
-                setFileIcon(m_data->FileIcons().first());
-            } else {
-                if (data->IconDataList().size() == data->urls().size()) {//先查看文件管理器在复制时有没有提供缩略图
-                    FileIconData iconData = data->IconDataList().first();
-                    //图片不需要加角标,但需要对图片进行圆角处理(此时文件可能已经被删除，缩略图由文件管理器提供)
-                    if (QImageReader::supportedImageFormats().contains(QFileInfo(url.path()).suffix().toLatin1())) {
-                        //只有图片需要圆角边框
-                        iconData.cornerIconList.clear();
-                        setThumnail(iconData);
-                    } else {
-                        // 图标为空时，通过url获取图标
-                        if (iconData.fileIcon.isNull()) {
-                            QPixmap pix = GetFileIcon(url.path());
-                            setFileIcon(pix);
-                        } else {
-                            setFileIcon(iconData);
-                        }
-                    }
-                } else {
-                    QMimeDatabase db;
-                    QMimeType mime = db.mimeTypeForFile(url.path());
-                    if (mime.name().startsWith("image/")) { //如果文件是图片,提供缩略图
-                        QFile file(url.path());
-                        QPixmap pix;
-                        if (file.open(QFile::ReadOnly)) {
-                            QByteArray array = file.readAll();
-                            pix.loadFromData(array);
-
-                            if (pix.isNull()) {
-                                QIcon icon = QIcon::fromTheme(mime.genericIconName());
-                                pix = icon.pixmap(PixmapWidth, PixmapHeight);
-                                setFileIcon(pix);
-                            } else {
-                                setThumnail(pix);
-                            }
-                        } else {
-                            QIcon icon = QIcon::fromTheme(mime.genericIconName());
-                            pix = icon.pixmap(PixmapWidth, PixmapHeight);
-                            setFileIcon(pix);
-                        }
-                        file.close();
-                    } else {
-                        QPixmap pix = GetFileIcon(url.path());
-                        setFileIcon(pix);
-                    }
-                }
-            }
-
-            QFontMetrics metrix = m_statusLabel->fontMetrics();
-            QString text = metrix.elidedText(url.fileName(), Qt::ElideMiddle, WindowWidth - 2 * ItemMargin - 10, 0);
-            m_statusLabel->setText(text);
-
-        } else if (data->urls().size() > 1) {
-            QFontMetrics metrix = m_statusLabel->fontMetrics();
-            QString text = metrix.elidedText(tr("%1 files (%2...)").arg(data->urls().size()).arg(url.fileName()),
-                                             Qt::ElideMiddle, WindowWidth - 2 * ItemMargin - 10, 0);
-            m_statusLabel->setText(text);
-
-            bool getByUrl = true;
-            //判断文件管理器是否提供,提供不全或图标为空时，通过url获取图标
-            if (!data->IconDataList().isEmpty()) {
-                QList<QPixmap> pixmapList;
-                foreach (auto iconData, data->IconDataList()) {
-                    if (iconData.fileIcon.isNull()) {
-                        continue;
-                    }
-                    QPixmap pix = GetFileIcon(iconData);
-                    pixmapList.push_back(pix);
-                    if (pixmapList.size() == 3) {
-                        break;
-                    }
-                }
-                if (!pixmapList.isEmpty()) {
-                    getByUrl = false;
-                    std::sort(pixmapList.begin(), pixmapList.end(), [ = ](const QPixmap & pix1, const QPixmap & pix2) {
-                        return pix1.size().width() < pix2.size().width();
-                    });
-                    setFileIcons(pixmapList);
-                }
-            }
-            if (getByUrl) {
-                if (!m_data->FileIcons().isEmpty()) {//避免重复获取
-                    setFileIcons(m_data->FileIcons());
-                    break;
-                }
-
-                int iconNum = MIN(3, data->urls().size());
-                QList<QPixmap> pixmapList;
-                for (int i = 0; i < iconNum; ++i) {
-                    QUrl fileUrl = data->urls()[i];
-                    QPixmap pix = GetFileIcon(fileUrl.toLocalFile());
-                    pixmapList.push_back(pix);
-                }
-                setFileIcons(pixmapList);
-            }
-        }
+        initFileContent();
+        m_statusLabel->setText(statusText(data, m_statusLabel->fontMetrics()));
     }
     break;
     default:
@@ -416,16 +356,31 @@ void ItemWidget::initData(QPointer<ItemData> data)
 
     if (!data->dataEnabled()) {
         m_contentLabel->setEnabled(false);
-        QFontMetrics metrix = m_statusLabel->fontMetrics();
-        QString tips = tr("(File deleted)");
-        int tipsWidth = metrix.horizontalAdvance(tips);
-        QString text = metrix.elidedText(m_statusLabel->text(), Qt::ElideMiddle, WindowWidth - 2 * ItemMargin - 10 - tipsWidth, 0);
-        m_statusLabel->setText(text + tips);
+        m_statusLabel->setText(deletedText(m_statusLabel->text(), m_statusLabel->fontMetrics()));
+    }
+}
+
+void ItemWidget::initFileContent()
+{
+    bool thumbnail = false;
+    bool loading = false;
+    const QList<QPixmap> content = fileContent(m_data, &thumbnail, &loading);
+    if (loading) {
+        //占位图标不保存到data中
+        m_contentLabel->setPixmapList(content);
+    } else if (thumbnail) {
+        setThumnail(content.first());
+    } else if (m_data->urls().size() == 1) {
+        setFileIcon(content.value(0));
+    } else {
+        setFileIcons(content);
     }
 }
 
 void ItemWidget::initConnect()
 {
+    //后台加载的文件图标或缩略图完成后只刷新内容
+    connect(m_data, &ItemData::contentLoaded, this, &ItemWidget::initFileContent);
     connect(m_refreshTimer, &QTimer::timeout, this, &ItemWidget::onRefreshTime);
     connect(RefreshTimer::instance(), &RefreshTimer::forceRefresh, this, &ItemWidget::onRefreshTime);
     connect(this, &ItemWidget::hoverStateChanged, this, &ItemWidget::onHoverStateChanged);
@@ -513,78 +468,138 @@ QPixmap ItemWidget::getIconPixmap(const QIcon &icon, const QSize &size, qreal pi
 
 QPixmap ItemWidget::GetFileIcon(QString path)
 {
-    QFileInfo info(path);
-    QIcon icon;
+    return GetFileIcon(IconLoader::iconData(IconLoader::queryFileIcon(path)));
+}
 
-    if (!QFileInfo::exists(path)) {
-        QMimeDatabase db;
-        QMimeType mime = db.mimeTypeForFile(path);
-        return QIcon::fromTheme(mime.genericIconName()).pixmap(FileIconWidth, FileIconWidth);
-    }
-    QScopedPointer<DGioFile> file(DGioFile::createFromPath(info.absoluteFilePath()));
-    QExplicitlySharedDataPointer<DGioFileInfo> fileinfo = file->createFileInfo();
-    if (!fileinfo) {
-        return QPixmap();
-    }
+QPixmap ItemWidget::GetFileIcon(const FileIconData &data)
+{
+    // 相同图标、角标、大小和缩放比例的文件只合成一次，主题图标使用名称，图标文件使用路径，其他图标只能按对象区分
+    QString iconName = data.fileIcon.name();
+    if (iconName.isEmpty())
+        iconName = data.iconPath.isEmpty() ? QString("#%1").arg(data.fileIcon.cacheKey()) : data.iconPath;
+    const QString key = QString("%1|%2|%3|%4").arg(iconName, data.cornerIconList.join(','))
+                        .arg(FileIconWidth).arg(qApp->devicePixelRatio());
+    FileIconCache &cache = FileIconCache::instance();
+    if (const QPixmap *cached = cache.object(key))
+        return *cached;
 
-    QStringList icons = fileinfo->themedIconNames();
-    if (!icons.isEmpty()) {
-        icon =  QIcon::fromTheme(icons.first()).pixmap(FileIconWidth, FileIconWidth);
-    } else {
-        QString iconStr(fileinfo->iconString());
-        if (iconStr.startsWith('/')) {
-            icon = QIcon(iconStr);
-        } else {
-            icon = QIcon::fromTheme(iconStr);
+    QStringList icons = data.cornerIconList;
+    QPixmap pix = data.fileIcon.pixmap(QSize(FileIconWidth, FileIconWidth));
+    if (!icons.isEmpty() && !pix.isNull()) {
+        QPainter painter(&pix);
+        painter.setRenderHints(painter.renderHints() | QPainter::SmoothPixmapTransform);
+        QList<QRectF> cornerGeometryList = getCornerGeometryList(pix.rect(), pix.size() / 4);
+        for (int i = 0; i < icons.size() && i < cornerGeometryList.size(); ++i) {
+            painter.drawPixmap(cornerGeometryList.at(i).toRect(),
+                               getIconPixmap(QIcon::fromTheme(icons.at(i)), QSize(24, 24), painter.device()->devicePixelRatioF(), QIcon::Normal, QIcon::On));
         }
     }
 
-    //get additional icons
-    QPixmap pix = icon.pixmap(FileIconWidth, FileIconWidth);
-    QList<QRectF> cornerGeometryList = getCornerGeometryList(pix.rect(), pix.size() / 4);
-    QList<QIcon> iconList;
-    if (info.isSymLink()) {
-        iconList << QIcon::fromTheme("emblem-symbolic-link");
-    }
+    cache.insert(key, pix);
+    return pix;
+}
 
-    if (!info.isWritable()) {
-        iconList << QIcon::fromTheme("emblem-readonly");
-    }
+QList<QPixmap> ItemWidget::fileContent(QPointer<ItemData> data, bool *thumbnail, bool *loading)
+{
+    *thumbnail = false;
+    *loading = false;
+    QList<QPixmap> pixmapList;
 
-    if (!info.isReadable()) {
-        iconList << QIcon::fromTheme("emblem-unreadable");
-    }
+    // 需要访问文件时在后台加载，先显示占位图标，加载完成后data会发出contentLoaded信号
+    auto loadLater = [data, loading] {
+        IconLoader::instance()->request(data);
+        *loading = true;
+        return IconLoader::placeholders(data->urls());
+    };
+    if (data->urls().isEmpty())
+        return pixmapList;
 
-    //if info is shared()  add icon "emblem-shared"(code from 'dde-file-manager')
+    QUrl url = data->urls().first();
+    if (data->urls().size() == 1) {
+        if (!data->pixmap().isNull()) {//避免重复获取
+            *thumbnail = true;
+            return pixmapList << data->pixmap();
+        }
+        if (data->FileIcons().size() == 1) //避免重复获取
+            return pixmapList << data->FileIcons().first();
+
+        if (data->IconDataList().size() == data->urls().size()) {//先查看文件管理器在复制时有没有提供缩略图
+            const FileIconData &iconData = data->IconDataList().first();
+            //图片不需要加角标,但需要对图片进行圆角处理(此时文件可能已经被删除，缩略图由文件管理器提供)
+            if (QImageReader::supportedImageFormats().contains(QFileInfo(url.path()).suffix().toLatin1())) {
+                //只有图片需要圆角边框
+                *thumbnail = true;
+                return pixmapList << iconData.fileIcon.pixmap(QSize(FileIconWidth, FileIconWidth));
+            }
+            // 图标为空时，通过url获取图标
+            if (iconData.fileIcon.isNull())
+                return loadLater();
+            return pixmapList << GetFileIcon(iconData);
+        }
 
-    QPainter painter(&pix);
-    painter.setRenderHints(painter.renderHints() | QPainter::SmoothPixmapTransform);
-    for (int i = 0; i < iconList.size(); ++i) {
-        painter.drawPixmap(cornerGeometryList.at(i).toRect(),
-                           getIconPixmap(iconList.at(i), QSize(24, 24), painter.device()->devicePixelRatioF(), QIcon::Normal, QIcon::On));
+        //如果文件是图片,提供缩略图,否则查询文件图标
+        return loadLater();
     }
 
-    return pix;
+    //判断文件管理器是否提供,提供不全或图标为空时，通过url获取图标
+    foreach (auto iconData, data->IconDataList()) {
+        if (iconData.fileIcon.isNull()) {
+            continue;
+        }
+        pixmapList.push_back(GetFileIcon(iconData));
+        if (pixmapList.size() == 3) {
+            break;
+        }
+    }
+    if (!pixmapList.isEmpty()) {
+        std::sort(pixmapList.begin(), pixmapList.end(), [ = ](const QPixmap & pix1, const QPixmap & pix2) {
+            return pix1.size().width() < pix2.size().width();
+        });
+        return pixmapList;
+    }
+
+    if (!data->FileIcons().isEmpty())//避免重复获取
+        return data->FileIcons();
+
+    return loadLater();
 }
 
-QPixmap ItemWidget::GetFileIcon(const FileIconData &data)
+QString ItemWidget::statusText(QPointer<ItemData> data, const QFontMetrics &metrics)
 {
-    QIcon icon;
-    QStringList icons = data.cornerIconList;
-    QPixmap pix = data.fileIcon.pixmap(QSize(FileIconWidth, FileIconWidth));
-    if (icons.isEmpty()) {
-        return pix;
-    }
+    switch (data->type()) {
+    case Text:
+        return data->subTitle();
+    case Image:
+        return QString("%1X%2px").arg(data->pixSize().width()).arg(data->pixSize().height());
+    case File: {
+        if (data->urls().isEmpty())
+            return QString();
 
-    QPainter painter(&pix);
-    painter.setRenderHints(painter.renderHints() | QPainter::SmoothPixmapTransform);
-    QList<QRectF> cornerGeometryList = getCornerGeometryList(pix.rect(), pix.size() / 4);
-    for (int i = 0; i < icons.size(); ++i) {
-        painter.drawPixmap(cornerGeometryList.at(i).toRect(),
-                           getIconPixmap(QIcon::fromTheme(icons.at(i)), QSize(24, 24), painter.device()->devicePixelRatioF(), QIcon::Normal, QIcon::On));
+        const QString fileName = data->urls().first().fileName();
+        const QString text = data->urls().size() == 1 ? fileName : tr("%1 files (%2...)").arg(data->urls().size()).arg(fileName);
+        return metrics.elidedText(text, Qt::ElideMiddle, WindowWidth - 2 * ItemMargin - 10, 0);
     }
+    default:
+        return QString();
+    }
+}
 
-    return pix;
+QString ItemWidget::deletedText(const QString &status, const QFontMetrics &metrics)
+{
+    QString tips = tr("(File deleted)");
+    int tipsWidth = metrics.horizontalAdvance(tips);
+    QString text = metrics.elidedText(status, Qt::ElideMiddle, WindowWidth - 2 * ItemMargin - 10 - tipsWidth, 0);
+    return text + tips;
+}
+
+bool ItemWidget::filesExist(const QList<QUrl> &urls)
+{
+    foreach (auto url, urls) {
+        if (QDir().exists(url.toLocalFile())) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void ItemWidget::onSelect()
@@ -593,26 +608,12 @@ void ItemWidget::onSelect()
         return;
     }
 
-    if (m_data->type() == File) {
-        QList<QUrl> urls = m_data->urls();
-        bool has = false;
-        foreach (auto url, urls) {
-            if (QDir().exists(url.toLocalFile())) {
-                has = true;
-            }
-        }
-        if (!has) {
-            m_data->setDataEnabled(false);
-            //源文件被删除需要提示
-            m_contentLabel->setEnabled(false);
-            QFontMetrics metrix = m_statusLabel->fontMetrics();
-            QString tips = tr("(File deleted)");
-            int tipsWidth = metrix.horizontalAdvance(tips);
-            QString text = metrix.elidedText(m_statusLabel->text(), Qt::ElideMiddle, WindowWidth - 2 * ItemMargin - 10 - tipsWidth, 0);
-            m_statusLabel->setText(text + tips);
-
-            return;
-        }
+    if (m_data->type() == File && !filesExist(m_data->urls())) {
+        m_data->setDataEnabled(false);
+        //源文件被删除需要提示
+        m_contentLabel->setEnabled(false);
+        m_statusLabel->setText(deletedText(m_statusLabel->text(), m_statusLabel->fontMetrics()));
+        return;
     }
 
     m_data->popTop();
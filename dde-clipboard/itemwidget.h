@@ -69,6 +69,37 @@ public:
     static QPixmap GetFileIcon(QString path);
     static QPixmap GetFileIcon(const FileIconData &data);
 
+    /*!
+     * \~chinese \name fileContent
+     * \~chinese \brief 获取文件类型剪切块显示的图片,优先使用data中已经获取过的结果
+     * \~chinese \param thumbnail 返回true表示结果是需要圆角处理的缩略图,否则是文件图标
+     * \~chinese \param loading 返回true表示需要访问文件,已交给IconLoader在后台加载,结果是占位图标,不应保存
+     * \~chinese \return 未经缩放的图片,单个文件时只有一张
+     */
+    static QList<QPixmap> fileContent(QPointer<ItemData> data, bool *thumbnail, bool *loading);
+    /*!
+     * \~chinese \name statusText
+     * \~chinese \brief 状态栏显示的文字(字符数,图片尺寸或文件名),不包含文件已删除的提示
+     */
+    static QString statusText(QPointer<ItemData> data, const QFontMetrics &metrics);
+    /*!
+     * \~chinese \name deletedText
+     * \~chinese \brief 在状态栏文字后加上文件已删除的提示
+     */
+    static QString deletedText(const QString &status, const QFontMetrics &metrics);
+    /*!
+     * \~chinese \name filesExist
+     * \~chinese \brief 复制的文件是否还有存在的
+     */
+    static bool filesExist(const QList<QUrl> &urls);
+    /*!
+     * \~chinese \name CreateTimeString
+     * \~chinese \brief 创建复制时间的字符串
+     * \~chinese \param 剪切块创建的时间
+     * \~chinese \return 返回创建时间的字符串
+     */
+    static QString CreateTimeString(const QDateTime &time);
+
 Q_SIGNALS:
     void close();
     /*!
@@ -114,14 +145,11 @@ private:
      * \~chinese \brief 初始化信号的连接
      */
     void initConnect();
-
     /*!
-     * \~chinese \name CreateTimeString
-     * \~chinese \brief 创建复制时间的字符串
-     * \~chinese \param 剪切块创建的时间
-     * \~chinese \return 返回创建时间的字符串
+     * \~chinese \name initFileContent
+     * \~chinese \brief 显示文件类型剪切块的图标或缩略图,后台加载完成后再次调用刷新
      */
-    QString CreateTimeString(const QDateTime &time);
+    void initFileContent();
 
     double getOpacity() const { return 0.0; }
 
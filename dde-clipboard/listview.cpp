@@ -42,6 +42,32 @@ ListView::ListView(QWidget *parent)
     scroller->setScrollerProperties(sp);
 }
 
+void ListView::setRenderMode(ListView::RenderMode mode)
+{
+    if (m_renderMode == mode)
+        return;
+
+    m_renderMode = mode;
+    if (m_renderMode == PaintMode) {
+        if (!m_refreshTimer) {
+            m_refreshTimer = new QTimer(this);
+            m_refreshTimer->setInterval(60 * 1000);
+            connect(m_refreshTimer, &QTimer::timeout, viewport(), qOverload<>(&QWidget::update));
+            connect(RefreshTimer::instance(), &RefreshTimer::forceRefresh, viewport(), qOverload<>(&QWidget::update));
+        }
+        m_refreshTimer->start();
+    } else if (m_refreshTimer) {
+        m_refreshTimer->stop();
+    }
+
+    // 已经创建的编辑器在模式切换后不再适用
+    if (model()) {
+        for (int i = 0; i < model()->rowCount(); ++i)
+            closePersistentEditor(model()->index(i, 0));
+    }
+    viewport()->update();
+}
+
 void ListView::keyPressEvent(QKeyEvent *event)
 {
     switch (event->key()) {
@@ -83,9 +109,20 @@ void ListView::mouseMoveEvent(QMouseEvent *event)
          || event->source() != Qt::MouseEventSynthesizedByQt) && m_mousePressed) {
         m_mousePressed = false;
         if (m_mimeData) {
-            QDrag *drag = new QDrag(this);
-            drag->setMimeData(m_mimeData);
-            drag->exec(Qt::CopyAction);
+            startDrag();
+        } else if (m_pressedData) {
+            // 开始拖拽时才获取完整数据，不等待daemon的回复，数据返回时鼠标仍未松开才开始拖拽
+            QPointer<ItemData> data = m_pressedData;
+            ClipboardModel *model = static_cast<ClipboardModel *>(this->model());
+            model->fetchFormats(data, this, [this, data](const QMap<QString, QByteArray> &formatMap) {
+                if (!data || data != m_pressedData || m_mimeData || formatMap.isEmpty())
+                    return;
+
+                m_mimeData = new QMimeData;
+                for (auto itor = formatMap.constBegin(); itor != formatMap.constEnd(); ++itor)
+                    m_mimeData->setData(itor.key(), itor.value());
+                startDrag();
+            });
         }
     }
 
@@ -113,6 +150,10 @@ void ListView::scrollTo(const QModelIndex &index, QAbstractItemView::ScrollHint
 
 void ListView::startAni(int index)
 {
+    // 绘制的剪切块没有可以移动的窗口，删除后直接重新布局
+    if (m_renderMode == PaintMode)
+        return;
+
     grabMouse();
     for (int i = index + 1; i < this->model()->rowCount(QModelIndex()); ++i) {
         if(!CreateAnimation(i)) {
@@ -170,6 +211,19 @@ bool ListView::CreateAnimation(int idx)
     return true;
 }
 
+void ListView::currentChanged(const QModelIndex &current, const QModelIndex &previous)
+{
+    if (m_renderMode == PaintMode) {
+        if (previous.isValid() && previous != current)
+            closePersistentEditor(previous);
+        // 先创建编辑器，QListView::currentChanged中会将焦点设置到当前的编辑器上
+        if (current.isValid())
+            openPersistentEditor(current);
+    }
+
+    QListView::currentChanged(current, previous);
+}
+
 void ListView::mousePressEvent(QMouseEvent *event)
 {
     QListView::mousePressEvent(event);
@@ -179,17 +233,7 @@ void ListView::mousePressEvent(QMouseEvent *event)
         return;
 
     ClipboardModel *model = static_cast<ClipboardModel *>(this->model());
-    ItemData *data = model->data().at(dataIndex.row());
-
-    if (!m_mimeData)
-        m_mimeData = new QMimeData;
-
-    QMap<QString, QByteArray>::const_iterator itor = data->formatMap().constBegin();
-    while (itor != data->formatMap().constEnd()) {
-        m_mimeData->setData(itor.key(), itor.value());
-        ++itor;
-    }
-
+    m_pressedData = model->data().at(dataIndex.row());
     m_mousePressed = true;
 }
 
@@ -205,9 +249,17 @@ void ListView::mouseDoubleClickEvent(QMouseEvent *event)
     resetReadyDragState();
 }
 
+void ListView::startDrag()
+{
+    QDrag *drag = new QDrag(this);
+    drag->setMimeData(m_mimeData);
+    drag->exec(Qt::CopyAction);
+}
+
 void ListView::resetReadyDragState()
 {
     m_mousePressed = false;
+    m_pressedData = nullptr;
     if (m_mimeData) {
         m_mimeData->deleteLater();
         m_mimeData = nullptr;
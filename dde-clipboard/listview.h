@@ -7,6 +7,9 @@
 #include <QListView>
 #include <QPointer>
 
+class ItemData;
+class QTimer;
+
 /*!
  * \~chinese \class ListView
  * \~chinese \brief 继承于QListView,将剪切块以列表的形式展示出来
@@ -15,8 +18,21 @@ class ListView : public QListView
 {
     Q_OBJECT
 public:
+    /*!
+     * \~chinese \brief 剪切块的显示方式
+     * \~chinese WidgetMode: 每个剪切块都是一个常驻的ItemWidget
+     * \~chinese PaintMode: 剪切块由ItemDelegate直接绘制,只有当前剪切块上有一个放置关闭按钮的ItemOverlay
+     */
+    enum RenderMode {
+        WidgetMode,
+        PaintMode
+    };
+
     explicit ListView(QWidget *parent = nullptr);
 
+    RenderMode renderMode() const { return m_renderMode; }
+    void setRenderMode(RenderMode mode);
+
     /*!
      * \~chinese \name keyPressEvent
      * \~chinese \brief 重写父类的keyPressEvent方法实现上下方向键切换剪贴块。
@@ -43,16 +59,25 @@ Q_SIGNALS:
     void extract(const QModelIndex &index);
 
 protected:
+    /*!
+     * \~chinese \name currentChanged
+     * \~chinese \brief PaintMode下将ItemOverlay移动到新的当前剪切块上
+     */
+    virtual void currentChanged(const QModelIndex &current, const QModelIndex &previous) override;
     virtual void mousePressEvent(QMouseEvent *event) override;
     virtual void mouseReleaseEvent(QMouseEvent *event) override;
     virtual void mouseDoubleClickEvent(QMouseEvent *event) override;
 
 private:
+    void startDrag();
     void resetReadyDragState();
 
 private:
     bool m_mousePressed;
     QPointer<QMimeData> m_mimeData;
+    QPointer<ItemData> m_pressedData;     // 按下鼠标时的剪切块，开始拖拽时才获取数据，松开鼠标后清空
+    RenderMode m_renderMode = WidgetMode;
+    QTimer *m_refreshTimer = nullptr;     // PaintMode下定时重绘，刷新显示的复制时间
 };
 
 #endif // LISTVIEW_H
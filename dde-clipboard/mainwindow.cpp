@@ -36,6 +36,11 @@ static QColor innerBorderColor = QColor(255, 255, 255, static_cast<int>(0.2 * 25
 #define ALPHA_OFFSET 10
 
 MainWindow::MainWindow(QWidget *parent)
+    : MainWindow(QDBusConnection::sessionBus(), parent)
+{
+}
+
+MainWindow::MainWindow(const QDBusConnection &loaderConnection, QWidget *parent)
     : DBlurEffectWidget(parent)
     , m_displayInter(new DBusDisplay("org.deepin.dde.Display1", "/org/deepin/dde/Display1", QDBusConnection::sessionBus(), this))
     , m_daemonDockInter(new DBusDaemonDock("org.deepin.dde.daemon.Dock1", "/org/deepin/dde/daemon/Dock1", QDBusConnection::sessionBus(), this))
@@ -43,7 +48,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_regionMonitor(nullptr)
     , m_content(new DWidget(parent))
     , m_listview(new ListView(this))
-    , m_model(new ClipboardModel(m_listview))
+    , m_model(new ClipboardModel(m_listview, loaderConnection))
     , m_itemDelegate(new ItemDelegate(m_listview))
     , m_placeholderWidget(new DWidget(this))
     , m_placeholderIcon(new DIconButton(this))
@@ -313,6 +318,9 @@ void MainWindow::initUI()
     m_clearButton->setVisible(false);
     titleWidget->setFixedSize(WindowWidth, WindowTitleHeight);
 
+    // 默认由delegate绘制剪切块，设置DDE_CLIPBOARD_RENDER_MODE=widget时恢复为每个剪切块一个ItemWidget
+    m_listview->setRenderMode(qEnvironmentVariable("DDE_CLIPBOARD_RENDER_MODE") == QLatin1String("widget")
+                              ? ListView::WidgetMode : ListView::PaintMode);
     m_listview->setModel(m_model);
     m_listview->setItemDelegate(m_itemDelegate);
     m_listview->setFixedWidth(WindowWidth);//需固定，否则动画会变形
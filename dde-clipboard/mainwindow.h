@@ -48,6 +48,10 @@ class MainWindow : public DBlurEffectWidget
 
 public:
     explicit MainWindow(QWidget *parent = nullptr);
+    /*!
+     * \~chinese \brief 通过loaderConnection访问剪贴板daemon，单元测试传入未连接的总线
+     */
+    explicit MainWindow(const QDBusConnection &loaderConnection, QWidget *parent = nullptr);
     ~MainWindow() override;
 
     Q_PROPERTY(double Opacity READ opacity NOTIFY OpacityChanged)
@@ -74,95 +74,105 @@ QPair<QString, int> PixmapLabel::getNextValidString(const QStringList &list, int
     return QPair<QString, int>("", list.size() - 1);
 }
 
+void PixmapLabel::drawPixmaps(QPainter *painter, const QRect &rect, const QList<QPixmap> &list, QStyle *style, const QStyleOption &option)
+{
+    const bool enabled = option.state & QStyle::State_Enabled;
+    if (list.size() == 1) {
+        QPixmap pix = list[0];
+        qreal scale = Globals::GetScale(pix.size(), FileIconWidth, FileIconHeight);
+        int x = rect.x() + int(rect.width() - pix.size().width() / scale) / 2;
+        int y = rect.y() + int(rect.height() - pix.size().height() / scale) / 2;
+
+        if (!enabled)
+            pix = style->generatedIconPixmap(QIcon::Disabled, pix, &option);
+        QPixmap newPix = pix.scaled(pix.size() / scale, Qt::KeepAspectRatio);
+        style->drawItemPixmap(painter, QRect(QPoint(x, y), newPix.size()), Qt::AlignCenter, newPix);
+        return;
+    }
+
+    for (int i = 0 ; i < list.size(); ++i) {
+        QPixmap pix = list[i];
+        if (pix.size() == QSize(0, 0))
+            continue;
+        int x = 0;
+        int y = 0;
+        qreal scale = Globals::GetScale(pix.size(), FileIconWidth, FileIconHeight);
+        if (!(list.size() % 2)) {//奇数个和偶数个计算方法不一样
+            x = int(rect.width() - (pix.size().width() / scale + PixmapxStep)) / 2 + i * PixmapxStep;
+            y = int(rect.height() - (pix.size().height() / scale + PixmapyStep)) / 2 + i * PixmapyStep;
+        } else {
+            x = int(rect.width() - pix.size().width() / scale) / 2 + (i - 1) * PixmapxStep;
+            y = int(rect.height() - pix.size().height() / scale) / 2 + (i - 1) * PixmapyStep;
+        }
+
+        if (!enabled)
+            pix = style->generatedIconPixmap(QIcon::Disabled, pix, &option);
+        QPixmap newPix = pix.scaled(pix.size() / scale, Qt::KeepAspectRatio);
+        style->drawItemPixmap(painter, QRect(rect.topLeft() + QPoint(x, y), newPix.size()), Qt::AlignCenter, newPix);
+    }
+}
+
+void PixmapLabel::drawTextLines(QPainter *painter, const QRect &rect, const QStringList &lines, const QFontMetrics &metrics, const QPalette &palette)
+{
+    int lineNum = lines.length() > TextMaxLines ? TextMaxLines : lines.length();
+    int fontHeight = metrics.height();
+    for (int i  = 0 ; i < lineNum; ++i) {
+        int lineY = rect.y() + TextContentTopMargin + (i + 1) * fontHeight + i * TextLineSpacing;
+        QPoint start(rect.x(), lineY);
+        QPoint end(rect.right() + 1, lineY);
+        painter->setPen(QPen(palette.color(QPalette::Shadow), 2));
+        painter->drawLine(start, end);
+    }
+
+    int maxLineCount = lineNum;
+    int textIndex = 0;
+    int lineFrom = 0;
+    for (int rectIndex = 0; textIndex < lines.length(); rectIndex++, textIndex++) {
+        if (textIndex > (maxLineCount - 1)) {
+            break;
+        }
+        int rectY = rect.y() + TextContentTopMargin + rectIndex * (fontHeight + TextLineSpacing);
+        QRect textRect(rect.x(), rectY, rect.width(), fontHeight);
+        QTextOption option;
+        option.setAlignment(Qt::AlignBottom);
+        option.setWrapMode(QTextOption::NoWrap);//设置文本不能换行
+        painter->setPen(palette.color(QPalette::Text));
+
+        QPair<QString, int> pair = getNextValidString(lines, lineFrom);
+        lineFrom = pair.second;
+        QString str = pair.first.trimmed();
+        if (lineFrom == maxLineCount && maxLineCount == TextMaxLines) {
+            str.replace(str.size() - 3, 3, "...");
+        }
+        if (rectIndex == (maxLineCount-1) && maxLineCount == TextMaxLines) {
+            QString lastStr = pair.first.trimmed();
+            pair = getNextValidString(lines, lineFrom);
+            lineFrom = pair.second;
+            lastStr += pair.first.trimmed();
+            painter->drawText(textRect, metrics.elidedText(lastStr, Qt::ElideRight, rect.width() - 2), option);
+        }
+        else {
+            painter->drawText(textRect, pair.first.trimmed(), option);
+        }
+    }
+}
+
 void PixmapLabel::paintEvent(QPaintEvent *event)
 {
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
     painter.setPen(Qt::transparent);
 
-    QStyle *style = QWidget::style();
     QStyleOption opt;
     opt.initFrom(this);
 
     //drawPixmaps
-    if (m_pixmapList.size() == 1) {
-        QPixmap pix = m_pixmapList[0];
-        qreal scale = Globals::GetScale(pix.size(), FileIconWidth, FileIconHeight);
-        int x = int(width() - pix.size().width() / scale) / 2;
-        int y = int(height() - pix.size().height() / scale) / 2;
-
-        if (!isEnabled())
-            pix = style->generatedIconPixmap(QIcon::Disabled, pix, &opt);
-        QPixmap newPix = pix.scaled(pix.size() / scale, Qt::KeepAspectRatio);
-        style->drawItemPixmap(&painter, QRect(QPoint(x, y), newPix.size()), Qt::AlignCenter, newPix);
-    } else {
-        for (int i = 0 ; i < m_pixmapList.size(); ++i) {
-            QPixmap pix = m_pixmapList[i];
-            if (pix.size() == QSize(0, 0))
-                continue;
-            int x = 0;
-            int y = 0;
-            qreal scale = Globals::GetScale(pix.size(), FileIconWidth, FileIconHeight);
-            if (!(m_pixmapList.size() % 2)) {//奇数个和偶数个计算方法不一样
-                x = int(width() - (pix.size().width() / scale + PixmapxStep)) / 2 + i * PixmapxStep;
-                y = int(height() - (pix.size().height() / scale + PixmapyStep)) / 2 + i * PixmapyStep;
-            } else {
-                x = int(width() - pix.size().width() / scale) / 2 + (i - 1) * PixmapxStep;
-                y = int(height() - pix.size().height() / scale) / 2 + (i - 1) * PixmapyStep;
-            }
-
-            if (!isEnabled())
-                pix = style->generatedIconPixmap(QIcon::Disabled, pix, &opt);
-            QPixmap newPix = pix.scaled(pix.size() / scale, Qt::KeepAspectRatio);
-            style->drawItemPixmap(&painter, QRect(QPoint(x, y), newPix.size()), Qt::AlignCenter, newPix);
-        }
-    }
+    drawPixmaps(&painter, rect(), m_pixmapList, QWidget::style(), opt);
 
     //draw lines
     if (m_istext) {
         //drawText
-        QStringList labelTexts = m_data->get_text();
-        int lineNum = labelTexts.length() > 4 ? 4 : labelTexts.length();
-        int fontHeight = fontMetrics().height();
-        for (int i  = 0 ; i < lineNum; ++i) {
-            int lineY = TextContentTopMargin + (i + 1) * fontHeight + i * TextLineSpacing;
-            QPoint start(0, lineY);
-            QPoint end(width(), lineY);
-            painter.setPen(QPen(palette().color(QPalette::Shadow), 2));
-            painter.drawLine(start, end);
-        }
-
-        int maxLineCount = labelTexts.length() > 4 ? 4 : labelTexts.length();
-        int textIndex = 0;
-        int lineFrom = 0;
-        for (int rectIndex = 0; textIndex < labelTexts.length(); rectIndex++, textIndex++) {
-            if (textIndex > (maxLineCount - 1)) {
-                break;
-            }
-            int rectY = TextContentTopMargin + rectIndex * (fontHeight + TextLineSpacing);
-            QRect textRect(0, rectY, width(), fontHeight);
-            QTextOption option;
-            option.setAlignment(Qt::AlignBottom);
-            option.setWrapMode(QTextOption::NoWrap);//设置文本不能换行
-            painter.setPen(palette().color(QPalette::Text));
-
-            QPair<QString, int> pair = getNextValidString(labelTexts, lineFrom);
-            lineFrom = pair.second;
-            QString str = pair.first.trimmed();
-            if (lineFrom == maxLineCount && maxLineCount == 4) {
-                str.replace(str.size() - 3, 3, "...");
-            }
-            if (rectIndex == (maxLineCount-1) && maxLineCount == 4) {
-                QString lastStr = pair.first.trimmed();
-                pair = getNextValidString(labelTexts, lineFrom);
-                lineFrom = pair.second;
-                lastStr += pair.first.trimmed();
-                painter.drawText(textRect,fontMetrics().elidedText(lastStr,Qt::ElideRight,width()-2),option);
-            }
-            else {
-                painter.drawText(textRect, pair.first.trimmed(), option);
-            }
-        }
+        drawTextLines(&painter, rect(), m_data->get_text(), fontMetrics(), palette());
     }
     return DLabel::paintEvent(event);
 }
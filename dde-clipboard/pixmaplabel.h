@@ -14,6 +14,7 @@
 DWIDGET_USE_NAMESPACE
 
 class QTextLayout;
+class QStyleOption;
 /*!
  * \~chinese \class PixmapLabel
  * \~chinese \brief 继承于DLabel,DLabel继承于QLabel,用于显示剪切块中的文字和图标等信息
@@ -36,6 +37,18 @@ public:
     virtual QSize minimumSizeHint() const override;
     virtual QSize sizeHint() const override;
 
+    /*!
+     * \~chinese \name drawPixmaps
+     * \~chinese \brief 在rect中居中绘制图片,多张图片时依次错开
+     * \~chinese \param option 不可用时使用其中的状态生成置灰的图片
+     */
+    static void drawPixmaps(QPainter *painter, const QRect &rect, const QList<QPixmap> &list, QStyle *style, const QStyleOption &option);
+    /*!
+     * \~chinese \name drawTextLines
+     * \~chinese \brief 在rect中绘制最多4行文字及每行下方的分隔线
+     */
+    static void drawTextLines(QPainter *painter, const QRect &rect, const QStringList &lines, const QFontMetrics &metrics, const QPalette &palette);
+
 private:
     bool m_istext;
 
@@ -43,7 +56,7 @@ private:
     QList<QPixmap> m_pixmapList;
 
 private:
-    QPair<QString, int> getNextValidString(const QStringList &list, int from);
+    static QPair<QString, int> getNextValidString(const QStringList &list, int from);
 
 protected:
     virtual void paintEvent(QPaintEvent *event) override;
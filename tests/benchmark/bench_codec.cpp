@@ -0,0 +1,299 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// 剪贴板数据编解码的性能测试，统计每种数据的编码、解码和只解码预览的耗时、大小和内存分配次数
+// 数据包括单元测试使用的tests/dde-clipboard/qrc/*.buf和构造的大数据
+// 用法: bench-clipboard-codec [--json] [--filter <名称>]
+
+#include "itemcodec.h"
+#include "benchcommon.h"
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QIcon>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPixmap>
+
+#include <cstdio>
+#include <functional>
+
+static const QString FileIconsFormat = QStringLiteral("x-dfm-copied/file-icons");
+
+struct Sample
+{
+    QString name;
+    ItemInfo info;
+};
+
+struct Operation
+{
+    QString name;
+    std::function<QByteArray(const ItemInfo &)> input;      // 计时前准备的输入，大小作为每条数据的字节数
+    std::function<qsizetype(const ItemInfo &, const QByteArray &)> run;  // 返回结果的大小，避免被优化掉
+};
+
+struct Report : Bench::Report
+{
+    QString sample;
+    QString operation;
+    qint64 bytesPerItem = 0;                                // 每条数据的输入大小
+};
+
+// 升级前的QDataStream格式，用于比较新旧格式
+static QByteArray legacyEncode(const ItemInfo &info)
+{
+    QByteArray buf;
+    QDataStream stream(&buf, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_11);
+    stream << info.m_formatMap
+           << info.m_type
+           << info.m_urls
+           << info.m_hasImage;
+    if (info.m_hasImage) {
+        stream << info.m_variantImage;
+        stream << info.m_pixSize;
+    }
+    stream << info.m_enable
+           << info.m_text
+           << info.m_createTime
+           << info.m_formatMap.value(FileIconsFormat)
+           << info.m_hash
+           << info.m_id;
+    return buf;
+}
+
+static QByteArray textData(qsizetype size)
+{
+    QByteArray data;
+    data.reserve(size);
+    while (data.size() < size)
+        data.append("clipboard benchmark text ");
+    data.truncate(size);
+    return data;
+}
+
+static ItemInfo textItem(qsizetype size)
+{
+    const QByteArray text = textData(size);
+    ItemInfo info;
+    info.m_type = Text;
+    info.m_enable = true;
+    info.m_text = QString::fromLatin1(text);
+    info.m_formatMap.insert("text/plain", text);
+    info.m_formatMap.insert("text/html", "<html><body><p>" + text + "</p></body></html>");
+    info.m_createTime = QDateTime::currentDateTime();
+    info.m_hash = 1;
+    info.m_id = 1;
+    return info;
+}
+
+// 原图保存为png，缩略图放在m_variantImage中
+static ItemInfo imageItem(const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(QColor::fromHsv(size.width() % 360, 200, 200));
+
+    ItemInfo info;
+    info.m_type = Image;
+    info.m_enable = true;
+    info.m_hasImage = true;
+    info.m_variantImage = QPixmap::fromImage(image.scaled(PixmapWidth, PixmapHeight, Qt::KeepAspectRatio));
+    info.m_pixSize = size;
+    info.m_formatMap.insert("application/x-qt-image", QByteArray());
+    info.m_formatMap.insert("image/png", QByteArray(size.width() * size.height() / 4, 'p'));
+    info.m_createTime = QDateTime::currentDateTime();
+    info.m_hash = 2;
+    info.m_id = 2;
+    return info;
+}
+
+static ItemInfo fileItem(int count)
+{
+    QPixmap pixmap(48, 48);
+    pixmap.fill(Qt::darkCyan);
+    const QIcon icon(pixmap);
+
+    ItemInfo info;
+    QByteArray iconBuf;
+    QDataStream stream(&iconBuf, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_11);
+    for (int i = 0; i < count; ++i) {
+        info.m_urls.append(QUrl::fromLocalFile(QStringLiteral("/tmp/bench/file-%1.txt").arg(i)));
+        // 文件管理器只提供前几个文件的图标
+        if (i < 4)
+            stream << QStringList {"emblem-symbolic-link"} << icon;
+        else
+            stream << QStringList() << QIcon();
+    }
+
+    QByteArray uriList;
+    for (const QUrl &url : std::as_const(info.m_urls))
+        uriList += url.toEncoded() + "\r\n";
+
+    info.m_type = File;
+    info.m_enable = true;
+    info.m_formatMap.insert("text/uri-list", uriList);
+    info.m_formatMap.insert(FileIconsFormat, iconBuf);
+    info.m_createTime = QDateTime::currentDateTime();
+    info.m_hash = 3;
+    info.m_id = 3;
+    return info;
+}
+
+static QList<Sample> samples()
+{
+    QList<Sample> list;
+
+    // 单元测试使用的数据，保存的是旧格式
+    for (const QString &name : {QStringLiteral("text"), QStringLiteral("image"), QStringLiteral("file")}) {
+        QFile file(QStringLiteral(":/qrc/%1.buf").arg(name));
+        if (!file.open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "read fixture %s failed\n", qPrintable(file.fileName()));
+            continue;
+        }
+        list.append({QStringLiteral("fixture-%1").arg(name), ItemCodec::decode(file.readAll())});
+    }
+
+    list.append({QStringLiteral("text-1KB"), textItem(1024)});
+    list.append({QStringLiteral("text-1MB"), textItem(1024 * 1024)});
+    list.append({QStringLiteral("text-10MB"), textItem(10 * 1024 * 1024)});
+    list.append({QStringLiteral("image-1080p"), imageItem(QSize(1920, 1080))});
+    list.append({QStringLiteral("image-8K"), imageItem(QSize(7680, 4320))});
+    list.append({QStringLiteral("files-1"), fileItem(1)});
+    list.append({QStringLiteral("files-100"), fileItem(100)});
+    list.append({QStringLiteral("files-10000"), fileItem(10000)});
+
+    return list;
+}
+
+static QList<Operation> operations()
+{
+    auto encoded = [](const ItemInfo &info) { return ItemCodec::encode(info); };
+    auto preview = [](const ItemInfo &info) { return ItemCodec::encodePreview(info); };
+
+    return {
+        {QStringLiteral("encode"), encoded, [](const ItemInfo &info, const QByteArray &) {
+            return ItemCodec::encode(info).size();
+        }},
+        {QStringLiteral("decode"), encoded, [](const ItemInfo &, const QByteArray &buf) {
+            return ItemCodec::decode(buf).m_formatMap.size();
+        }},
+        {QStringLiteral("decode-zerocopy"), encoded, [](const ItemInfo &, const QByteArray &buf) {
+            return ItemCodec::decode(buf, ItemCodec::ZeroCopy).m_formatMap.size();
+        }},
+        {QStringLiteral("decode-legacy"), legacyEncode, [](const ItemInfo &, const QByteArray &buf) {
+            return ItemCodec::decode(buf).m_formatMap.size();
+        }},
+        // daemon从历史记录生成预览时只需要文件图标
+        {QStringLiteral("decode-preview-fields"), encoded, [](const ItemInfo &, const QByteArray &buf) {
+            return ItemCodec::decode(buf, ItemCodec::ZeroCopy, {FileIconsFormat}).m_text.size();
+        }},
+        {QStringLiteral("encode-preview"), preview, [](const ItemInfo &info, const QByteArray &) {
+            return ItemCodec::encodePreview(info).size();
+        }},
+        {QStringLiteral("decode-preview"), preview, [](const ItemInfo &, const QByteArray &buf) {
+            ItemInfo info;
+            ItemCodec::decodePreview(buf, info, nullptr, ItemCodec::FileIcons);
+            return info.m_iconDataList.size();
+        }},
+    };
+}
+
+// 数据越大重复的次数越少，每项测试的时间大致相同
+static int iterationsFor(qint64 bytes)
+{
+    return qBound(5, int(64 * 1024 * 1024 / qMax<qint64>(bytes, 1)), 2000);
+}
+
+static Report run(const Sample &sample, const Operation &operation)
+{
+    Report report;
+    report.name = sample.name + QLatin1Char('/') + operation.name;
+    report.sample = sample.name;
+    report.operation = operation.name;
+
+    const QByteArray input = operation.input(sample.info);
+    report.bytesPerItem = input.size();
+    report.iterations = iterationsFor(report.bytesPerItem);
+    report.latencies.reserve(report.iterations);
+
+    volatile qsizetype sink = 0;
+    qint64 elapsed = 0;
+    const quint64 allocationsBefore = Bench::allocations();
+    for (int i = 0; i < report.iterations; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        sink = operation.run(sample.info, input);
+        const qint64 nsecs = timer.nsecsElapsed();
+        elapsed += nsecs;
+        report.latencies.append(nsecs / 1000.0);
+    }
+    report.allocations = Bench::allocations() - allocationsBefore;
+    report.completed = report.iterations;
+    report.bytes = report.bytesPerItem * report.iterations;
+    report.seconds = elapsed / 1e9;
+    Q_UNUSED(sink)
+    return report;
+}
+
+static QJsonObject toJson(const Report &report)
+{
+    QJsonObject object = Bench::toJson(report, QStringLiteral("Us"));
+    object.insert("sample", report.sample);
+    object.insert("operation", report.operation);
+    object.insert("bytesPerItem", report.bytesPerItem);
+    return object;
+}
+
+int main(int argc, char *argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    // 缩略图和文件图标需要QGuiApplication
+    QGuiApplication app(argc, argv);
+
+    const Bench::Options options = Bench::parseOptions(app.arguments());
+
+    QJsonArray results;
+    if (!options.json)
+        printf("%-16s %-22s %8s %12s %10s %10s %10s %12s\n",
+               "sample", "operation", "items", "bytes/item", "p50(us)", "p99(us)", "MB/s", "allocs/item");
+
+    for (const Sample &sample : samples()) {
+        for (const Operation &operation : operations()) {
+            if (!options.matches(sample.name + QLatin1Char('/') + operation.name))
+                continue;
+
+            const QJsonObject result = toJson(run(sample, operation));
+            results.append(result);
+            if (!options.json) {
+                printf("%-16s %-22s %8d %12lld %10.2f %10.2f %10.1f %12.1f\n",
+                       qPrintable(sample.name),
+                       qPrintable(operation.name),
+                       result.value("iterations").toInt(),
+                       static_cast<long long>(result.value("bytesPerItem").toInteger()),
+                       result.value("p50Us").toDouble(),
+                       result.value("p99Us").toDouble(),
+                       result.value("mbPerSecond").toDouble(),
+                       result.value("allocationsPerItem").toDouble());
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (options.json) {
+        QJsonObject root;
+        root.insert("benchmark", "bench-clipboard-codec");
+        root.insert("qt", qVersion());
+        root.insert("formatVersion", ItemCodec::Version);
+        root.insert("results", results);
+        printf("%s\n", QJsonDocument(root).toJson().constData());
+    }
+
+    return 0;
+}
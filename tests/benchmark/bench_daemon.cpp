@@ -0,0 +1,264 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// 剪贴板采集的性能测试，通过内存剪贴板后端提供构造的QMimeData，统计从数据变化到发出itemAdded的耗时
+// 用法: bench-clipboard-daemon [--json] [--filter <名称>]
+
+#include "clipboardloader.h"
+#include "memoryclipboardbackend.h"
+#include "benchcommon.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMimeData>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QUrl>
+
+#include <cstdio>
+#include <functional>
+
+// 重置并读取进程的峰值内存(KB)
+static void resetPeakRss()
+{
+    QFile file("/proc/self/clear_refs");
+    if (file.open(QIODevice::WriteOnly))
+        file.write("5");
+}
+
+static qint64 peakRss()
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+
+    for (const QByteArray &line : file.readAll().split('\n')) {
+        if (line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+    return 0;
+}
+
+struct Scenario
+{
+    QString name;
+    int iterations;
+    std::function<QMimeData *(int)> create;     // 每次的数据都不相同，避免被当作重复数据过滤
+};
+
+struct Report : Bench::Report
+{
+    qint64 peakRss = 0;                         // KB
+};
+
+static QByteArray textData(qsizetype size, int seed)
+{
+    QByteArray data = QByteArray::number(seed) + ' ';
+    data.reserve(size);
+    while (data.size() < size)
+        data.append("clipboard benchmark text ");
+    data.truncate(size);
+    return data;
+}
+
+static QImage imageData(const QSize &size, int seed)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(QColor::fromHsv(seed * 37 % 360, 200, 200));
+    image.setPixel(0, 0, qRgb(seed & 0xff, (seed >> 8) & 0xff, 0));
+    return image;
+}
+
+static QByteArray pngData(const QSize &size, int seed)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    imageData(size, seed).save(&buffer, "png");
+    return data;
+}
+
+static QList<Scenario> scenarios()
+{
+    QList<Scenario> list;
+
+    for (const auto &text : QList<QPair<QString, qsizetype>> {{"1KB", 1024}, {"1MB", 1024 * 1024}, {"10MB", 10 * 1024 * 1024}}) {
+        list.append({QStringLiteral("text-%1").arg(text.first), text.second > 1024 * 1024 ? 10 : 100, [size = text.second](int i) {
+            QMimeData *mimeData = new QMimeData;
+            mimeData->setText(QString::fromLatin1(textData(size, i)));
+            return mimeData;
+        }});
+    }
+
+    // 浏览器、办公软件复制的富文本通常带有多种格式
+    list.append({QStringLiteral("richtext-32formats"), 100, [](int i) {
+        QMimeData *mimeData = new QMimeData;
+        const QByteArray text = textData(16 * 1024, i);
+        mimeData->setText(QString::fromLatin1(text));
+        mimeData->setHtml(QStringLiteral("<html><body><p>%1</p></body></html>").arg(QString::fromLatin1(text)));
+        mimeData->setData("text/rtf", "{\\rtf1 " + text + "}");
+        for (int f = 0; f < 29; ++f)
+            mimeData->setData(QStringLiteral("application/x-bench-format-%1").arg(f), text.left(1024 * (f % 8 + 1)));
+        return mimeData;
+    }});
+
+    for (const auto &image : QList<QPair<QString, QSize>> {{"256", QSize(256, 256)}, {"1080p", QSize(1920, 1080)}, {"8K", QSize(7680, 4320)}}) {
+        const int iterations = image.second.width() > 1920 ? 3 : 20;
+        list.append({QStringLiteral("png-%1").arg(image.first), iterations, [size = image.second](int i) {
+            QMimeData *mimeData = new QMimeData;
+            mimeData->setData("image/png", pngData(size, i));
+            return mimeData;
+        }});
+        list.append({QStringLiteral("image-%1").arg(image.first), iterations, [size = image.second](int i) {
+            QMimeData *mimeData = new QMimeData;
+            mimeData->setImageData(imageData(size, i));
+            return mimeData;
+        }});
+    }
+
+    for (int count : {1, 100, 10000}) {
+        list.append({QStringLiteral("files-%1").arg(count), count > 100 ? 10 : 100, [count](int i) {
+            QList<QUrl> urls;
+            urls.reserve(count);
+            for (int n = 0; n < count; ++n)
+                urls.append(QUrl::fromLocalFile(QStringLiteral("/tmp/bench/%1/file-%2.txt").arg(i).arg(n)));
+            QMimeData *mimeData = new QMimeData;
+            mimeData->setUrls(urls);
+            return mimeData;
+        }});
+    }
+
+    return list;
+}
+
+static qint64 mimeDataSize(const QMimeData *mimeData)
+{
+    qint64 size = 0;
+    for (const QString &format : mimeData->formats())
+        size += mimeData->data(format).size();
+    if (mimeData->hasImage())
+        size += qvariant_cast<QImage>(mimeData->imageData()).sizeInBytes();
+    return size;
+}
+
+static Report run(ClipboardLoader &loader, MemoryClipboardBackend *backend, const Scenario &scenario)
+{
+    Report report;
+    report.name = scenario.name;
+    report.iterations = scenario.iterations;
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    QObject::connect(&loader, &ClipboardLoader::itemAdded, &loop, &QEventLoop::quit);
+
+    resetPeakRss();
+    const quint64 allocationsBefore = Bench::allocations();
+    QElapsedTimer total;
+    total.start();
+    qint64 dataTime = 0;
+
+    for (int i = 0; i < scenario.iterations; ++i) {
+        // 构造数据的时间不计入
+        QElapsedTimer dataTimer;
+        dataTimer.start();
+        QMimeData *mimeData = scenario.create(i);
+        report.bytes += mimeDataSize(mimeData);
+        dataTime += dataTimer.nsecsElapsed();
+
+        QElapsedTimer timer;
+        timer.start();
+        timeout.start(60 * 1000);
+        backend->offer(mimeData);
+        loop.exec();
+        if (!timeout.isActive()) {
+            fprintf(stderr, "%s: iteration %d timed out\n", qPrintable(scenario.name), i);
+            continue;
+        }
+        timeout.stop();
+        report.latencies.append(timer.nsecsElapsed() / 1000000.0);
+        ++report.completed;
+    }
+
+    report.seconds = (total.nsecsElapsed() - dataTime) / 1e9;
+    report.allocations = Bench::allocations() - allocationsBefore;
+    report.peakRss = peakRss();
+    return report;
+}
+
+static QJsonObject toJson(const Report &report)
+{
+    QJsonObject object = Bench::toJson(report, QStringLiteral("Ms"));
+    object.insert("peakRssKb", report.peakRss);
+    return object;
+}
+
+int main(int argc, char *argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    // 每次设置数据后立即采集
+    qputenv("DDE_CLIPBOARD_CAPTURE_DEBOUNCE", "0");
+    qputenv("DDE_CLIPBOARD_CAPTURE_MAX_LATENCY", "0");
+
+    QGuiApplication app(argc, argv);
+    app.setOrganizationName("deepin");
+    app.setApplicationName("dde-clipboard-daemon");
+    // 历史记录和缓存写入测试目录，不影响用户数据
+    QStandardPaths::setTestModeEnabled(true);
+
+    const Bench::Options options = Bench::parseOptions(app.arguments());
+
+    // 不依赖显示服务，图片处理仍需要QGuiApplication
+    MemoryClipboardBackend *backend = new MemoryClipboardBackend;
+    ClipboardLoader loader(backend);
+    loader.ClearItems();
+
+    QJsonArray results;
+    if (!options.json)
+        printf("%-20s %6s %10s %10s %10s %10s %10s %12s %10s\n",
+               "scenario", "items", "items/s", "MB/s", "p50(ms)", "p90(ms)", "p99(ms)", "allocs/item", "rss(KB)");
+
+    for (const Scenario &scenario : scenarios()) {
+        if (!options.matches(scenario.name))
+            continue;
+
+        const QJsonObject result = toJson(run(loader, backend, scenario));
+        results.append(result);
+        if (!options.json) {
+            printf("%-20s %6d %10.1f %10.1f %10.3f %10.3f %10.3f %12.0f %10lld\n",
+                   qPrintable(scenario.name),
+                   result.value("completed").toInt(),
+                   result.value("itemsPerSecond").toDouble(),
+                   result.value("mbPerSecond").toDouble(),
+                   result.value("p50Ms").toDouble(),
+                   result.value("p90Ms").toDouble(),
+                   result.value("p99Ms").toDouble(),
+                   result.value("allocationsPerItem").toDouble(),
+                   static_cast<long long>(result.value("peakRssKb").toInteger()));
+            fflush(stdout);
+        }
+
+        // 每个场景结束后清空历史记录，避免影响下一个场景
+        loader.ClearItems();
+    }
+
+    if (options.json) {
+        QJsonObject root;
+        root.insert("benchmark", "bench-clipboard-daemon");
+        root.insert("qt", qVersion());
+        root.insert("stats", QJsonObject::fromVariantMap(loader.GetStats()));
+        root.insert("scenarios", results);
+        printf("%s\n", QJsonDocument(root).toJson().constData());
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// 比较剪贴板数据直接放在D-Bus消息中和通过memfd传递的耗时
+// 发送方和接收方使用两条独立的会话总线连接，消息会经过dbus-daemon转发
+// 16KB到256KB之间的结果用于确定PayloadTransport::InlineThreshold
+
+#include "payloadtransport.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+
+static const char *SinkService = "org.deepin.dde.ClipboardBench1";
+static const char *SinkPath = "/org/deepin/dde/ClipboardBench1";
+static const char *SinkInterface = "org.deepin.dde.ClipboardBench1";
+
+class PayloadSink : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.ClipboardBench1")
+
+public Q_SLOTS:
+    qlonglong Inline(const QByteArray &buf)
+    {
+        return checksum(buf);
+    }
+
+    qlonglong Fd(const QDBusUnixFileDescriptor &fd)
+    {
+        const PayloadTransport::MappedPayload payload(fd);
+        return payload.isValid() ? checksum(payload.data()) : -1;
+    }
+
+private:
+    // 读取每一页，保证接收方确实访问到了数据
+    static qlonglong checksum(const QByteArray &buf)
+    {
+        qlonglong sum = buf.size();
+        for (qsizetype i = 0; i < buf.size(); i += 4096)
+            sum += static_cast<uchar>(buf.at(i));
+        return sum;
+    }
+};
+
+static double median(QList<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    return samples.at(samples.size() / 2);
+}
+
+static bool run(const QDBusConnection &conn, const QString &method, const QByteArray &data, int rounds, QList<double> &samples)
+{
+    for (int i = 0; i < rounds; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+
+        QDBusMessage msg = QDBusMessage::createMethodCall(SinkService, SinkPath, SinkInterface, method);
+        if (method == QLatin1String("Fd"))
+            msg << QVariant::fromValue(PayloadTransport::toMemfd(data));
+        else
+            msg << data;
+
+        const QDBusMessage reply = conn.call(msg, QDBus::Block, 60 * 1000);
+        const double ms = timer.nsecsElapsed() / 1000000.0;
+        if (reply.type() != QDBusMessage::ReplyMessage) {
+            fprintf(stderr, "%s failed: %s\n", qPrintable(method), qPrintable(reply.errorMessage()));
+            return false;
+        }
+        samples << ms;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QDBusConnection client = QDBusConnection::connectToBus(QDBusConnection::SessionBus, "bench-client");
+    QDBusConnection server = QDBusConnection::connectToBus(QDBusConnection::SessionBus, "bench-server");
+    if (!client.isConnected() || !server.isConnected()) {
+        fprintf(stderr, "session bus is not available, skipped\n");
+        return 0;
+    }
+    if (!client.connectionCapabilities().testFlag(QDBusConnection::UnixFileDescriptorPassing)) {
+        fprintf(stderr, "unix fd passing is not supported, skipped\n");
+        return 0;
+    }
+
+    // 接收方运行在单独的线程中，避免同步调用阻塞分发
+    QThread thread;
+    PayloadSink sink;
+    sink.moveToThread(&thread);
+    thread.start();
+
+    if (!server.registerService(SinkService) || !server.registerObject(SinkPath, &sink, QDBusConnection::ExportAllSlots)) {
+        fprintf(stderr, "register service failed: %s\n", qPrintable(server.lastError().message()));
+        thread.quit();
+        thread.wait();
+        return 1;
+    }
+
+    struct Case {
+        const char *name;
+        qsizetype size;
+        int rounds;
+    };
+    const Case cases[] = {
+        {"1KB", 1024, 200},
+        {"16KB", 16 * 1024, 200},
+        {"64KB", 64 * 1024, 200},
+        {"256KB", 256 * 1024, 100},
+        {"1MB", 1024 * 1024, 50},
+        {"50MB", 50 * 1024 * 1024, 5},
+    };
+
+    int ret = 0;
+    printf("%-6s %-8s %12s %14s\n", "size", "mode", "median(ms)", "MB/s");
+    for (const Case &c : cases) {
+        const QByteArray data(c.size, 'c');
+        for (const QString &method : {QStringLiteral("Inline"), QStringLiteral("Fd")}) {
+            QList<double> samples;
+            if (!run(client, method, data, c.rounds, samples)) {
+                ret = 1;
+                continue;
+            }
+            const double ms = median(samples);
+            const double mbps = c.size / (1024.0 * 1024.0) / (ms / 1000.0);
+            printf("%-6s %-8s %12.3f %14.1f\n", c.name, qPrintable(method), ms, mbps);
+        }
+    }
+
+    server.unregisterObject(SinkPath);
+    server.unregisterService(SinkService);
+    thread.quit();
+    thread.wait();
+    QDBusConnection::disconnectFromBus("bench-client");
+    QDBusConnection::disconnectFromBus("bench-server");
+    return ret;
+}
+
+#include "bench_transport.moc"
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BENCHCOMMON_H
+#define BENCHCOMMON_H
+
+// 性能测试程序共用的内存分配统计、命令行参数和结果统计
+// 其中替换了malloc等函数，每个性能测试程序只能有一个源文件包含
+
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <QtMath>
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef __GLIBC__
+// 统计内存分配次数，转发给glibc的实现
+static std::atomic<quint64> g_allocations { 0 };
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace Bench {
+
+inline quint64 allocations()
+{
+#ifdef __GLIBC__
+    return g_allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+// 命令行参数: [--json] [--filter <名称>]
+struct Options
+{
+    bool json = false;
+    QString filter;
+
+    bool matches(const QString &name) const { return filter.isEmpty() || name.contains(filter); }
+};
+
+inline Options parseOptions(const QStringList &args)
+{
+    Options options;
+    options.json = args.contains("--json");
+    const int filterIndex = args.indexOf("--filter");
+    if (filterIndex > 0 && filterIndex + 1 < args.size())
+        options.filter = args.at(filterIndex + 1);
+    return options;
+}
+
+struct Report
+{
+    QString name;
+    int iterations = 0;
+    int completed = 0;
+    qint64 bytes = 0;                           // 所有完成的操作的输入大小之和
+    QList<double> latencies;                    // 每次操作的耗时，单位由toJson的unit指定
+    double seconds = 0;                         // 计时的总时间
+    quint64 allocations = 0;
+};
+
+inline double percentile(QList<double> samples, double percent)
+{
+    if (samples.isEmpty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    const qsizetype index = qBound<qsizetype>(0, qCeil(percent / 100.0 * samples.size()) - 1, samples.size() - 1);
+    return samples.at(index);
+}
+
+// unit为耗时字段名的后缀，如"Us"、"Ms"
+inline QJsonObject toJson(const Report &report, const QString &unit)
+{
+    QJsonObject object;
+    object.insert("name", report.name);
+    object.insert("iterations", report.iterations);
+    object.insert("completed", report.completed);
+    object.insert("bytes", report.bytes);
+    object.insert("itemsPerSecond", report.seconds > 0 ? report.completed / report.seconds : 0);
+    object.insert("mbPerSecond", report.seconds > 0 ? report.bytes / 1048576.0 / report.seconds : 0);
+    object.insert("p50" + unit, percentile(report.latencies, 50));
+    object.insert("p90" + unit, percentile(report.latencies, 90));
+    object.insert("p99" + unit, percentile(report.latencies, 99));
+    object.insert("max" + unit, percentile(report.latencies, 100));
+    object.insert("allocationsPerItem", report.completed ? double(report.allocations) / report.completed : 0);
+    return object;
+}
+
+} // namespace Bench
+
+#endif // BENCHCOMMON_H
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "memoryclipboardbackend.h"
+
+#include <QTimer>
+
+MemoryClipboardBackend::MemoryClipboardBackend(int protocolType, QObject *parent)
+    : ClipboardBackend(parent)
+    , m_protocolType(protocolType)
+{
+}
+
+MemoryClipboardBackend::~MemoryClipboardBackend()
+{
+    qDeleteAll(m_pending);
+}
+
+const QMimeData *MemoryClipboardBackend::mimeData() const
+{
+    return m_mimeData.get();
+}
+
+void MemoryClipboardBackend::setMimeData(QMimeData *mimeData)
+{
+    ++m_setCount;
+    Q_EMIT mimeDataSet(mimeData);
+    // 与QClipboard一致，自己写入的数据也会通知剪贴板变化
+    replace(mimeData);
+}
+
+void MemoryClipboardBackend::offer(QMimeData *mimeData, int delay)
+{
+    if (delay <= 0) {
+        replace(mimeData);
+        return;
+    }
+
+    m_pending.insert(mimeData);
+    QTimer::singleShot(delay, Qt::PreciseTimer, this, [this, mimeData] {
+        m_pending.remove(mimeData);
+        replace(mimeData);
+    });
+}
+
+void MemoryClipboardBackend::notifyChanged()
+{
+    Q_EMIT dataChanged();
+}
+
+void MemoryClipboardBackend::setPendingFormats(const QStringList &formats)
+{
+    m_pendingFormats = formats;
+    if (m_pendingFormats.isEmpty())
+        Q_EMIT pendingFormatsFinished();
+}
+
+void MemoryClipboardBackend::replace(QMimeData *mimeData)
+{
+    m_mimeData.reset(mimeData);
+    Q_EMIT dataChanged();
+}
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MEMORYCLIPBOARDBACKEND_H
+#define MEMORYCLIPBOARDBACKEND_H
+
+#include "clipboardbackend.h"
+
+#include <QSet>
+
+#include <memory>
+
+/*!
+ * \~chinese \class MemoryClipboardBackend
+ * \~chinese \brief 内存中的剪贴板后端，不依赖显示服务，用于测试和性能测试。
+ * \~chinese 通过offer模拟其他应用复制数据，可以指定延时；daemon回写的数据通过mimeDataSet信号和setCount观察。
+ */
+class MemoryClipboardBackend : public ClipboardBackend
+{
+    Q_OBJECT
+public:
+    explicit MemoryClipboardBackend(int protocolType = X11_PROTOCOL, QObject *parent = nullptr);
+    ~MemoryClipboardBackend() override;
+
+    const QMimeData *mimeData() const override;
+    void setMimeData(QMimeData *mimeData) override;
+    int protocolType() const override { return m_protocolType; }
+    QStringList pendingFormats() const override { return m_pendingFormats; }
+
+    /*!
+     * \~chinese \brief 模拟其他应用复制数据，delay毫秒后替换剪贴板内容并发出dataChanged，delay为0时立即生效
+     */
+    void offer(QMimeData *mimeData, int delay = 0);
+
+    /*!
+     * \~chinese \brief 只发出dataChanged，不替换内容，模拟同一份数据的重复通知
+     */
+    void notifyChanged();
+
+    /*!
+     * \~chinese \brief 模拟还在后台读取的格式，设置为空时发出pendingFormatsFinished
+     */
+    void setPendingFormats(const QStringList &formats);
+
+    int pendingOfferCount() const { return m_pending.size(); }
+    int setCount() const { return m_setCount; }
+
+Q_SIGNALS:
+    /*!
+     * \~chinese \brief daemon通过setMimeData写入了剪贴板，mimeData在内容下次变化前有效
+     */
+    void mimeDataSet(const QMimeData *mimeData);
+
+private:
+    void replace(QMimeData *mimeData);
+
+private:
+    int m_protocolType;
+    int m_setCount = 0;
+    std::unique_ptr<QMimeData> m_mimeData;
+    QSet<QMimeData *> m_pending;                // 还没有到时间的数据
+    QStringList m_pendingFormats;
+};
+
+#endif // MEMORYCLIPBOARDBACKEND_H
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "blobmimedata.h"
+#include "blobstore.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+TEST(TstBlobMimeData, file)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    BlobStore store(dir.path());
+    const QString file = store.put(1, "large data", ".blob");
+    ASSERT_FALSE(file.isEmpty());
+
+    {
+        BlobMimeData mimeData(&store);
+        mimeData.setData("text/plain", "text");
+        mimeData.setFile("application/x-large", file);
+        ASSERT_EQ(mimeData.formats(), QStringList({"text/plain", "application/x-large"}));
+        ASSERT_EQ(mimeData.file("application/x-large"), file);
+        ASSERT_TRUE(mimeData.file("text/plain").isEmpty());
+        ASSERT_EQ(mimeData.data("application/x-large"), QByteArray("large data"));
+
+        // 历史记录删除后，剪贴板数据仍然持有文件的引用
+        ASSERT_EQ(store.refCount(file), 2);
+        store.release({file});
+        ASSERT_TRUE(QFile::exists(file));
+    }
+
+    ASSERT_FALSE(QFile::exists(file));
+}
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "blobstore.h"
+#include "contenthash.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+class TstBlobStore : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+    }
+
+    void TearDown() override
+    {
+    }
+
+public:
+    QTemporaryDir dir;
+};
+
+TEST_F(TstBlobStore, put)
+{
+    BlobStore store(dir.path());
+    const QByteArray data(100 * 1024, 'x');
+    const quint64 hash = ContentHasher::hash(data);
+
+    const QString file = store.put(hash, data, ".blob");
+    ASSERT_FALSE(file.isEmpty());
+    ASSERT_EQ(file, store.filePath(hash, ".blob"));
+    ASSERT_EQ(QFileInfo(file).dir().dirName(), QFileInfo(file).fileName().left(2));
+    ASSERT_EQ(BlobStore::read(file), data);
+
+    // 只有所有者可以访问
+    ASSERT_FALSE(QFileInfo(file).permissions() & (QFileDevice::ReadGroup | QFileDevice::ReadOther));
+    ASSERT_FALSE(QFileInfo(QFileInfo(file).path()).permissions() & (QFileDevice::ExeGroup | QFileDevice::ExeOther));
+
+    // 相同的内容不再重复写入
+    const QDateTime modified = QFileInfo(file).lastModified();
+    QTest::qWait(20);
+    ASSERT_EQ(store.put(hash, data, ".blob"), file);
+    ASSERT_EQ(QFileInfo(file).lastModified(), modified);
+    ASSERT_EQ(store.refCount(file), 2);
+
+    store.release({file});
+    ASSERT_TRUE(QFile::exists(file));
+    store.release({file});
+    ASSERT_FALSE(QFile::exists(file));
+}
+
+TEST_F(TstBlobStore, collision)
+{
+    BlobStore store(dir.path());
+
+    // 指纹相同但内容不同的数据保存到不同的文件中
+    const QString first = store.put(1, "first", ".blob");
+    const QString second = store.put(1, "second", ".blob");
+    ASSERT_EQ(first, store.filePath(1, ".blob"));
+    ASSERT_EQ(second, store.filePath(1, ".blob", 1));
+    ASSERT_EQ(BlobStore::read(first), QByteArray("first"));
+    ASSERT_EQ(BlobStore::read(second), QByteArray("second"));
+
+    // 再次保存时找到内容相同的文件
+    ASSERT_EQ(store.put(1, "second", ".blob"), second);
+    ASSERT_EQ(store.refCount(first), 1);
+    ASSERT_EQ(store.refCount(second), 2);
+
+    QImage red(16, 16, QImage::Format_ARGB32);
+    red.fill(Qt::red);
+    QImage blue(16, 16, QImage::Format_ARGB32);
+    blue.fill(Qt::blue);
+    const QString redFile = store.putImage(2, red);
+    const QString blueFile = store.putImage(2, blue);
+    ASSERT_NE(redFile, blueFile);
+    ASSERT_EQ(QImage(blueFile).convertToFormat(QImage::Format_ARGB32), blue);
+    ASSERT_EQ(store.putImage(2, red), redFile);
+}
+
+TEST_F(TstBlobStore, putImage)
+{
+    BlobStore store(dir.path());
+    QImage image(16, 16, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+
+    const QString file = store.putImage(ContentHasher::hashImage(image), image);
+    ASSERT_TRUE(file.endsWith(".png"));
+    ASSERT_EQ(QImage(file).convertToFormat(QImage::Format_ARGB32), image);
+}
+
+TEST_F(TstBlobStore, sweep)
+{
+    const QString orphan = dir.path() + "/123.png";
+    const QString referenced = dir.path() + "/456.png";
+    for (const QString &name : {orphan, referenced}) {
+        QFile file(name);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write("png");
+    }
+
+    QTest::qWait(20);
+    BlobStore store(dir.path());
+    store.sweep({referenced}, QDateTime::currentDateTime());
+    ASSERT_FALSE(QFile::exists(orphan));
+    ASSERT_TRUE(QFile::exists(referenced));
+
+    // 旧版本的缓存文件在最后一条引用删除后也会被清理
+    store.release({referenced});
+    ASSERT_FALSE(QFile::exists(referenced));
+}
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "capturescheduler.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QTest>
+
+class TstCaptureScheduler : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        scheduler = new CaptureScheduler();
+    }
+
+    void TearDown() override
+    {
+        delete scheduler;
+        scheduler = nullptr;
+    }
+
+public:
+    CaptureScheduler *scheduler = nullptr;
+};
+
+TEST_F(TstCaptureScheduler, coalesce)
+{
+    QSignalSpy spy(scheduler, &CaptureScheduler::triggered);
+    scheduler->setDebounce(20);
+    scheduler->setMaxLatency(1000);
+
+    // 一次连续的变化只采集最后的状态
+    for (int i = 0; i < 1000; ++i)
+        scheduler->post(i % 2);
+
+    QTRY_COMPARE(spy.count(), 1);
+    ASSERT_EQ(spy.first().at(0).toInt(), 1);
+    ASSERT_EQ(scheduler->receivedCount(), 1000u);
+    ASSERT_EQ(scheduler->suppressedCount(), 999u);
+    ASSERT_EQ(scheduler->triggeredCount(), 1u);
+
+    scheduler->resetCounters();
+    ASSERT_EQ(scheduler->receivedCount(), 0u);
+}
+
+TEST_F(TstCaptureScheduler, maxLatency)
+{
+    QSignalSpy spy(scheduler, &CaptureScheduler::triggered);
+    scheduler->setDebounce(50);
+    scheduler->setMaxLatency(100);
+
+    // 事件持续不断时，最多等待maxLatency就采集一次
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 350) {
+        scheduler->post(0);
+        QTest::qWait(10);
+    }
+
+    ASSERT_GE(spy.count(), 2);
+    QTRY_COMPARE(scheduler->triggeredCount(), quint64(spy.count()));
+}
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "capturestats.h"
+
+#include <QThread>
+
+class TstCaptureStats : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        CaptureStats::instance().reset();
+    }
+
+    void TearDown() override
+    {
+        CaptureStats::instance().reset();
+    }
+};
+
+TEST_F(TstCaptureStats, bucket)
+{
+    // 桶的上界单调递增，且每个值都落在上界不小于它的桶中
+    for (int i = 1; i < LatencyHistogram::BucketCount; ++i)
+        ASSERT_GT(LatencyHistogram::bucketUpperBound(i), LatencyHistogram::bucketUpperBound(i - 1));
+
+    for (quint64 value : {0ull, 7ull, 8ull, 9ull, 1000ull, 123456789ull, ~0ull}) {
+        const int index = LatencyHistogram::bucketIndex(value);
+        ASSERT_LT(index, LatencyHistogram::BucketCount);
+        ASSERT_GE(LatencyHistogram::bucketUpperBound(index), value);
+        ASSERT_LE(LatencyHistogram::bucketUpperBound(index) - value, value / 8);
+    }
+}
+
+TEST_F(TstCaptureStats, percentile)
+{
+    LatencyHistogram histogram;
+    for (quint64 value = 1; value <= 1000; ++value)
+        histogram.record(value);
+
+    ASSERT_EQ(histogram.count(), 1000u);
+    ASSERT_EQ(histogram.max(), 1000u);
+    ASSERT_EQ(histogram.sum(), 500500u);
+    ASSERT_NEAR(histogram.percentile(50), 500, 500 / 8);
+    ASSERT_NEAR(histogram.percentile(99), 990, 990 / 8);
+    ASSERT_EQ(histogram.percentile(100), 1000u);
+
+    histogram.reset();
+    ASSERT_EQ(histogram.count(), 0u);
+    ASSERT_EQ(histogram.percentile(99), 0u);
+}
+
+TEST_F(TstCaptureStats, concurrent)
+{
+    LatencyHistogram histogram;
+    QList<QThread *> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.append(QThread::create([&histogram] {
+            for (quint64 value = 0; value < 10000; ++value)
+                histogram.record(value);
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    ASSERT_EQ(histogram.count(), 40000u);
+    ASSERT_EQ(histogram.max(), 9999u);
+}
+
+TEST_F(TstCaptureStats, variantMap)
+{
+    CaptureStats &stats = CaptureStats::instance();
+    stats.record(CaptureStats::Dedup, 2000);
+    stats.addFormatBytes("text/plain", 10);
+    stats.addFormatBytes("text/plain", 5);
+
+    const QVariantMap map = stats.toVariantMap();
+    const QVariantMap dedup = map.value("stages").toMap().value("dedup").toMap();
+    ASSERT_EQ(dedup.value("count").toULongLong(), 1u);
+    ASSERT_EQ(dedup.value("max").toULongLong(), 2u);
+    ASSERT_FALSE(map.value("stages").toMap().contains("total"));
+    ASSERT_EQ(map.value("formatBytes").toMap().value("text/plain").toULongLong(), 15u);
+}
+
+TEST_F(TstCaptureStats, formats)
+{
+    CaptureStats &stats = CaptureStats::instance();
+    QList<QThread *> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.append(QThread::create([&stats] {
+            for (int n = 0; n < 1000; ++n)
+                stats.addFormatBytes(QStringLiteral("application/x-format-%1").arg(n % 100), 1);
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    // 槽位用完后的格式计入other，总数不丢失
+    const QVariantMap formatBytes = stats.toVariantMap().value("formatBytes").toMap();
+    ASSERT_TRUE(formatBytes.contains("other"));
+    quint64 total = 0;
+    for (const QVariant &bytes : formatBytes)
+        total += bytes.toULongLong();
+    ASSERT_EQ(total, 4000u);
+
+    stats.reset();
+    ASSERT_TRUE(stats.toVariantMap().value("formatBytes").toMap().isEmpty());
+}
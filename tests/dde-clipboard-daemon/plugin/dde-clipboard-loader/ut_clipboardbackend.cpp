@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "memoryclipboardbackend.h"
+#include "clipboardloader.h"
+#include "payloadtransport.h"
+#include "itemcodec.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QMimeData>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+static QMimeData *textMimeData(const QString &text)
+{
+    QMimeData *mimeData = new QMimeData;
+    mimeData->setText(text);
+    return mimeData;
+}
+
+class TstClipboardBackend : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        backend = new MemoryClipboardBackend();
+    }
+
+    void TearDown() override
+    {
+        delete backend;
+        backend = nullptr;
+    }
+
+public:
+    MemoryClipboardBackend *backend = nullptr;
+};
+
+TEST_F(TstClipboardBackend, offer)
+{
+    QSignalSpy spy(backend, &ClipboardBackend::dataChanged);
+    ASSERT_EQ(backend->mimeData(), nullptr);
+
+    backend->offer(textMimeData("now"));
+    ASSERT_EQ(spy.count(), 1);
+    ASSERT_EQ(backend->mimeData()->text(), QString("now"));
+
+    // 延时的数据按照时间顺序生效
+    backend->offer(textMimeData("later"), 40);
+    backend->offer(textMimeData("soon"), 10);
+    ASSERT_EQ(backend->pendingOfferCount(), 2);
+    QTRY_COMPARE(spy.count(), 2);
+    ASSERT_EQ(backend->mimeData()->text(), QString("soon"));
+    QTRY_COMPARE(spy.count(), 3);
+    ASSERT_EQ(backend->mimeData()->text(), QString("later"));
+    ASSERT_EQ(backend->pendingOfferCount(), 0);
+
+    // 未生效的数据随后端一起释放
+    backend->offer(textMimeData("never"), 1000);
+}
+
+TEST_F(TstClipboardBackend, setMimeData)
+{
+    QSignalSpy setSpy(backend, &MemoryClipboardBackend::mimeDataSet);
+    QSignalSpy changedSpy(backend, &ClipboardBackend::dataChanged);
+
+    backend->setMimeData(textMimeData("reborn"));
+    ASSERT_EQ(backend->setCount(), 1);
+    ASSERT_EQ(setSpy.count(), 1);
+    ASSERT_EQ(changedSpy.count(), 1);
+    ASSERT_EQ(backend->mimeData()->text(), QString("reborn"));
+}
+
+TEST_F(TstClipboardBackend, loader)
+{
+    qputenv("DDE_CLIPBOARD_CAPTURE_DEBOUNCE", "20");
+    qputenv("DDE_CLIPBOARD_CAPTURE_MAX_LATENCY", "1000");
+    // 后端的所有权转移给loader
+    MemoryClipboardBackend *memory = backend;
+    backend = nullptr;
+    ClipboardLoader loader(memory);
+    loader.ClearItems();
+    QSignalSpy spy(&loader, &ClipboardLoader::itemAdded);
+
+    // 连续的变化只采集最后一次
+    for (int i = 0; i < 100; ++i)
+        memory->offer(textMimeData(QString("backend %1").arg(i)));
+    QTRY_COMPARE(spy.count(), 1);
+    qlonglong cursorTime = 0;
+    qulonglong cursorId = 0;
+    bool hasMore = true;
+    ASSERT_EQ(loader.ListItemsBefore(0, 0, 10, cursorTime, cursorId, hasMore).size(), 1);
+    ASSERT_NE(cursorId, 0u);
+    ASSERT_FALSE(hasMore);
+
+    // 内容没有变化的通知不会产生新的数据
+    memory->notifyChanged();
+    QTest::qWait(100);
+    ASSERT_EQ(spy.count(), 1);
+
+    // 回写的数据通过后端写入剪贴板
+    QByteArray preview = spy.takeFirst().at(0).toByteArray();
+    QDataStream stream(&preview, QIODevice::ReadOnly);
+    stream.setVersion(QDataStream::Qt_5_11);
+    quint8 version = 0;
+    quint64 id = 0;
+    stream >> version >> id;
+    const PayloadTransport::MappedPayload payload(loader.FetchItem(id, {}));
+    ASSERT_TRUE(payload.isValid());
+    loader.dataReborned(QByteArray(payload.data().constData(), payload.data().size()));
+    ASSERT_EQ(memory->setCount(), 1);
+    ASSERT_EQ(memory->mimeData()->text(), QString("backend 99"));
+
+    qunsetenv("DDE_CLIPBOARD_CAPTURE_DEBOUNCE");
+    qunsetenv("DDE_CLIPBOARD_CAPTURE_MAX_LATENCY");
+    loader.ClearItems();
+}
+
+TEST_F(TstClipboardBackend, rebornUntrustedBlobFiles)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QFile secret(dir.path() + "/secret");
+    ASSERT_TRUE(secret.open(QIODevice::WriteOnly));
+    secret.write("secret");
+    secret.close();
+
+    MemoryClipboardBackend *memory = backend;
+    backend = nullptr;
+    ClipboardLoader loader(memory);
+
+    // 其他进程传入的数据中的缓存文件引用不会被读取
+    ItemInfo info;
+    info.m_type = Text;
+    info.m_text = "text";
+    info.m_formatMap.insert("text/plain", QByteArray());
+    info.m_blobFiles.insert("text/plain", secret.fileName());
+    loader.dataReborned(ItemCodec::encode(info));
+    ASSERT_EQ(memory->setCount(), 1);
+    ASSERT_TRUE(memory->mimeData()->data("text/plain").isEmpty());
+}
@@ -4,8 +4,10 @@
 
 #include <gtest/gtest.h>
 #include "clipboardloader.h"
+#include "payloadtransport.h"
 
 #include <QApplication>
+#include <QClipboard>
 #include <QMimeData>
 #include <QStyle>
 #include <QSignalSpy>
@@ -31,7 +33,7 @@ public:
 
 TEST_F(TstClipboardLoader, coverageTest)
 {
-    QPixmap srcPix;
+    QImage srcPix;
     ItemInfo info;
 
     loader->cachePixmap(srcPix, info);
@@ -42,13 +44,24 @@ TEST_F(TstClipboardLoader, setImageData)
     QStyle *style = QApplication::style();
     const QPixmap &srcPix = style->standardPixmap(QStyle::SP_DialogYesButton);
 
-    QSignalSpy spy(loader, &ClipboardLoader::dataComing);
+    QSignalSpy spy(loader, &ClipboardLoader::itemAdded);
     qApp->clipboard()->setPixmap(srcPix);
 
-    QVERIFY(spy.count() == 1);
+    // 数据在采集线程池中处理，需要等待结果返回
+    QTRY_COMPARE(spy.count(), 1);
 
-    QList<QVariant> arguments = spy.takeFirst();
-    QByteArray pixBuf = arguments.at(0).toByteArray();
+    // 通知中只有预览数据，完整数据需要通过id获取
+    QByteArray preview = spy.takeFirst().at(0).toByteArray();
+    QDataStream stream(&preview, QIODevice::ReadOnly);
+    stream.setVersion(QDataStream::Qt_5_11);
+    quint8 version = 0;
+    quint64 id = 0;
+    stream >> version >> id;
+    ASSERT_EQ(version, ItemPreviewVersion);
+
+    const PayloadTransport::MappedPayload payload(loader->FetchItem(id, {}));
+    ASSERT_TRUE(payload.isValid());
+    const QByteArray pixBuf(payload.data().constData(), payload.data().size());
 
     // 重设一张图片的数据，防止连续两张同样的图片被写入
     const QPixmap &applyBtnPix = style->standardPixmap(QStyle::SP_DialogApplyButton);
@@ -75,7 +88,7 @@ TEST_F(TstClipboardLoader, setImageData)
     fileMime->setData("text/uri-list", "1, 2");
     qApp->clipboard()->setMimeData(fileMime);
 
-    QSignalSpy systemDataCheckSpy(loader, &ClipboardLoader::dataComing);
+    QSignalSpy systemDataCheckSpy(loader, &ClipboardLoader::itemAdded);
     loader->setImageData(info, newData);
     QTest::qWait(10);
     QVERIFY(systemDataCheckSpy.count() == 0);
@@ -87,3 +100,24 @@ TEST_F(TstClipboardLoader, setImageData)
     newData = nullptr;
 }
 
+
+TEST(TstPayloadTransport, pack)
+{
+    // 较小的数据直接放在消息中
+    const QByteArray small(PayloadTransport::InlineThreshold - 1, 's');
+    const QDBusVariant smallPacked = PayloadTransport::pack(small);
+    ASSERT_EQ(smallPacked.variant().userType(), QMetaType::QByteArray);
+    const PayloadTransport::MappedPayload smallPayload(smallPacked);
+    ASSERT_TRUE(smallPayload.isValid());
+    ASSERT_EQ(smallPayload.data(), small);
+
+    // 较大的数据通过密封的memfd传递
+    const QByteArray large(PayloadTransport::InlineThreshold, 'l');
+    const QDBusVariant largePacked = PayloadTransport::pack(large);
+    ASSERT_EQ(largePacked.variant().userType(), qMetaTypeId<QDBusUnixFileDescriptor>());
+    const PayloadTransport::MappedPayload largePayload(largePacked);
+    ASSERT_TRUE(largePayload.isValid());
+    ASSERT_EQ(largePayload.data(), large);
+
+    ASSERT_FALSE(PayloadTransport::MappedPayload(QDBusVariant()).isValid());
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "contenthash.h"
+
+class TstContentHash : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+    }
+
+    void TearDown() override
+    {
+    }
+};
+
+TEST_F(TstContentHash, knownValues)
+{
+    // XXH64 官方测试数据
+    ASSERT_EQ(ContentHasher::hash(QByteArray()), 0xEF46DB3751D8E999ULL);
+    ASSERT_EQ(ContentHasher::hash(QByteArray("a")), 0xD24EC4F1A98C6E5BULL);
+    ASSERT_EQ(ContentHasher::hash(QByteArray("abc")), 0x44BC2CF5AD770999ULL);
+    ASSERT_EQ(ContentHasher::hash(QByteArray("Nobody inspects the spammish repetition")), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST_F(TstContentHash, streaming)
+{
+    QByteArray data(100 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i)
+        data[i] = static_cast<char>(i * 7 + 3);
+
+    const quint64 oneShot = ContentHasher::hash(data);
+    for (int step : {1, 3, 31, 32, 33, 4096}) {
+        ContentHasher hasher;
+        for (int i = 0; i < data.size(); i += step)
+            hasher.addData(data.constData() + i, qMin(step, int(data.size()) - i));
+        ASSERT_EQ(hasher.result(), oneShot) << "step:" << step;
+    }
+
+    data[data.size() / 2] = data[data.size() / 2] + 1;
+    ASSERT_NE(ContentHasher::hash(data), oneShot);
+}
+
+TEST_F(TstContentHash, imagePixels)
+{
+    QImage image(33, 17, QImage::Format_ARGB32);
+    image.fill(QColor(10, 20, 30));
+    image.setPixelColor(5, 5, Qt::red);
+
+    const quint64 argbHash = ContentHasher::hashImage(image);
+    ASSERT_NE(argbHash, 0u);
+
+    // 相同的像素以不同的格式提供时指纹相同
+    ASSERT_EQ(ContentHasher::hashImage(image.convertToFormat(QImage::Format_RGB32)), argbHash);
+    ASSERT_EQ(ContentHasher::hashImage(image.convertToFormat(QImage::Format_RGB888)), argbHash);
+
+    // 行尾带有填充数据的图片只计算有效像素
+    const qsizetype stride = image.bytesPerLine() + 64;
+    QByteArray padded(stride * image.height(), char(0x5a));
+    for (int y = 0; y < image.height(); ++y)
+        memcpy(padded.data() + y * stride, image.constScanLine(y), image.bytesPerLine());
+    QImage paddedImage(reinterpret_cast<const uchar *>(padded.constData()), image.width(), image.height(),
+                       stride, QImage::Format_ARGB32);
+    ASSERT_EQ(ContentHasher::hashImage(paddedImage), argbHash);
+
+    image.setPixelColor(6, 6, Qt::blue);
+    ASSERT_NE(ContentHasher::hashImage(image), argbHash);
+
+    ASSERT_EQ(ContentHasher::hashImage(QImage()), 0u);
+}
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "memoryclipboardbackend.h"
+#include "deferredformatfetcher.h"
+#include "mimepolicy.h"
+
+#include <QMimeData>
+#include <QSignalSpy>
+#include <QTest>
+
+static QMimeData *officeMimeData()
+{
+    QMimeData *mimeData = new QMimeData;
+    mimeData->setData("text/plain", "hello");
+    mimeData->setData("text/html", "<b>hello</b>");
+    mimeData->setData("text/rtf", "{\\rtf1 hello}");
+    mimeData->setData("application/x-office-object", QByteArray(1024, 'o'));
+    return mimeData;
+}
+
+class TstDeferredFormatFetcher : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        backend = new MemoryClipboardBackend();
+        fetcher = new DeferredFormatFetcher(backend);
+    }
+
+    void TearDown() override
+    {
+        delete fetcher;
+        fetcher = nullptr;
+        delete backend;
+        backend = nullptr;
+    }
+
+public:
+    MemoryClipboardBackend *backend = nullptr;
+    DeferredFormatFetcher *fetcher = nullptr;
+};
+
+TEST_F(TstDeferredFormatFetcher, policy)
+{
+    const QStringList formats = {"TIMESTAMP", "text/html", "text/plain;charset=utf-8", "text/plain",
+                                 "image/bmp", "image/png", "application/x-office-object"};
+    ASSERT_EQ(MimePolicy::imageFormat(formats), QString("image/png"));
+    ASSERT_EQ(MimePolicy::eagerFormats(formats),
+              QStringList({"TIMESTAMP", "text/plain;charset=utf-8", "text/plain", "image/png"}));
+    ASSERT_EQ(MimePolicy::deferredFormats(formats),
+              QStringList({"text/html", "image/bmp", "application/x-office-object"}));
+
+    // 没有纯文本时需要用html生成预览
+    ASSERT_TRUE(MimePolicy::eagerFormats({"text/html", "text/rtf"}).contains("text/html"));
+    ASSERT_TRUE(MimePolicy::imageFormat({"text/html"}).isEmpty());
+}
+
+TEST_F(TstDeferredFormatFetcher, fetch)
+{
+    backend->offer(officeMimeData());
+
+    QSignalSpy spy(fetcher, &DeferredFormatFetcher::finished);
+    fetcher->start(7, {"text/html", "text/rtf", "application/x-office-object", "application/x-missing"});
+    ASSERT_TRUE(fetcher->isRunning());
+
+    // 每次事件循环只读取一种格式，不会在start中同步完成
+    ASSERT_EQ(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    ASSERT_FALSE(fetcher->isRunning());
+
+    const QList<QVariant> arguments = spy.takeFirst();
+    ASSERT_EQ(arguments.at(0).toULongLong(), 7u);
+    const auto formatData = arguments.at(1).value<QMap<QString, QByteArray>>();
+    ASSERT_EQ(formatData.keys(), QStringList({"application/x-office-object", "text/html", "text/rtf"}));
+    ASSERT_EQ(formatData.value("text/html"), QByteArray("<b>hello</b>"));
+}
+
+TEST_F(TstDeferredFormatFetcher, pending)
+{
+    backend->offer(officeMimeData());
+    backend->setPendingFormats({"text/rtf"});
+
+    QSignalSpy spy(fetcher, &DeferredFormatFetcher::finished);
+    fetcher->start(7, {"text/html", "text/rtf"});
+
+    // 还在后台读取的格式等待后端读取结束
+    QTest::qWait(50);
+    ASSERT_EQ(spy.count(), 0);
+    ASSERT_TRUE(fetcher->isRunning());
+
+    backend->setPendingFormats({});
+    QTRY_COMPARE(spy.count(), 1);
+    const auto formatData = spy.takeFirst().at(1).value<QMap<QString, QByteArray>>();
+    ASSERT_EQ(formatData.keys(), QStringList({"text/html", "text/rtf"}));
+}
+
+TEST_F(TstDeferredFormatFetcher, cancel)
+{
+    backend->offer(officeMimeData());
+
+    QSignalSpy spy(fetcher, &DeferredFormatFetcher::finished);
+    fetcher->start(7, {"text/html", "text/rtf"});
+    fetcher->cancel();
+    ASSERT_FALSE(fetcher->isRunning());
+
+    QTest::qWait(50);
+    ASSERT_EQ(spy.count(), 0);
+}
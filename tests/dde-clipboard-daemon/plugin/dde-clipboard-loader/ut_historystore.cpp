@@ -0,0 +1,294 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "historystore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+class TstHistoryStore : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+    }
+
+    void TearDown() override
+    {
+    }
+
+    QString segmentFile() const
+    {
+        const QStringList names = QDir(dir.path()).entryList({"segment-*.log"}, QDir::Files, QDir::Name);
+        return names.isEmpty() ? QString() : dir.path() + "/" + names.last();
+    }
+
+public:
+    QTemporaryDir dir;
+};
+
+TEST_F(TstHistoryStore, reopen)
+{
+    {
+        HistoryStore store(dir.path());
+        ASSERT_TRUE(store.open());
+        ASSERT_TRUE(store.append(store.allocateId(), 11, 1, 1000, "first"));
+        ASSERT_TRUE(store.append(store.allocateId(), 22, 2, 2000, "second", {"/tmp/a.png"}));
+        ASSERT_TRUE(store.append(store.allocateId(), 33, 1, 3000, "third"));
+        ASSERT_TRUE(store.touch(1, 4000));
+        ASSERT_TRUE(store.remove(3));
+    }
+
+    HistoryStore store(dir.path());
+    ASSERT_TRUE(store.open());
+    ASSERT_EQ(store.ids(), QList<quint64>({1, 2}));
+    ASSERT_EQ(store.entry(1).time, 4000);
+    ASSERT_EQ(store.findByHash(22), 2u);
+    ASSERT_EQ(store.findByHash(33), 0u);
+    ASSERT_EQ(store.payload(2), QByteArray("second"));
+    ASSERT_EQ(store.files(2), QStringList({"/tmp/a.png"}));
+    ASSERT_EQ(store.referencedFiles(), QStringList({"/tmp/a.png"}));
+
+    // 新分配的id不能与已有的记录重复
+    ASSERT_GT(store.allocateId(), 3u);
+}
+
+TEST_F(TstHistoryStore, recover)
+{
+    {
+        HistoryStore store(dir.path());
+        ASSERT_TRUE(store.open());
+        ASSERT_TRUE(store.append(store.allocateId(), 11, 1, 1000, "first"));
+        ASSERT_TRUE(store.append(store.allocateId(), 22, 1, 2000, "second"));
+    }
+
+    // 模拟写入数据时进程退出，段文件末尾只写了一半
+    QFile segment(segmentFile());
+    ASSERT_TRUE(segment.open(QIODevice::ReadWrite));
+    const qint64 size = segment.size();
+    ASSERT_TRUE(segment.resize(size - 3));
+    segment.close();
+
+    {
+        HistoryStore store(dir.path());
+        ASSERT_TRUE(store.open());
+        ASSERT_EQ(store.ids(), QList<quint64>({1}));
+        ASSERT_EQ(store.payload(1), QByteArray("first"));
+        ASSERT_TRUE(store.append(store.allocateId(), 33, 1, 3000, "third"));
+    }
+
+    // 索引丢失时从段文件重建
+    ASSERT_TRUE(QFile::remove(dir.path() + "/index"));
+    HistoryStore store(dir.path());
+    ASSERT_TRUE(store.open());
+    ASSERT_EQ(store.count(), 2);
+    ASSERT_EQ(store.payload(store.findByHash(33)), QByteArray("third"));
+}
+
+TEST_F(TstHistoryStore, compact)
+{
+    const QByteArray payload(1024, 'x');
+    {
+        HistoryStore store(dir.path());
+        ASSERT_TRUE(store.open());
+        for (int i = 0; i < 100; ++i)
+            ASSERT_TRUE(store.append(store.allocateId(), i + 1, 1, i, payload + QByteArray::number(i)));
+        for (quint64 id = 1; id <= 90; ++id)
+            ASSERT_TRUE(store.remove(id));
+        ASSERT_TRUE(store.touch(95, 5000));
+
+        ASSERT_TRUE(store.compact(true));
+        ASSERT_EQ(store.deadBytes(), 0);
+        ASSERT_EQ(QFileInfo(segmentFile()).size(), store.liveBytes());
+        ASSERT_TRUE(store.append(store.allocateId(), 1000, 1, 6000, "after"));
+    }
+
+    HistoryStore store(dir.path());
+    ASSERT_TRUE(store.open());
+    ASSERT_EQ(store.count(), 11);
+    ASSERT_EQ(store.ids().first(), 101u);
+    ASSERT_EQ(store.ids().at(1), 95u);
+    ASSERT_EQ(store.entry(95).time, 5000);
+    ASSERT_EQ(store.payload(91), payload + "90");
+
+    store.clear();
+    ASSERT_EQ(store.count(), 0);
+}
+
+TEST_F(TstHistoryStore, page)
+{
+    HistoryStore store(dir.path());
+    ASSERT_TRUE(store.open());
+    for (int i = 0; i < 5; ++i)
+        ASSERT_TRUE(store.append(store.allocateId(), i + 1, 1, i, "item"));
+
+    ASSERT_EQ(store.idsBefore(0, 0, 2), QList<quint64>({5, 4}));
+    ASSERT_EQ(store.idsBefore(3, 4, 10), QList<quint64>({3, 2, 1}));
+    ASSERT_TRUE(store.idsBefore(0, 1, 10).isEmpty());
+
+    // 重复复制的记录排在最前面，已经获取过的页之后不会再出现
+    ASSERT_TRUE(store.touch(2, 100));
+    ASSERT_EQ(store.idsBefore(0, 0, 2), QList<quint64>({2, 5}));
+    ASSERT_EQ(store.idsBefore(3, 4, 10), QList<quint64>({3, 1}));
+    ASSERT_EQ(store.idsSince(4), QList<quint64>({2, 5}));
+
+    // 记录已被删除时返回之后新增的记录
+    ASSERT_TRUE(store.remove(4));
+    ASSERT_EQ(store.idsSince(4), QList<quint64>({5}));
+    ASSERT_EQ(store.idsSince(5), QList<quint64>({2}));
+}
+
+TEST_F(TstHistoryStore, replace)
+{
+    HistoryStore store(dir.path());
+    ASSERT_TRUE(store.open());
+    ASSERT_TRUE(store.append(store.allocateId(), 11, 1, 1000, "first", {"/tmp/a.png"}));
+    ASSERT_TRUE(store.append(store.allocateId(), 22, 1, 2000, "second"));
+
+    QStringList released;
+    QObject::connect(&store, &HistoryStore::filesReleased, [&released](const QStringList &files) {
+        released += files;
+    });
+
+    // 补充延后读取的格式后，记录的位置、指纹和时间不变
+    ASSERT_TRUE(store.replace(1, "first with more formats", {"/tmp/a.png", "/tmp/b.html"}));
+    ASSERT_EQ(store.ids(), QList<quint64>({2, 1}));
+    ASSERT_EQ(store.payload(1), QByteArray("first with more formats"));
+    ASSERT_EQ(store.payloadView(1), QByteArray("first with more formats"));
+    ASSERT_TRUE(store.payloadView(3).isEmpty());
+    ASSERT_EQ(store.findByHash(11), 1u);
+    ASSERT_EQ(store.entry(1).time, 1000);
+    ASSERT_EQ(store.files(1), QStringList({"/tmp/a.png", "/tmp/b.html"}));
+    ASSERT_EQ(released, QStringList({"/tmp/a.png"}));
+
+    ASSERT_FALSE(store.replace(3, "missing"));
+}
+
+TEST_F(TstHistoryStore, extend)
+{
+    {
+        HistoryStore store(dir.path());
+        ASSERT_TRUE(store.open());
+        ASSERT_TRUE(store.append(store.allocateId(), 11, 1, 1000, "first", {"/tmp/a.png"}));
+        ASSERT_TRUE(store.append(store.allocateId(), 22, 1, 2000, "second"));
+
+        // 只追加新增的部分，读取时拼接在原有数据之后
+        const qint64 size = QFileInfo(segmentFile()).size();
+        ASSERT_TRUE(store.extend(1, " more", {"/tmp/b.html"}));
+        ASSERT_TRUE(store.extend(1, " formats"));
+        ASSERT_LT(QFileInfo(segmentFile()).size() - size, 2 * 48 + 64);
+        ASSERT_EQ(store.ids(), QList<quint64>({2, 1}));
+        ASSERT_EQ(store.payload(1), QByteArray("first more formats"));
+        ASSERT_EQ(store.payloadView(1), QByteArray("first more formats"));
+        ASSERT_EQ(store.files(1), QStringList({"/tmp/a.png", "/tmp/b.html"}));
+        ASSERT_EQ(store.referencedFiles(), QStringList({"/tmp/a.png", "/tmp/b.html"}));
+        ASSERT_FALSE(store.extend(3, "missing"));
+    }
+
+    {
+        // 重新打开后追加的部分仍然有效，压缩时合并为一条记录
+        HistoryStore store(dir.path());
+        ASSERT_TRUE(store.open());
+        ASSERT_EQ(store.payload(1), QByteArray("first more formats"));
+        ASSERT_TRUE(store.compact(true));
+        ASSERT_EQ(QFileInfo(segmentFile()).size(), store.liveBytes());
+        ASSERT_EQ(store.payloadView(1), QByteArray("first more formats"));
+        ASSERT_EQ(store.files(1), QStringList({"/tmp/a.png", "/tmp/b.html"}));
+    }
+
+    HistoryStore store(dir.path());
+    ASSERT_TRUE(store.open());
+    ASSERT_EQ(store.payload(1), QByteArray("first more formats"));
+
+    QStringList released;
+    QObject::connect(&store, &HistoryStore::filesReleased, [&released](const QStringList &files) {
+        released += files;
+    });
+    ASSERT_TRUE(store.extend(1, " again", {"/tmp/c.txt"}));
+    ASSERT_TRUE(store.remove(1));
+    ASSERT_EQ(released, QStringList({"/tmp/a.png", "/tmp/b.html", "/tmp/c.txt"}));
+    ASSERT_TRUE(store.payload(1).isEmpty());
+}
+
+TEST_F(TstHistoryStore, retention)
+{
+    const QString blob = dir.filePath("blob");
+    QFile file(blob);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(file.write(QByteArray(4096, 'b')), 4096);
+    file.close();
+
+    HistoryStore store(dir.path() + "/history");
+    ASSERT_TRUE(store.open());
+    QStringList released;
+    QObject::connect(&store, &HistoryStore::filesReleased, [&released](const QStringList &files) {
+        released += files;
+    });
+
+    // 超过数量上限时从最旧的开始删除
+    for (int i = 0; i < 5; ++i)
+        ASSERT_TRUE(store.append(store.allocateId(), i + 1, 1, i, "item", i == 0 ? QStringList({blob}) : QStringList()));
+    store.setRetention(3, 0);
+    ASSERT_EQ(store.trim(), QList<quint64>({1, 2}));
+    ASSERT_EQ(store.ids(), QList<quint64>({5, 4, 3}));
+    ASSERT_EQ(released, QStringList({blob}));
+
+    // 大小包括引用的缓存文件，最新的一条总是保留
+    ASSERT_TRUE(store.append(store.allocateId(), 6, 1, 6, "large", {blob}));
+    store.setRetention(0, 4096);
+    ASSERT_EQ(store.trim(), QList<quint64>({3, 4, 5}));
+    ASSERT_EQ(store.ids(), QList<quint64>({6}));
+
+    // 只有所有者可以访问
+    ASSERT_FALSE(QFileInfo(dir.path() + "/history").permissions() & (QFileDevice::ExeGroup | QFileDevice::ExeOther));
+    ASSERT_FALSE(QFileInfo(dir.path() + "/history/index").permissions() & (QFileDevice::ReadGroup | QFileDevice::ReadOther));
+    const QStringList segments = QDir(dir.path() + "/history").entryList({"segment-*.log"}, QDir::Files);
+    ASSERT_FALSE(segments.isEmpty());
+    for (const QString &segment : segments)
+        ASSERT_FALSE(QFileInfo(dir.path() + "/history/" + segment).permissions() & (QFileDevice::ReadGroup | QFileDevice::ReadOther));
+}
+
+TEST_F(TstHistoryStore, wipe)
+{
+    auto segmentsContain = [this](const QByteArray &data) {
+        const QStringList names = QDir(dir.path()).entryList({"segment-*.log"}, QDir::Files);
+        for (const QString &name : names) {
+            QFile file(dir.path() + "/" + name);
+            if (file.open(QIODevice::ReadOnly) && file.readAll().contains(data))
+                return true;
+        }
+        return false;
+    };
+
+    {
+        HistoryStore store(dir.path());
+        ASSERT_TRUE(store.open());
+        ASSERT_TRUE(store.append(store.allocateId(), 11, 1, 1000, "removed secret"));
+        ASSERT_TRUE(store.append(store.allocateId(), 22, 1, 2000, "replaced secret"));
+        ASSERT_TRUE(store.append(store.allocateId(), 33, 1, 3000, "kept"));
+
+        // 删除和替换后旧的数据内容不再留在段文件中
+        ASSERT_TRUE(store.remove(1));
+        ASSERT_TRUE(store.replace(2, "replaced"));
+        ASSERT_FALSE(segmentsContain("removed secret"));
+        ASSERT_FALSE(segmentsContain("replaced secret"));
+        ASSERT_TRUE(segmentsContain("kept"));
+    }
+
+    // 清除数据内容后的记录仍然可以用来重建索引
+    ASSERT_TRUE(QFile::remove(dir.path() + "/index"));
+    HistoryStore store(dir.path());
+    ASSERT_TRUE(store.open());
+    ASSERT_EQ(store.ids(), QList<quint64>({3, 2}));
+    ASSERT_EQ(store.payload(2), QByteArray("replaced"));
+
+    // 清空时立即压缩
+    store.clear();
+    ASSERT_FALSE(segmentsContain("kept"));
+    ASSERT_FALSE(segmentsContain("replaced"));
+}
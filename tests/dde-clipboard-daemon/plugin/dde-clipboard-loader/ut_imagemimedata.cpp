@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "imagemimedata.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QImageWriter>
+#include <QTemporaryDir>
+
+class TstImageMimeData : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        ImageMimeData::clearTranscodeCache();
+
+        QImage image(64, 32, QImage::Format_RGB32);
+        image.fill(Qt::red);
+        QBuffer buf(&png);
+        buf.open(QIODevice::WriteOnly);
+        ASSERT_TRUE(image.save(&buf, "PNG"));
+
+        pngFile = dir.path() + "/image.png";
+        QFile file(pngFile);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(png);
+    }
+
+    void TearDown() override
+    {
+        ImageMimeData::clearTranscodeCache();
+    }
+
+public:
+    QTemporaryDir dir;
+    QString pngFile;
+    QByteArray png;
+};
+
+TEST_F(TstImageMimeData, passthrough)
+{
+    ImageMimeData mimeData(pngFile);
+    mimeData.setData("image/jpeg", "original jpeg");
+    mimeData.setData("image/png", QByteArray());
+
+    ASSERT_TRUE(mimeData.hasImage());
+    ASSERT_TRUE(mimeData.hasFormat("application/x-qt-image"));
+    ASSERT_EQ(mimeData.formats().count("image/png"), 1);
+
+    // 缓存文件和来源提供的原始数据原样返回，不经过编码
+    ASSERT_EQ(mimeData.data("image/png"), png);
+    ASSERT_EQ(mimeData.data("application/x-qt-image"), png);
+    ASSERT_EQ(mimeData.data("image/jpeg"), QByteArray("original jpeg"));
+
+    const QImage image = qvariant_cast<QImage>(mimeData.imageData());
+    ASSERT_EQ(image.size(), QSize(64, 32));
+}
+
+TEST_F(TstImageMimeData, transcode)
+{
+    if (!QImageWriter::supportedImageFormats().contains("bmp"))
+        GTEST_SKIP();
+
+    ImageMimeData mimeData(pngFile);
+    const QByteArray bmp = mimeData.data("image/bmp");
+    ASSERT_TRUE(bmp.startsWith("BM"));
+
+    // 转换结果按照缓存文件缓存，缓存文件删除后仍然返回第一次转换的结果
+    QFile::remove(pngFile);
+    ImageMimeData other(pngFile);
+    ASSERT_EQ(other.data("image/bmp"), bmp);
+    ASSERT_TRUE(other.data("image/png").isEmpty());
+
+    ImageMimeData::clearTranscodeCache();
+    ASSERT_TRUE(other.data("image/bmp").isEmpty());
+}
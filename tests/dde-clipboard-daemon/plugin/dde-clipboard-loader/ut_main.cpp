@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include <QApplication>
+#include <QStandardPaths>
 #include <QDebug>
 
 #ifdef QT_DEBUG
@@ -16,6 +17,8 @@ int main(int argc, char *argv[])
     // gerrit编译时没有显示器，需要指定环境变量
     qputenv("QT_QPA_PLATFORM", "offscreen");
     QApplication app(argc,argv);
+    // 历史记录和缓存文件写入测试目录，不影响当前用户的剪贴板数据
+    QStandardPaths::setTestModeEnabled(true);
     qDebug() << "start dde-clipboardloader test cases ..............";
     ::testing::InitGoogleTest(&argc, argv);
     int ret = RUN_ALL_TESTS();
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "wlrintegration/pastescheduler.h"
+#include "wlrintegration/pastetransfer.h"
+
+#include <QTest>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+class TstPasteScheduler : public testing::Test
+{
+public:
+    void TearDown() override
+    {
+        for (int fd : readEnds)
+            close(fd);
+    }
+
+    // 创建一个写入管道的传输，读取端由测试持有，不读取数据
+    PasteTransfer *transfer(const QByteArray &data)
+    {
+        int fds[2];
+        EXPECT_EQ(pipe2(fds, O_CLOEXEC), 0);
+        readEnds.append(fds[0]);
+        PasteTransfer *transfer = new PasteTransfer(fds[1]);
+        transfer->setData(data);
+        return transfer;
+    }
+
+public:
+    QList<int> readEnds;
+};
+
+TEST_F(TstPasteScheduler, completed)
+{
+    PasteScheduler scheduler;
+    scheduler.submit(transfer("small"));
+    scheduler.submit(transfer("data"));
+
+    // 数据小于管道容量，提交时即可写完
+    ASSERT_EQ(scheduler.activeCount(), 0);
+    ASSERT_EQ(scheduler.completedCount(), 2u);
+    ASSERT_EQ(scheduler.bytesServed(), 9u);
+
+    const QVariantMap stats = scheduler.stats();
+    ASSERT_EQ(stats.value("completed").toULongLong(), 2u);
+    ASSERT_EQ(stats.value("aborted").toULongLong(), 0u);
+
+    scheduler.resetStats();
+    ASSERT_EQ(scheduler.completedCount(), 0u);
+    ASSERT_EQ(scheduler.bytesServed(), 0u);
+}
+
+TEST_F(TstPasteScheduler, bounded)
+{
+    PasteScheduler scheduler;
+    scheduler.setMaxActive(2);
+    scheduler.setMaxQueued(1);
+    scheduler.setIdleTimeout(100);
+
+    // 读取端不读取数据，超过管道容量的部分无法写入
+    const QByteArray data(1024 * 1024, 'x');
+    for (int i = 0; i < 4; ++i)
+        scheduler.submit(transfer(data));
+
+    ASSERT_EQ(scheduler.activeCount(), 2);
+    ASSERT_EQ(scheduler.queuedCount(), 1);
+    ASSERT_EQ(scheduler.abortedCount(), 1u);
+
+    // 长时间没有进展的传输被取消，排队的传输随后开始，最终也被取消
+    QTRY_COMPARE_WITH_TIMEOUT(scheduler.abortedCount(), 4u, 10000);
+    ASSERT_EQ(scheduler.activeCount(), 0);
+    ASSERT_EQ(scheduler.queuedCount(), 0);
+    ASSERT_GT(scheduler.bytesServed(), 0u);
+}
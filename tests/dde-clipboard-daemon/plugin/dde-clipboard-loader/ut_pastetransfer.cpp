@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "wlrintegration/pastetransfer.h"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QSocketNotifier>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <csignal>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+class TstPasteTransfer : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_EQ(pipe2(fds, O_CLOEXEC), 0);
+        ASSERT_EQ(fcntl(fds[0], F_SETFL, O_NONBLOCK), 0);
+    }
+
+    void TearDown() override
+    {
+        if (fds[0] >= 0)
+            close(fds[0]);
+    }
+
+    // 在事件循环中读取管道中的数据，直到写入端关闭
+    QByteArray readAll(PasteTransfer *transfer)
+    {
+        QByteArray result;
+        QSocketNotifier notifier(fds[0], QSocketNotifier::Read);
+        bool closed = false;
+        QObject::connect(&notifier, &QSocketNotifier::activated, [&] {
+            char buf[65536];
+            for (;;) {
+                const ssize_t n = read(fds[0], buf, sizeof(buf));
+                if (n > 0) {
+                    result.append(buf, n);
+                    continue;
+                }
+                if (n == 0)
+                    closed = true;
+                break;
+            }
+        });
+        transfer->start();
+        EXPECT_TRUE(QTest::qWaitFor([&closed] { return closed; }, 5000));
+        return result;
+    }
+
+public:
+    int fds[2] = {-1, -1};
+};
+
+TEST_F(TstPasteTransfer, data)
+{
+    // 数据大于管道容量，需要分多次写入
+    const QByteArray data(1024 * 1024 + 7, 'x');
+    PasteTransfer transfer(fds[1]);
+    transfer.setData(data);
+    QSignalSpy spy(&transfer, &PasteTransfer::finished);
+
+    ASSERT_EQ(readAll(&transfer), data);
+    ASSERT_EQ(spy.count(), 1);
+    ASSERT_TRUE(spy.first().at(0).toBool());
+    ASSERT_TRUE(transfer.isFinished());
+}
+
+TEST_F(TstPasteTransfer, file)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QByteArray data;
+    for (int i = 0; i < 100000; ++i)
+        data.append(QByteArray::number(i));
+
+    QFile file(dir.path() + "/blob");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(data);
+    file.close();
+
+    PasteTransfer transfer(fds[1]);
+    ASSERT_TRUE(transfer.setFile(file.fileName()));
+    ASSERT_EQ(transfer.size(), data.size());
+    ASSERT_FALSE(PasteTransfer(dup(fds[1])).setFile(dir.path() + "/missing"));
+
+    ASSERT_EQ(readAll(&transfer), data);
+    ASSERT_EQ(transfer.written(), data.size());
+}
+
+TEST_F(TstPasteTransfer, fileDescriptor)
+{
+    // 读取剪贴板时保存在memfd中的数据直接从描述符发送，调用方保留原来的描述符
+    const QByteArray data(512 * 1024 + 3, 'm');
+    const int memfd = memfd_create("ut-paste", MFD_CLOEXEC);
+    ASSERT_GE(memfd, 0);
+    ASSERT_EQ(write(memfd, data.constData(), data.size()), data.size());
+
+    PasteTransfer transfer(fds[1]);
+    ASSERT_TRUE(transfer.setFileDescriptor(memfd));
+    ASSERT_EQ(transfer.size(), data.size());
+    ASSERT_FALSE(PasteTransfer(dup(fds[1])).setFileDescriptor(-1));
+
+    ASSERT_EQ(readAll(&transfer), data);
+    ASSERT_GE(fcntl(memfd, F_GETFD), 0);
+    close(memfd);
+}
+
+TEST_F(TstPasteTransfer, readerClosed)
+{
+    // 目标程序关闭管道后传输失败，不会阻塞
+    close(fds[0]);
+    fds[0] = -1;
+
+    PasteTransfer transfer(fds[1]);
+    transfer.setData(QByteArray(1024, 'x'));
+    QSignalSpy spy(&transfer, &PasteTransfer::finished);
+    signal(SIGPIPE, SIG_IGN);
+    transfer.start();
+    ASSERT_EQ(spy.count(), 1);
+    ASSERT_FALSE(spy.first().at(0).toBool());
+}
@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "iconloader.h"
+#include "itemdata.h"
+#include "itemcodec.h"
+
+#include <QImage>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+class TstIconLoader : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        path = dir.filePath("thumbnail.png");
+
+        QImage image(1920, 1080, QImage::Format_RGB32);
+        image.fill(Qt::red);
+        ASSERT_TRUE(image.save(path));
+    }
+
+    ItemData *fileItem(const QList<QUrl> &urls)
+    {
+        ItemInfo info;
+        info.m_formatMap.insert("text/uri-list", QByteArray());
+        info.m_type = File;
+        info.m_urls = urls;
+        info.m_enable = true;
+        return new ItemData(ItemCodec::encode(info));
+    }
+
+public:
+    QTemporaryDir dir;
+    QString path;
+};
+
+TEST_F(TstIconLoader, thumbnail)
+{
+    QScopedPointer<ItemData> data(fileItem({QUrl::fromLocalFile(path)}));
+    ASSERT_EQ(data->type(), File);
+    ASSERT_TRUE(data->pixmap().isNull());
+
+    QSignalSpy spy(data.data(), &ItemData::contentLoaded);
+    IconLoader::instance()->request(data.data());
+    ASSERT_TRUE(IconLoader::instance()->isLoading(data.data()));
+    ASSERT_TRUE(spy.wait(5000));
+    ASSERT_FALSE(IconLoader::instance()->isLoading(data.data()));
+
+    // 缩略图只保留显示需要的大小
+    const QPixmap pix = data->pixmap();
+    ASSERT_FALSE(pix.isNull());
+    ASSERT_LE(pix.width(), PixmapWidth * 2);
+    ASSERT_LE(pix.height(), PixmapHeight * 2);
+}
+
+TEST_F(TstIconLoader, cancel)
+{
+    QScopedPointer<ItemData> data(fileItem({QUrl::fromLocalFile(path), QUrl::fromLocalFile(dir.filePath("missing.txt"))}));
+    QSignalSpy spy(data.data(), &ItemData::contentLoaded);
+
+    IconLoader::instance()->request(data.data());
+    IconLoader::instance()->cancel(data.data());
+    ASSERT_FALSE(IconLoader::instance()->isLoading(data.data()));
+    ASSERT_FALSE(spy.wait(500));
+    ASSERT_TRUE(data->FileIcons().isEmpty());
+
+    // 剪切块释放时取消请求
+    IconLoader::instance()->request(data.data());
+    ItemData *released = data.take();
+    delete released;
+    ASSERT_FALSE(IconLoader::instance()->isLoading(released));
+}
+
+TEST_F(TstIconLoader, placeholders)
+{
+    const QList<QUrl> urls = {QUrl::fromLocalFile("/nonexistent/a.png"), QUrl::fromLocalFile("/nonexistent/b.txt"),
+                              QUrl::fromLocalFile("/nonexistent/c"), QUrl::fromLocalFile("/nonexistent/d")};
+    ASSERT_EQ(IconLoader::placeholders(urls).size(), 3);
+    ASSERT_EQ(IconLoader::placeholders(urls.mid(0, 1)).size(), 1);
+}
+
+TEST_F(TstIconLoader, thumbnailCache)
+{
+    const bool hasCacheHome = qEnvironmentVariableIsSet("XDG_CACHE_HOME");
+    const QByteArray cacheHome = qgetenv("XDG_CACHE_HOME");
+    qputenv("XDG_CACHE_HOME", dir.filePath("cache").toLocal8Bit());
+
+    // 按显示大小解码，并按规范写回large缩略图
+    QImage image = IconLoader::loadThumbnail(path, QSize(PixmapWidth, PixmapHeight));
+    ASSERT_LE(image.width(), PixmapWidth);
+    ASSERT_LE(image.height(), PixmapHeight);
+
+    const QString uri = QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded);
+    const QString thumbnailPath = dir.filePath("cache/thumbnails/large/")
+                                  + QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Md5).toHex() + ".png";
+    QImage saved(thumbnailPath);
+    ASSERT_FALSE(saved.isNull());
+    ASSERT_EQ(qMax(saved.width(), saved.height()), 256);
+    ASSERT_EQ(saved.text("Thumb::URI"), uri);
+    ASSERT_EQ(saved.text("Thumb::MTime"), QString::number(QFileInfo(path).lastModified().toSecsSinceEpoch()));
+
+    // 已有的缩略图直接使用
+    QImage thumbnail(10, 10, QImage::Format_RGB32);
+    thumbnail.fill(Qt::blue);
+    thumbnail.setText("Thumb::URI", uri);
+    thumbnail.setText("Thumb::MTime", saved.text("Thumb::MTime"));
+    ASSERT_TRUE(thumbnail.save(thumbnailPath));
+    ASSERT_EQ(IconLoader::loadThumbnail(path, QSize(PixmapWidth, PixmapHeight)).size(), QSize(10, 10));
+
+    // 修改时间不一致时重新解码
+    thumbnail.setText("Thumb::MTime", "0");
+    ASSERT_TRUE(thumbnail.save(thumbnailPath));
+    ASSERT_NE(IconLoader::loadThumbnail(path, QSize(PixmapWidth, PixmapHeight)).size(), QSize(10, 10));
+
+    // 竖向图片按显示大小解码时长边不足256，写回的缩略图仍然是完整的large大小
+    const QString portraitPath = dir.filePath("portrait.png");
+    QImage portrait(1000, 2000, QImage::Format_RGB32);
+    portrait.fill(Qt::green);
+    ASSERT_TRUE(portrait.save(portraitPath));
+    image = IconLoader::loadThumbnail(portraitPath, QSize(PixmapWidth, PixmapHeight));
+    ASSERT_LE(image.height(), PixmapHeight);
+
+    const QString portraitUri = QUrl::fromLocalFile(portraitPath).toString(QUrl::FullyEncoded);
+    QImage portraitSaved(dir.filePath("cache/thumbnails/large/")
+                         + QCryptographicHash::hash(portraitUri.toUtf8(), QCryptographicHash::Md5).toHex() + ".png");
+    ASSERT_EQ(portraitSaved.height(), 256);
+
+    if (hasCacheHome) {
+        qputenv("XDG_CACHE_HOME", cacheHome);
+    } else {
+        qunsetenv("XDG_CACHE_HOME");
+    }
+}
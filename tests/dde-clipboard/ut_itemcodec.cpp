@@ -0,0 +1,199 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "itemcodec.h"
+
+#include <QDataStream>
+#include <QImage>
+#include <QtEndian>
+
+class TstItemCodec : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        info.m_formatMap.insert("text/plain", "hello clipboard");
+        info.m_formatMap.insert("text/html", "<b>hello clipboard</b>");
+        info.m_type = Text;
+        info.m_urls << QUrl("file:///tmp/a b.txt") << QUrl("file:///tmp/c.txt");
+        info.m_enable = true;
+        info.m_text = QString::fromUtf8("hello 剪贴板");
+        info.m_createTime = QDateTime::fromMSecsSinceEpoch(1700000000123);
+        info.m_hash = 0x1234567890abcdefULL;
+        info.m_id = 42;
+    }
+
+public:
+    ItemInfo info;
+};
+
+TEST_F(TstItemCodec, roundTrip)
+{
+    const QByteArray buf = ItemCodec::encode(info);
+    ASSERT_EQ(qFromLittleEndian<quint32>(buf.constData()), ItemCodec::Magic);
+
+    bool ok = false;
+    const ItemInfo decoded = ItemCodec::decode(buf, ItemCodec::NoDecodeFlags, QStringList(), &ok);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(decoded.m_formatMap, info.m_formatMap);
+    ASSERT_EQ(decoded.m_type, info.m_type);
+    ASSERT_EQ(decoded.m_urls, info.m_urls);
+    ASSERT_FALSE(decoded.m_hasImage);
+    ASSERT_TRUE(decoded.m_enable);
+    ASSERT_EQ(decoded.m_text, info.m_text);
+    ASSERT_EQ(decoded.m_createTime, info.m_createTime);
+    ASSERT_EQ(decoded.m_hash, info.m_hash);
+    ASSERT_EQ(decoded.m_id, info.m_id);
+}
+
+TEST_F(TstItemCodec, image)
+{
+    QImage image(16, 8, QImage::Format_RGB32);
+    image.fill(Qt::blue);
+    info.m_type = Image;
+    info.m_hasImage = true;
+    info.m_variantImage = image;
+    info.m_pixSize = QSize(1600, 800);
+    info.m_createTime = QDateTime();
+
+    const ItemInfo decoded = ItemCodec::decode(ItemCodec::encode(info));
+    ASSERT_TRUE(decoded.m_hasImage);
+    ASSERT_EQ(qvariant_cast<QImage>(decoded.m_variantImage).size(), image.size());
+    ASSERT_EQ(decoded.m_pixSize, info.m_pixSize);
+    ASSERT_FALSE(decoded.m_createTime.isValid());
+}
+
+TEST_F(TstItemCodec, legacy)
+{
+    // 升级前保存的历史记录
+    QByteArray buf;
+    QDataStream stream(&buf, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_11);
+    stream << info.m_formatMap
+           << info.m_type
+           << info.m_urls
+           << false
+           << info.m_enable
+           << info.m_text
+           << info.m_createTime
+           << QByteArray();
+
+    bool ok = false;
+    ItemInfo decoded = ItemCodec::decode(buf, ItemCodec::NoDecodeFlags, QStringList(), &ok);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(decoded.m_formatMap, info.m_formatMap);
+    ASSERT_EQ(decoded.m_urls, info.m_urls);
+    ASSERT_EQ(decoded.m_text, info.m_text);
+    ASSERT_EQ(decoded.m_hash, 0u);
+    ASSERT_EQ(decoded.m_id, 0u);
+
+    stream << info.m_hash << info.m_id;
+    decoded = ItemCodec::decode(buf, ItemCodec::NoDecodeFlags, {"text/html"});
+    ASSERT_EQ(decoded.m_formatMap.keys(), QStringList{"text/html"});
+    ASSERT_EQ(decoded.m_hash, info.m_hash);
+    ASSERT_EQ(decoded.m_id, info.m_id);
+}
+
+TEST_F(TstItemCodec, unknownField)
+{
+    // 新版本增加的字段被跳过
+    QByteArray buf = ItemCodec::encode(info);
+    const char field[] = {char(0xff), char(0x7f), 3, 0, 0, 0, 'n', 'e', 'w'};
+    buf.insert(6, field, sizeof(field));
+
+    bool ok = false;
+    const ItemInfo decoded = ItemCodec::decode(buf, ItemCodec::NoDecodeFlags, QStringList(), &ok);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(decoded.m_formatMap, info.m_formatMap);
+    ASSERT_EQ(decoded.m_id, info.m_id);
+}
+
+TEST_F(TstItemCodec, truncated)
+{
+    const QByteArray buf = ItemCodec::encode(info);
+    bool ok = true;
+    ItemCodec::decode(buf.left(buf.size() - 3), ItemCodec::NoDecodeFlags, QStringList(), &ok);
+    ASSERT_FALSE(ok);
+
+    ok = true;
+    ItemCodec::decode(buf.left(7), ItemCodec::NoDecodeFlags, QStringList(), &ok);
+    ASSERT_FALSE(ok);
+}
+
+TEST_F(TstItemCodec, zeroCopy)
+{
+    info.m_formatMap.insert("application/octet-stream", QByteArray(4096, 'x'));
+    const QByteArray buf = ItemCodec::encode(info);
+    const char *begin = buf.constData();
+    const char *end = begin + buf.size();
+
+    const ItemInfo decoded = ItemCodec::decode(buf, ItemCodec::ZeroCopy, {"application/octet-stream", "text/plain"});
+    ASSERT_EQ(decoded.m_formatMap.size(), 2);
+    for (const QByteArray &data : decoded.m_formatMap) {
+        ASSERT_GE(data.constData(), begin);
+        ASSERT_LE(data.constData() + data.size(), end);
+    }
+    ASSERT_EQ(decoded.m_formatMap.value("application/octet-stream"), QByteArray(4096, 'x'));
+    ASSERT_EQ(decoded.m_text, info.m_text);
+}
+
+TEST_F(TstItemCodec, blobFiles)
+{
+    info.m_formatMap.insert("application/x-large", QByteArray());
+    info.m_blobFiles.insert("application/x-large", "/tmp/blob");
+    const QByteArray buf = ItemCodec::encode(info);
+
+    // 默认不解析缓存文件的引用，其他进程传入的数据不能指定daemon读取的文件
+    ASSERT_TRUE(ItemCodec::decode(buf).m_blobFiles.isEmpty());
+
+    bool ok = false;
+    ItemInfo decoded = ItemCodec::decode(buf, ItemCodec::BlobFiles, QStringList(), &ok);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(decoded.m_blobFiles, info.m_blobFiles);
+    ASSERT_EQ(decoded.m_formatMap.value("application/x-large"), QByteArray());
+
+    decoded = ItemCodec::decode(buf, ItemCodec::BlobFiles, {"text/plain"});
+    ASSERT_TRUE(decoded.m_blobFiles.isEmpty());
+}
+
+TEST_F(TstItemCodec, appendFormats)
+{
+    // 追加的格式字段与原有的格式合并
+    const QByteArray buf = ItemCodec::encode(info)
+            + ItemCodec::encodeFormats({{"application/x-extra", "extra"}, {"application/x-large", QByteArray()}},
+                                       {{"application/x-large", "/tmp/blob"}});
+
+    bool ok = false;
+    const ItemInfo decoded = ItemCodec::decode(buf, ItemCodec::BlobFiles, QStringList(), &ok);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(decoded.m_formatMap.size(), 4);
+    ASSERT_EQ(decoded.m_formatMap.value("text/plain"), info.m_formatMap.value("text/plain"));
+    ASSERT_EQ(decoded.m_formatMap.value("application/x-extra"), QByteArray("extra"));
+    ASSERT_EQ(decoded.m_blobFiles.value("application/x-large"), QString("/tmp/blob"));
+    ASSERT_EQ(decoded.m_text, info.m_text);
+    ASSERT_EQ(decoded.m_id, info.m_id);
+}
+
+TEST_F(TstItemCodec, preview)
+{
+    info.m_text = QString(PreviewTextLength * 2, 'a');
+    info.m_formatMap.insert("x-dfm-copied/file-icons", "icons");
+
+    ItemInfo decoded;
+    qint64 textLength = 0;
+    ASSERT_TRUE(ItemCodec::decodePreview(ItemCodec::encodePreview(info), decoded, &textLength));
+    ASSERT_EQ(decoded.m_id, info.m_id);
+    ASSERT_EQ(decoded.m_hash, info.m_hash);
+    ASSERT_EQ(decoded.m_urls, info.m_urls);
+    ASSERT_EQ(decoded.m_text.size(), PreviewTextLength);
+    ASSERT_EQ(textLength, PreviewTextLength * 2);
+    ASSERT_EQ(decoded.m_createTime, info.m_createTime);
+    ASSERT_EQ(decoded.m_formatMap.value("x-dfm-copied/file-icons"), QByteArray("icons"));
+
+    QByteArray unsupported = ItemCodec::encodePreview(info);
+    unsupported[0] = char(ItemPreviewVersion + 1);
+    ASSERT_FALSE(ItemCodec::decodePreview(unsupported, decoded));
+}
@@ -5,9 +5,12 @@
 #include <gtest/gtest.h>
 
 #include "itemdata.h"
+#include "itemcodec.h"
 
 #include <QDebug>
 #include <QSignalSpy>
+#include <QDataStream>
+#include <QApplication>
 
 class TstItemData : public testing::Test
 {
@@ -44,3 +47,64 @@ TEST_F(TstItemData, coverageTest)
     data->popTop();
     ASSERT_EQ(popSpy.count(), 1);
 }
+
+TEST_F(TstItemData, fromPreview)
+{
+    // 预览数据中的文本被截断，字符数使用完整文本的长度
+    const QString text = QString(PreviewTextLength, 'a');
+    QByteArray preview;
+    QDataStream stream(&preview, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_11);
+    stream << ItemPreviewVersion
+           << quint64(7)
+           << quint64(42)
+           << Text
+           << QList<QUrl>()
+           << false
+           << text
+           << qint64(PreviewTextLength * 10)
+           << QDateTime::fromMSecsSinceEpoch(1000)
+           << QByteArray();
+
+    ItemData *item = ItemData::fromPreview(preview);
+    ASSERT_EQ(item->type(), Text);
+    ASSERT_EQ(item->id(), 7u);
+    ASSERT_EQ(item->hash(), 42u);
+    ASSERT_FALSE(item->hasPayload());
+    ASSERT_TRUE(item->formatMap().isEmpty());
+    ASSERT_EQ(item->time(), QDateTime::fromMSecsSinceEpoch(1000));
+    ASSERT_TRUE(item->subTitle().contains(QString::number(PreviewTextLength * 10)));
+    delete item;
+
+    // 不支持的版本不产生数据
+    preview[0] = char(ItemPreviewVersion + 1);
+    item = ItemData::fromPreview(preview);
+    ASSERT_EQ(item->type(), Unknown);
+    delete item;
+}
+
+TEST_F(TstItemData, textLines)
+{
+    // 超长文本只折出可显示的行数
+    ItemInfo info;
+    info.m_formatMap.insert("text/plain", QByteArray());
+    info.m_type = Text;
+    info.m_enable = true;
+    info.m_text = QString(10 * 1024 * 1024, 'a');
+
+    ItemData item(ItemCodec::encode(info));
+    ASSERT_EQ(item.type(), Text);
+    ASSERT_TRUE(item.subTitle().contains(QString::number(info.m_text.size())));
+
+    QFont font = qApp->font();
+    const QStringList lines = item.textLines(font, 100);
+    ASSERT_EQ(lines.size(), TextMaxLines + 1);
+    for (const QString &line : lines)
+        ASSERT_FALSE(line.isEmpty());
+    ASSERT_EQ(item.textLines(font, 100), lines);
+
+    // 字体或宽度变化后重新折行
+    font.setPixelSize(font.pixelSize() > 0 ? font.pixelSize() * 2 : 40);
+    ASSERT_LT(item.textLines(font, 100).first().size(), lines.first().size());
+    ASSERT_GT(item.textLines(font, 1000).first().size(), lines.first().size());
+}
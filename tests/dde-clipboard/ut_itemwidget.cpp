@@ -6,12 +6,14 @@
 
 #include "itemwidget.h"
 #include "itemdata.h"
+#include "iconloader.h"
 
 #include <QFile>
 #include <QApplication>
 #include <QSignalSpy>
 #include <QTest>
 #include <QMouseEvent>
+#include <QTemporaryDir>
 
 class TstItemWidget : public testing::Test
 {
@@ -154,3 +156,39 @@ TEST_F(TstItemWidget, method_GetFileIcon_Test)
 {
     ASSERT_TRUE(ItemWidget::GetFileIcon("123.png").isNull());//不存在的图片
 }
+
+TEST_F(TstItemWidget, method_GetFileIcon_cache_Test)
+{
+    QPixmap base(64, 64);
+    base.fill(Qt::green);
+
+    FileIconData data;
+    data.fileIcon = QIcon(base);
+    data.cornerIconList << "emblem-symbolic-link" << "emblem-readonly";
+
+    // 图标和角标相同时只合成一次
+    const QPixmap first = ItemWidget::GetFileIcon(data);
+    ASSERT_FALSE(first.isNull());
+    ASSERT_EQ(ItemWidget::GetFileIcon(data).cacheKey(), first.cacheKey());
+
+    data.cornerIconList.removeLast();
+    ASSERT_NE(ItemWidget::GetFileIcon(data).cacheKey(), first.cacheKey());
+}
+
+TEST_F(TstItemWidget, method_GetFileIcon_path_cache_Test)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QPixmap base(64, 64);
+    base.fill(Qt::red);
+    const QString path = dir.filePath("icon.png");
+    ASSERT_TRUE(base.save(path));
+
+    // 每次查询都会创建新的QIcon，图标文件按路径复用合成结果
+    FileIconInfo info;
+    info.iconName = path;
+    info.cornerIcons << "emblem-readonly";
+    const QPixmap first = ItemWidget::GetFileIcon(IconLoader::iconData(info));
+    ASSERT_FALSE(first.isNull());
+    ASSERT_EQ(ItemWidget::GetFileIcon(IconLoader::iconData(info)).cacheKey(), first.cacheKey());
+}
@@ -10,6 +10,13 @@
 #include <QtTest>
 #include <QDebug>
 #include <QSignalSpy>
+#include <QDBusConnection>
+
+// 未连接的总线，测试中清除、删除剪切块不会修改正在运行的daemon中的历史记录
+static QDBusConnection testConnection()
+{
+    return QDBusConnection(QStringLiteral("ut-dde-clipboard"));
+}
 
 class TstListView : public testing::Test
 {
@@ -17,7 +24,7 @@ public:
     void SetUp() override
     {
         list = new ListView;
-        model = new ClipboardModel(list);
+        model = new ClipboardModel(list, testConnection());
         delegate = new ItemDelegate;
 
         list->setModel(model);
@@ -70,7 +77,7 @@ TEST_F(TstListView, keyPressTest)
 
 TEST_F(TstListView, uiTest)
 {
-    ClipboardModel *model = new ClipboardModel(list);
+    ClipboardModel *model = new ClipboardModel(list, testConnection());
     ItemDelegate *delegate = new ItemDelegate(list);
 
     list->setItemDelegate(delegate);
@@ -155,3 +162,33 @@ TEST_F(TstListView, mousePressTest)
     list->setCurrentIndex(QModelIndex());
     QTest::mousePress(list, Qt::LeftButton, Qt::NoModifier);
 }
+
+TEST_F(TstListView, paintModeTest)
+{
+    list->setRenderMode(ListView::PaintMode);
+    ASSERT_EQ(list->renderMode(), ListView::PaintMode);
+
+    list->show();
+    QTest::qWait(10);
+
+    QFile file(":/qrc/text.buf");
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    const QByteArray textbuf = file.readAll();
+    file.close();
+
+    for (int i = 0; i < 5; ++i)
+        model->dataComing(textbuf);
+    // 留出时间让listview绘制
+    QTest::qWait(10);
+
+    // 剪切块由delegate绘制，只有当前剪切块上有编辑器
+    list->setCurrentIndex(model->index(1, 0));
+    int editorCount = 0;
+    for (int i = 0; i < model->rowCount(); ++i)
+        editorCount += list->isPersistentEditorOpen(model->index(i, 0)) ? 1 : 0;
+    ASSERT_EQ(editorCount, 1);
+    ASSERT_TRUE(list->isPersistentEditorOpen(model->index(1, 0)));
+
+    list->setRenderMode(ListView::WidgetMode);
+    ASSERT_FALSE(list->isPersistentEditorOpen(model->index(1, 0)));
+}
@@ -10,13 +10,20 @@
 
 #include <QTest>
 #include <QLabel>
+#include <QDBusConnection>
+
+// 未连接的总线，不访问正在运行的剪贴板daemon
+static QDBusConnection testConnection()
+{
+    return QDBusConnection(QStringLiteral("ut-dde-clipboard"));
+}
 
 class TstMainWindow : public testing::Test
 {
 public:
     void SetUp() override
     {
-        window = new MainWindow();
+        window = new MainWindow(testConnection());
     }
 
     void TearDown() override
@@ -31,7 +38,7 @@ public:
 
 TEST_F(TstMainWindow, coverage_Test)
 {
-    MainWindow *w = new MainWindow;
+    MainWindow *w = new MainWindow(testConnection());
 
     w->Show();
     QTest::qWait(AnimationTime * 3 / 2 + 10);
@@ -17,6 +17,7 @@ mkdir -p ../tests/$REPORT_DIR
 
 lcov -c -i -d ./ -o init.info
 ./ut-dde-clipboard --gtest_output=xml:./$REPORT_DIR/ut-report_dde-clipboard.xml
+./ut-dde-clipboard-daemon --gtest_output=xml:./$REPORT_DIR/ut-report_dde-clipboard-daemon.xml
 lcov -c -d ./ -o cover.info
 lcov -a init.info -a cover.info -o total.info
 lcov -r total.info "*/tests/*" "*/usr/include*" '*tests*' -o final.info
@@ -25,4 +26,5 @@ genhtml -o ./$HTML_DIR final.info
 
 mv ./$HTML_DIR/index.html ./$HTML_DIR/cov_dde-clipboard.html
 
-mv asan_board.log* asan_dde-clipboard.log
\ No newline at end of file
+mv asan_board.log* asan_dde-clipboard.log
+mv asan_loader.log* asan_dde-clipboard-daemon.log
\ No newline at end of file